@@ -23,24 +23,30 @@
 from .events import *
 from .futures import *
 from .locks import *
+from .pools import *
 from .protocols import *
 from .queues import *
+from .resolvers import *
 from .streams import *
 from .subprocess import *
 from .tasks import *
 from .transports import *
+from .workers import *
 
 __all__ = (base_events.__all__ +
            coroutines.__all__ +
            events.__all__ +
            futures.__all__ +
            locks.__all__ +
+           pools.__all__ +
            protocols.__all__ +
            queues.__all__ +
+           resolvers.__all__ +
            streams.__all__ +
            subprocess.__all__ +
            tasks.__all__ +
-           transports.__all__)
+           transports.__all__ +
+           workers.__all__)
 
 if sys.platform == 'win32':  # pragma: no cover
     from .windows_events import *
@@ -14,10 +14,12 @@
 """
 
 
+import bisect
 import collections
 import concurrent.futures
 import heapq
 import inspect
+import itertools
 import logging
 import os
 import socket
@@ -29,9 +31,11 @@
 import warnings
 
 from . import compat
+from . import constants
 from . import coroutines
 from . import events
 from . import futures
+from . import resolvers
 from . import tasks
 from .coroutines import coroutine
 from .log import logger
@@ -117,6 +121,60 @@ def _check_resolved_address(sock, address):
                              "got host %r: %s"
                              % (host, err))
 
+
+def _interleave_addrinfos(addrinfos, first_address_family_count=1):
+    # Reorder the addresses to alternate between the address families,
+    # starting with first_address_family_count addresses of the first
+    # family (RFC 8305)
+    addrinfos_by_family = collections.OrderedDict()
+    for addrinfo in addrinfos:
+        addrinfos_by_family.setdefault(addrinfo[0], []).append(addrinfo)
+    addrinfos_lists = list(addrinfos_by_family.values())
+
+    reordered = []
+    if first_address_family_count > 1:
+        reordered.extend(addrinfos_lists[0][:first_address_family_count - 1])
+        del addrinfos_lists[0][:first_address_family_count - 1]
+    reordered.extend(
+        addrinfo for addrinfo in itertools.chain.from_iterable(
+            itertools.zip_longest(*addrinfos_lists))
+        if addrinfo is not None)
+    return reordered
+
+
+def _check_read_size_limits(min_read_size, max_read_size):
+    # Return the (min_size, max_size) pair passed to the transports,
+    # or None to use their defaults
+    if min_read_size is None and max_read_size is None:
+        return None
+    for size in (min_read_size, max_read_size):
+        if size is not None and size <= 0:
+            raise ValueError('read sizes must be > 0, got %r' % size)
+    if (min_read_size is not None and max_read_size is not None
+       and min_read_size > max_read_size):
+        raise ValueError('max_read_size (%r) must be >= min_read_size (%r)'
+                         % (max_read_size, min_read_size))
+    return (min_read_size, max_read_size)
+
+
+def _check_sendfile_params(file, offset, count):
+    if 'b' not in getattr(file, 'mode', 'b'):
+        raise ValueError("file should be opened in binary mode")
+    if not isinstance(offset, int):
+        raise TypeError("offset must be a non-negative integer (got %r)"
+                        % (offset,))
+    if offset < 0:
+        raise ValueError("offset must be a non-negative integer (got %r)"
+                         % (offset,))
+    if count is not None:
+        if not isinstance(count, int):
+            raise TypeError("count must be a positive integer (got %r)"
+                            % (count,))
+        if count <= 0:
+            raise ValueError("count must be a positive integer (got %r)"
+                             % (count,))
+
+
 def _raise_stop_error(*args):
     raise _StopError
 
@@ -178,18 +236,148 @@ def wait_closed(self):
         yield from waiter
 
 
+class _TimerWheel:
+    """Hashed timer wheel for coarse delayed calls.
+
+    Timer handles are stored in buckets of resolution seconds, indexed by
+    tick = when // resolution: adding or removing a handle is O(1).  The
+    event loop moves a bucket to its heap one tick before it expires, so
+    callbacks are still called at their exact time.
+    """
+
+    def __init__(self, resolution):
+        if not resolution > 0:
+            raise ValueError('resolution must be > 0, got %r' % resolution)
+        self.resolution = resolution
+        self._buckets = {}  # tick => {id(handle): handle}
+        self._ticks = []    # heap of the ticks of the buckets
+        self._count = 0
+
+    def __len__(self):
+        return self._count
+
+    def _tick(self, when):
+        return int(when // self.resolution)
+
+    def is_coarse(self, when, now):
+        """Return True if a call at when is far enough from now."""
+        return self._tick(when) > self._tick(now) + 1
+
+    def add(self, handle):
+        tick = self._tick(handle._when)
+        bucket = self._buckets.get(tick)
+        if bucket is None:
+            bucket = self._buckets[tick] = {}
+            heapq.heappush(self._ticks, tick)
+        bucket[id(handle)] = handle
+        self._count += 1
+
+    def remove(self, handle):
+        """Remove a handle, return False if it is not in the wheel."""
+        bucket = self._buckets.get(self._tick(handle._when))
+        if bucket is None or bucket.pop(id(handle), None) is None:
+            return False
+        self._count -= 1
+        return True
+
+    def next_expiration(self):
+        """Return the time when the next bucket must be moved, or None."""
+        while self._ticks:
+            tick = self._ticks[0]
+            if self._buckets[tick]:
+                return (tick - 1) * self.resolution
+            # Drop buckets emptied by remove()
+            heapq.heappop(self._ticks)
+            del self._buckets[tick]
+        return None
+
+    def pop_expired(self, now):
+        """Remove and return the handles of buckets expiring at the next
+        tick following now, or sooner."""
+        limit = self._tick(now) + 1
+        handles = []
+        while self._ticks and self._ticks[0] <= limit:
+            tick = heapq.heappop(self._ticks)
+            handles.extend(self._buckets.pop(tick).values())
+        self._count -= len(handles)
+        return handles
+
+    def pop_all(self):
+        """Remove and return all handles."""
+        handles = []
+        for bucket in self._buckets.values():
+            handles.extend(bucket.values())
+        self._buckets.clear()
+        self._ticks.clear()
+        self._count = 0
+        return handles
+
+
+class _LoopStats:
+    """Counters of an event loop, see BaseEventLoop.get_stats()."""
+
+    # Upper bounds in seconds of the buckets of the histogram of callback
+    # durations; the last bucket counts slower callbacks
+    duration_bounds = (1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1.0)
+
+    def __init__(self):
+        self.iterations = 0
+        self.select_time = 0.0
+        self.events = 0
+        self.callbacks = 0
+        self.callback_time = 0.0
+        self.slow_callbacks = 0
+        self.max_ready = 0
+        self.max_scheduled = 0
+        self.durations = [0] * (len(self.duration_bounds) + 1)
+
+    def add_callback(self, dt, slow):
+        self.callbacks += 1
+        self.callback_time += dt
+        self.durations[bisect.bisect_left(self.duration_bounds, dt)] += 1
+        if dt >= slow:
+            self.slow_callbacks += 1
+
+    def as_dict(self):
+        bounds = self.duration_bounds + (None,)
+        return {
+            'iterations': self.iterations,
+            'select_time': self.select_time,
+            'events': self.events,
+            'callbacks': self.callbacks,
+            'callback_time': self.callback_time,
+            'slow_callbacks': self.slow_callbacks,
+            'callback_durations': list(zip(bounds, self.durations)),
+            'max_ready': self.max_ready,
+            'max_scheduled': self.max_scheduled,
+        }
+
+
 class BaseEventLoop(events.AbstractEventLoop):
 
     def __init__(self):
         self._timer_cancelled_count = 0
         self._closed = False
         self._ready = collections.deque()
+        # Handles of the I/O callbacks of the current iteration, run after
+        # the callbacks which were ready before the poll without going
+        # through _ready (see _process_events())
+        self._io_handles = []
         self._scheduled = []
+        # Optional _TimerWheel for delayed calls far in the future
+        self._timer_wheel = None
+        # _LoopStats, or None if statistics are disabled
+        self._stats = None
         self._default_executor = None
         self._internal_fds = 0
         # Identifier of the thread running the event loop, or None if the
         # event loop is not running
         self._thread_id = None
+        # True while _run_once() may block waiting for events: other threads
+        # only need to wake up the event loop in this case
+        self._selecting = False
+        # True if a wakeup was written and the event loop did not wake up yet
+        self._wakeup_pending = False
         self._clock_resolution = time.get_clock_info('monotonic').resolution
         self._exception_handler = None
         self.set_debug((not sys.flags.ignore_environment
@@ -199,6 +387,7 @@ def __init__(self):
         self.slow_callback_duration = 0.1
         self._current_handle = None
         self._task_factory = None
+        self._resolver = None
         self._coroutine_wrapper_set = False
 
     def __repr__(self):
@@ -206,16 +395,22 @@ def __repr__(self):
                 % (self.__class__.__name__, self.is_running(),
                    self.is_closed(), self.get_debug()))
 
-    def create_task(self, coro):
+    def create_task(self, coro, *, eager=False):
         """Schedule a coroutine object.
 
+        With eager=True, the first step of the coroutine runs before
+        create_task() returns if the loop is running; a task factory is
+        then called with the eager_start=True keyword argument.
+
         Return a task object.
         """
         self._check_closed()
         if self._task_factory is None:
-            task = tasks.Task(coro, loop=self)
+            task = tasks.Task(coro, loop=self, eager_start=eager)
             if task._source_traceback:
                 del task._source_traceback[-1]
+        elif eager:
+            task = self._task_factory(self, coro, eager_start=True)
         else:
             task = self._task_factory(self, coro)
         return task
@@ -238,14 +433,31 @@ def get_task_factory(self):
         """Return a task factory, or None if the default one is in use."""
         return self._task_factory
 
+    def set_resolver(self, resolver):
+        """Set the resolver used by loop.getaddrinfo().
+
+        If resolver is None, socket.getaddrinfo() is called in the default
+        executor.  Otherwise, it must be a resolvers.AbstractResolver
+        instance, like resolvers.DNSResolver.
+        """
+        if (resolver is not None
+        and not isinstance(resolver, resolvers.AbstractResolver)):
+            raise TypeError('resolver must be an AbstractResolver or None')
+        self._resolver = resolver
+
+    def get_resolver(self):
+        """Return the resolver, or None if the default one is in use."""
+        return self._resolver
+
     def _make_socket_transport(self, sock, protocol, waiter=None, *,
-                               extra=None, server=None):
+                               extra=None, server=None,
+                               read_size_limits=None):
         """Create socket transport."""
         raise NotImplementedError
 
     def _make_ssl_transport(self, rawsock, protocol, sslcontext, waiter=None,
                             *, server_side=False, server_hostname=None,
-                            extra=None, server=None):
+                            extra=None, server=None, read_size_limits=None):
         """Create SSL transport."""
         raise NotImplementedError
 
@@ -366,7 +578,10 @@ def close(self):
             logger.debug("Close %r", self)
         self._closed = True
         self._ready.clear()
+        self._io_handles.clear()
         self._scheduled.clear()
+        if self._timer_wheel is not None:
+            self._timer_wheel.pop_all()
         executor = self._default_executor
         if executor is not None:
             self._default_executor = None
@@ -434,10 +649,82 @@ def call_at(self, when, callback, *args):
         timer = events.TimerHandle(when, callback, args, self)
         if timer._source_traceback:
             del timer._source_traceback[-1]
-        heapq.heappush(self._scheduled, timer)
+        wheel = self._timer_wheel
+        if wheel is not None and wheel.is_coarse(when, self.time()):
+            wheel.add(timer)
+        else:
+            heapq.heappush(self._scheduled, timer)
         timer._scheduled = True
         return timer
 
+    def set_timer_wheel(self, resolution):
+        """Store delayed calls far in the future in a timer wheel.
+
+        Calls scheduled at least two ticks of resolution seconds ahead are
+        kept in a hashed timer wheel instead of the heap: scheduling and
+        cancelling them is O(1), which suits timeouts which are almost
+        always cancelled.  Callbacks are still called at their exact time.
+
+        If resolution is None, the timer wheel is disabled and all delayed
+        calls are stored in the heap.
+        """
+        wheel = self._timer_wheel
+        if resolution is not None:
+            self._timer_wheel = _TimerWheel(resolution)
+        else:
+            self._timer_wheel = None
+        if wheel is not None:
+            for handle in wheel.pop_all():
+                heapq.heappush(self._scheduled, handle)
+
+    def set_stats_enabled(self, enabled):
+        """Enable or disable the collection of statistics.
+
+        Collecting statistics is cheap enough to be enabled in production,
+        unlike the debug mode.  Enabling them resets the counters.
+        """
+        if enabled:
+            self._stats = _LoopStats()
+        else:
+            self._stats = None
+
+    def get_stats(self):
+        """Return a dict of statistics, or None if they are disabled.
+
+        Counters since set_stats_enabled(True) was called:
+
+        - iterations: number of iterations of the event loop
+        - select_time: time spent polling for I/O events, in seconds
+        - events: number of I/O events
+        - callbacks: number of callbacks called
+        - callback_time: time spent in callbacks, in seconds
+        - slow_callbacks: number of callbacks which took at least
+          slow_callback_duration seconds
+        - callback_durations: histogram of the durations of callbacks, list
+          of (upper_bound, count) pairs, the last upper bound is None
+        - max_ready: highest number of callbacks ready in an iteration
+        - max_scheduled: highest number of delayed calls
+
+        Current values:
+
+        - ready: number of callbacks ready to be called
+        - scheduled: number of delayed calls, including cancelled calls
+          which were not removed yet
+        """
+        stats = self._stats
+        if stats is None:
+            return None
+        info = stats.as_dict()
+        info['ready'] = len(self._ready)
+        info['scheduled'] = self._scheduled_count()
+        return info
+
+    def _scheduled_count(self):
+        count = len(self._scheduled)
+        if self._timer_wheel is not None:
+            count += len(self._timer_wheel)
+        return count
+
     def call_soon(self, callback, *args):
         """Arrange for a callback to be called as soon as possible.
 
@@ -488,9 +775,39 @@ def call_soon_threadsafe(self, callback, *args):
         handle = self._call_soon(callback, args)
         if handle._source_traceback:
             del handle._source_traceback[-1]
-        self._write_to_self()
+        self._wakeup_threadsafe()
         return handle
 
+    def call_soon_threadsafe_many(self, calls):
+        """Schedule several callbacks from another thread.
+
+        calls is an iterable of (callback, arg1, arg2, ...) tuples.  The
+        callbacks are called in order, as if call_soon_threadsafe() was
+        called for each of them, but the event loop is woken up at most
+        once.  Return the list of the handles.
+        """
+        handles = []
+        try:
+            for callback, *args in calls:
+                handle = self._call_soon(callback, args)
+                if handle._source_traceback:
+                    del handle._source_traceback[-1]
+                handles.append(handle)
+        finally:
+            if handles:
+                self._wakeup_threadsafe()
+        return handles
+
+    def _wakeup_threadsafe(self):
+        # Wake up the event loop from another thread.  Writing into the
+        # self-pipe is only needed if the event loop may block in select():
+        # otherwise it will see the new callbacks before polling.  The
+        # order of the checks is safe: _run_once() sets _selecting before
+        # checking _ready.  Concurrent threads may write more than once.
+        if self._selecting and not self._wakeup_pending:
+            self._wakeup_pending = True
+            self._write_to_self()
+
     def run_in_executor(self, executor, func, *args):
         if (coroutines.iscoroutine(func)
         or coroutines.iscoroutinefunction(func)):
@@ -541,6 +858,12 @@ def _getaddrinfo_debug(self, host, port, family, type, proto, flags):
 
     def getaddrinfo(self, host, port, *,
                     family=0, type=0, proto=0, flags=0):
+        if self._resolver is not None:
+            return tasks.ensure_future(
+                self._resolver.getaddrinfo(host, port, family=family,
+                                           type=type, proto=proto,
+                                           flags=flags),
+                loop=self)
         if self._debug:
             return self.run_in_executor(None, self._getaddrinfo_debug,
                                         host, port, family, type, proto, flags)
@@ -554,7 +877,10 @@ def getnameinfo(self, sockaddr, flags=0):
     @coroutine
     def create_connection(self, protocol_factory, host=None, port=None, *,
                           ssl=None, family=0, proto=0, flags=0, sock=None,
-                          local_addr=None, server_hostname=None):
+                          local_addr=None, server_hostname=None,
+                          min_read_size=None, max_read_size=None,
+                          happy_eyeballs_delay=None, interleave=None,
+                          pool=None):
         """Connect to a TCP server.
 
         Create a streaming transport connection to a given Internet host and
@@ -562,10 +888,31 @@ def create_connection(self, protocol_factory, host=None, port=None, *,
         family if specified), socket type SOCK_STREAM. protocol_factory must be
         a callable returning a protocol instance.
 
+        The transport adapts the size of its reads to the traffic, between
+        min_read_size and max_read_size bytes.
+
+        By default, the addresses of the host are tried one after the other.
+        If happy_eyeballs_delay is set, a new connection attempt is started
+        every happy_eyeballs_delay seconds (0.25 is the value recommended by
+        RFC 8305), or as soon as the previous attempt failed, without
+        waiting for the pending attempts.  The first connected socket is
+        used.  If interleave is set, the addresses are reordered to
+        alternate between the address families, starting with interleave
+        addresses of the first family; it is 1 when happy_eyeballs_delay is
+        set.
+
+        If pool is a ConnectionPool, an idle connection to the same host and
+        port is returned if there is one: protocol_factory is not called and
+        the protocol of the connection is returned.  Connections are put back
+        into the pool with pool.release().
+
         This method is a coroutine which will try to establish the connection
         in the background.  When successful, the coroutine returns a
         (transport, protocol) pair.
         """
+        read_size_limits = _check_read_size_limits(min_read_size,
+                                                   max_read_size)
+
         if server_hostname is not None and not ssl:
             raise ValueError('server_hostname is only meaningful with ssl')
 
@@ -585,6 +932,21 @@ def create_connection(self, protocol_factory, host=None, port=None, *,
                                  'when using ssl without a host')
             server_hostname = host
 
+        if pool is not None:
+            if sock is not None:
+                raise ValueError('a pool can not be used with sock')
+            pool_key = (host, port, ssl, server_hostname, family, proto,
+                        flags, local_addr)
+            connection = pool._acquire(pool_key)
+            if connection is not None:
+                if self._debug:
+                    logger.debug("%r reused from %r", connection[0], pool)
+                return connection
+
+        if happy_eyeballs_delay is not None and interleave is None:
+            # Interleave the address families by default, as RFC 8305
+            interleave = 1
+
         if host is not None or port is not None:
             if sock is not None:
                 raise ValueError(
@@ -611,42 +973,27 @@ def create_connection(self, protocol_factory, host=None, port=None, *,
                 laddr_infos = f2.result()
                 if not laddr_infos:
                     raise OSError('getaddrinfo() returned empty list')
+            else:
+                laddr_infos = None
+
+            if interleave:
+                infos = _interleave_addrinfos(infos, interleave)
 
             exceptions = []
-            for family, type, proto, cname, address in infos:
-                try:
-                    sock = socket.socket(family=family, type=type, proto=proto)
-                    sock.setblocking(False)
-                    if f2 is not None:
-                        for _, _, _, _, laddr in laddr_infos:
-                            try:
-                                sock.bind(laddr)
-                                break
-                            except OSError as exc:
-                                exc = OSError(
-                                    exc.errno, 'error while '
-                                    'attempting to bind on address '
-                                    '{!r}: {}'.format(
-                                        laddr, exc.strerror.lower()))
-                                exceptions.append(exc)
-                        else:
-                            sock.close()
-                            sock = None
-                            continue
-                    if self._debug:
-                        logger.debug("connect %r to %r", sock, address)
-                    yield from self.sock_connect(sock, address)
-                except OSError as exc:
-                    if sock is not None:
-                        sock.close()
-                    exceptions.append(exc)
-                except:
+            if happy_eyeballs_delay is None:
+                for addrinfo in infos:
+                    try:
+                        sock = yield from self._connect_sock(
+                            exceptions, addrinfo, laddr_infos)
+                    except OSError:
+                        continue
                     if sock is not None:
-                        sock.close()
-                    raise
-                else:
-                    break
+                        break
             else:
+                sock = yield from self._staggered_connect(
+                    exceptions, infos, laddr_infos, happy_eyeballs_delay)
+
+            if sock is None:
                 if len(exceptions) == 1:
                     raise exceptions[0]
                 else:
@@ -666,27 +1013,115 @@ def create_connection(self, protocol_factory, host=None, port=None, *,
         sock.setblocking(False)
 
         transport, protocol = yield from self._create_connection_transport(
-            sock, protocol_factory, ssl, server_hostname)
+            sock, protocol_factory, ssl, server_hostname, read_size_limits)
         if self._debug:
             # Get the socket from the transport because SSL transport closes
             # the old socket and creates a new SSL socket
             sock = transport.get_extra_info('socket')
             logger.debug("%r connected to %s:%r: (%r, %r)",
                          sock, host, port, transport, protocol)
+        if pool is not None:
+            pool._register(pool_key, transport, protocol)
         return transport, protocol
 
+    @coroutine
+    def _connect_sock(self, exceptions, addrinfo, laddr_infos=None):
+        # Create a socket and connect it to the address of addrinfo.  Return
+        # the socket, or None if it cannot be bound to a local address.
+        # Errors are appended to exceptions.
+        family, type, proto, cname, address = addrinfo
+        sock = None
+        try:
+            sock = socket.socket(family=family, type=type, proto=proto)
+            sock.setblocking(False)
+            if laddr_infos is not None:
+                for _, _, _, _, laddr in laddr_infos:
+                    try:
+                        sock.bind(laddr)
+                        break
+                    except OSError as exc:
+                        exc = OSError(
+                            exc.errno, 'error while '
+                            'attempting to bind on address '
+                            '{!r}: {}'.format(
+                                laddr, exc.strerror.lower()))
+                        exceptions.append(exc)
+                else:
+                    sock.close()
+                    return None
+            if self._debug:
+                logger.debug("connect %r to %r", sock, address)
+            yield from self.sock_connect(sock, address)
+            return sock
+        except OSError as exc:
+            if sock is not None:
+                sock.close()
+            exceptions.append(exc)
+            raise
+        except:
+            if sock is not None:
+                sock.close()
+            raise
+
+    @coroutine
+    def _staggered_connect(self, exceptions, infos, laddr_infos, delay):
+        # Start a connection attempt every delay seconds or when an attempt
+        # fails, return the first connected socket or None
+        pending = set()
+        sock = None
+        index = 0
+        try:
+            while sock is None:
+                if index < len(infos):
+                    pending.add(tasks.ensure_future(
+                        self._connect_sock(exceptions, infos[index],
+                                           laddr_infos),
+                        loop=self))
+                    index += 1
+                    timeout = delay
+                elif pending:
+                    timeout = None
+                else:
+                    break
+                done, pending = yield from tasks.wait(
+                    pending, timeout=timeout, loop=self,
+                    return_when=tasks.FIRST_COMPLETED)
+                for fut in done:
+                    exc = fut.exception()
+                    if exc is None:
+                        if sock is None:
+                            sock = fut.result()
+                        elif fut.result() is not None:
+                            # Another attempt completed at the same time
+                            fut.result().close()
+                    elif not isinstance(exc, OSError):
+                        raise exc
+        finally:
+            for fut in pending:
+                fut.cancel()
+        if pending:
+            # Wait until the cancelled attempts closed their socket
+            yield from tasks.wait(pending, loop=self)
+            for fut in pending:
+                if not fut.cancelled() and fut.exception() is None:
+                    if fut.result() is not None:
+                        fut.result().close()
+        return sock
+
     @coroutine
     def _create_connection_transport(self, sock, protocol_factory, ssl,
-                                     server_hostname):
+                                     server_hostname, read_size_limits=None):
         protocol = protocol_factory()
         waiter = futures.Future(loop=self)
         if ssl:
             sslcontext = None if isinstance(ssl, bool) else ssl
             transport = self._make_ssl_transport(
                 sock, protocol, sslcontext, waiter,
-                server_side=False, server_hostname=server_hostname)
+                server_side=False, server_hostname=server_hostname,
+                read_size_limits=read_size_limits)
         else:
-            transport = self._make_socket_transport(sock, protocol, waiter)
+            transport = self._make_socket_transport(
+                sock, protocol, waiter, read_size_limits=read_size_limits)
 
         try:
             yield from waiter
@@ -786,6 +1221,149 @@ def create_datagram_endpoint(self, protocol_factory,
 
         return transport, protocol
 
+    @coroutine
+    def sock_sendfile(self, sock, file, offset=0, count=None,
+                      *, fallback=True):
+        """Send a file through a connected socket.
+
+        Send count bytes of file (all the file by default) starting at
+        offset.  The file is sent without copying its content in user space
+        if the event loop supports it, otherwise it is read by chunks and
+        sent with sock_sendall() if fallback is true.  Raise
+        SendfileNotAvailableError if the file cannot be sent without
+        copying and fallback is false.
+
+        Return the total number of bytes sent.  The file position is updated
+        to the end of the sent data.
+
+        This method is a coroutine.
+        """
+        if self._debug and sock.gettimeout() != 0:
+            raise ValueError("the socket must be non-blocking")
+        _check_sendfile_params(file, offset, count)
+        try:
+            return (yield from self._sock_sendfile_native(sock, file,
+                                                          offset, count))
+        except events.SendfileNotAvailableError:
+            if not fallback:
+                raise
+        return (yield from self._sock_sendfile_fallback(sock, file,
+                                                        offset, count))
+
+    @coroutine
+    def _sock_sendfile_native(self, sock, file, offset, count):
+        # Raise SendfileNotAvailableError if nothing was sent
+        raise events.SendfileNotAvailableError(
+            "sendfile is not available for %s" % self.__class__.__name__)
+
+    @coroutine
+    def _sock_sendfile_fallback(self, sock, file, offset, count):
+        if offset:
+            file.seek(offset)
+        blocksize = constants.SENDFILE_FALLBACK_READBUFFER_SIZE
+        if count:
+            blocksize = min(count, blocksize)
+        total_sent = 0
+        try:
+            while True:
+                if count:
+                    blocksize = min(count - total_sent, blocksize)
+                    if blocksize <= 0:
+                        break
+                data = yield from self.run_in_executor(None, file.read,
+                                                       blocksize)
+                if not data:
+                    break
+                yield from self.sock_sendall(sock, data)
+                total_sent += len(data)
+            return total_sent
+        finally:
+            if total_sent > 0:
+                file.seek(offset + total_sent)
+
+    @coroutine
+    def sendfile(self, transport, file, offset=0, count=None,
+                 *, fallback=True):
+        """Send a file through a transport.
+
+        Send count bytes of file (all the file by default) starting at
+        offset.  Plain socket transports send the file without copying its
+        content in user space once their write buffer is flushed; write()
+        must not be called until sendfile() completes.  Otherwise, if
+        fallback is true, the file is read by chunks which are written to
+        the transport, waiting until the write buffer is flushed before
+        each write: SSL transports, with or without ssl.MemoryBIO, use this
+        fallback.
+
+        Return the total number of bytes sent.  The file position is updated
+        to the end of the sent data.
+
+        This method is a coroutine.
+        """
+        if transport.is_closing():
+            raise RuntimeError("Transport is closing")
+        _check_sendfile_params(file, offset, count)
+        if getattr(transport, '_sendfile_compatible', False):
+            try:
+                return (yield from self._sendfile_native(transport, file,
+                                                         offset, count))
+            except events.SendfileNotAvailableError:
+                if not fallback:
+                    raise
+        elif not fallback:
+            raise events.SendfileNotAvailableError(
+                "%s does not support sendfile" % transport.__class__.__name__)
+        if not hasattr(transport, '_make_empty_waiter'):
+            raise NotImplementedError(
+                "%s does not support sendfile" % transport.__class__.__name__)
+        return (yield from self._sendfile_fallback(transport, file,
+                                                   offset, count))
+
+    @coroutine
+    def _sendfile_native(self, transport, file, offset, count):
+        # write() raises an error until the file is sent
+        transport._sendfile_active = True
+        try:
+            yield from transport._make_empty_waiter()
+            return (yield from self._sock_sendfile_native(transport._sock,
+                                                          file,
+                                                          offset, count))
+        finally:
+            transport._reset_empty_waiter()
+            transport._sendfile_active = False
+
+    @coroutine
+    def _sendfile_fallback(self, transport, file, offset, count):
+        if offset:
+            file.seek(offset)
+        blocksize = constants.SENDFILE_FALLBACK_READBUFFER_SIZE
+        if count:
+            blocksize = min(count, blocksize)
+        total_sent = 0
+        try:
+            while True:
+                if count:
+                    blocksize = min(count - total_sent, blocksize)
+                    if blocksize <= 0:
+                        break
+                # The previous chunk is sent while the next one is read
+                data = yield from self.run_in_executor(None, file.read,
+                                                       blocksize)
+                if not data:
+                    break
+                try:
+                    yield from transport._make_empty_waiter()
+                finally:
+                    transport._reset_empty_waiter()
+                if transport.is_closing():
+                    raise ConnectionError("Connection closed by peer")
+                transport.write(data)
+                total_sent += len(data)
+            return total_sent
+        finally:
+            if total_sent > 0:
+                file.seek(offset + total_sent)
+
     @coroutine
     def create_server(self, protocol_factory, host=None, port=None,
                       *,
@@ -794,21 +1372,37 @@ def create_server(self, protocol_factory, host=None, port=None,
                       sock=None,
                       backlog=100,
                       ssl=None,
-                      reuse_address=None):
+                      reuse_address=None,
+                      reuse_port=None,
+                      min_read_size=None,
+                      max_read_size=None):
         """Create a TCP server bound to host and port.
 
         Return a Server object which can be used to stop the service.
 
+        If reuse_port is true, SO_REUSEPORT is set on the sockets: other
+        sockets, of this process or of other processes, can be bound to the
+        same address, and the kernel balances the incoming connections
+        between them.
+
+        The transports of accepted connections adapt the size of their reads
+        to the traffic, between min_read_size and max_read_size bytes.
+
         This method is a coroutine.
         """
         if isinstance(ssl, bool):
             raise TypeError('ssl argument must be an SSLContext or None')
+        read_size_limits = _check_read_size_limits(min_read_size,
+                                                   max_read_size)
         if host is not None or port is not None:
             if sock is not None:
                 raise ValueError(
                     'host/port and sock can not be specified at the same time')
 
             AF_INET6 = getattr(socket, 'AF_INET6', 0)
+            if reuse_port and not hasattr(socket, 'SO_REUSEPORT'):
+                raise ValueError(
+                    'reuse_port not supported by socket module')
             if reuse_address is None:
                 reuse_address = os.name == 'posix' and sys.platform != 'cygwin'
             sockets = []
@@ -838,6 +1432,9 @@ def create_server(self, protocol_factory, host=None, port=None,
                     if reuse_address:
                         sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR,
                                         True)
+                    if reuse_port:
+                        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT,
+                                        True)
                     # Disable IPv4/IPv6 dual stack support (enabled by
                     # default on Linux) which makes a single socket
                     # listen on both address families.
@@ -865,7 +1462,8 @@ def create_server(self, protocol_factory, host=None, port=None,
         for sock in sockets:
             sock.listen(backlog)
             sock.setblocking(False)
-            self._start_serving(protocol_factory, sock, ssl, server)
+            self._start_serving(protocol_factory, sock, ssl, server,
+                                read_size_limits)
         if self._debug:
             logger.info("%r is serving", server)
         return server
@@ -1097,7 +1695,11 @@ def _add_callback_signalsafe(self, handle):
     def _timer_handle_cancelled(self, handle):
         """Notification that a TimerHandle has been cancelled."""
         if handle._scheduled:
-            self._timer_cancelled_count += 1
+            wheel = self._timer_wheel
+            if wheel is not None and wheel.remove(handle):
+                handle._scheduled = False
+            else:
+                self._timer_cancelled_count += 1
 
     def _run_once(self):
         """Run one full iteration of the event loop.
@@ -1107,6 +1709,12 @@ def _run_once(self):
         'call_later' callbacks.
         """
 
+        if self._timer_wheel:
+            # Move delayed calls which expire soon to the heap
+            now = self.time() + self._clock_resolution
+            for handle in self._timer_wheel.pop_expired(now):
+                heapq.heappush(self._scheduled, handle)
+
         sched_count = len(self._scheduled)
         if (sched_count > _MIN_SCHEDULED_TIMER_HANDLES and
             self._timer_cancelled_count / sched_count >
@@ -1130,6 +1738,10 @@ def _run_once(self):
                 handle = heapq.heappop(self._scheduled)
                 handle._scheduled = False
 
+        # A wakeup written before this point is still in the self-pipe and
+        # makes select() return immediately
+        self._wakeup_pending = False
+        self._selecting = True
         timeout = None
         if self._ready:
             timeout = 0
@@ -1137,11 +1749,33 @@ def _run_once(self):
             # Compute the desired timeout.
             when = self._scheduled[0]._when
             timeout = max(0, when - self.time())
-
-        if self._debug and timeout != 0:
+        if self._timer_wheel and timeout != 0:
+            # Wake up to move the next bucket of the timer wheel
+            when = self._timer_wheel.next_expiration()
+            if when is not None:
+                when = max(0, when - self.time())
+                if timeout is None or when < timeout:
+                    timeout = when
+
+        stats = self._stats
+        if stats is not None:
+            stats.iterations += 1
+            stats.max_scheduled = max(stats.max_scheduled,
+                                      self._scheduled_count())
+
+        log_poll = self._debug and timeout != 0
+        if stats is not None or log_poll:
             t0 = self.time()
             event_list = self._selector.select(timeout)
             dt = self.time() - t0
+            if stats is not None:
+                stats.select_time += dt
+                stats.events += len(event_list)
+        else:
+            event_list = self._selector.select(timeout)
+        self._selecting = False
+
+        if log_poll:
             if dt >= 1.0:
                 level = logging.INFO
             else:
@@ -1158,9 +1792,8 @@ def _run_once(self):
                 logger.log(level,
                            'poll %.3f ms took %.3f ms: timeout',
                            timeout * 1e3, dt * 1e3)
-        else:
-            event_list = self._selector.select(timeout)
         self._process_events(event_list)
+        nready = len(self._ready)
 
         # Handle 'later' callbacks that are ready.
         end_time = self.time() + self._clock_resolution
@@ -1179,23 +1812,70 @@ def _run_once(self):
         # they will be run the next time (after another I/O poll).
         # Use an idiom that is thread-safe without using locks.
         ntodo = len(self._ready)
-        for i in range(ntodo):
-            handle = self._ready.popleft()
-            if handle._cancelled:
-                continue
-            if self._debug:
-                try:
-                    self._current_handle = handle
-                    t0 = self.time()
+        if stats is not None and ntodo > stats.max_ready:
+            stats.max_ready = ntodo
+        io_handles = self._io_handles
+        if io_handles:
+            # Keep the order of the _ready queue: callbacks ready before the
+            # poll, I/O callbacks, then 'later' callbacks
+            self._io_handles = []
+            self._run_ready(nready, io_handles)
+            nrun = 0
+            try:
+                for handle in io_handles:
+                    nrun += 1
+                    if not handle._cancelled:
+                        handle._run()
+            except BaseException:
+                # stop() or KeyboardInterrupt: the I/O callbacks which didn't
+                # run yet will run first at the next iteration, before the
+                # 'later' callbacks
+                self._ready.extendleft(reversed(io_handles[nrun:]))
+                raise
+            finally:
+                handle = None  # Break cycles when an exception occurs.
+            self._run_ready(ntodo - nready)
+        else:
+            self._run_ready(ntodo)
+
+    def _run_ready(self, ntodo, io_handles=None):
+        """Run the ntodo first callbacks of the _ready queue.
+
+        If a callback raises an exception like _StopError, the io_handles
+        not run yet are inserted after the callbacks which didn't run.
+        """
+        stats = self._stats
+        try:
+            for i in range(ntodo):
+                handle = self._ready.popleft()
+                if handle._cancelled:
+                    continue
+                if self._debug or stats is not None:
+                    try:
+                        self._current_handle = handle
+                        t0 = self.time()
+                        handle._run()
+                        dt = self.time() - t0
+                        if stats is not None:
+                            stats.add_callback(dt,
+                                               self.slow_callback_duration)
+                        if self._debug and dt >= self.slow_callback_duration:
+                            logger.warning('Executing %s took %.3f seconds',
+                                           _format_handle(handle), dt)
+                    finally:
+                        self._current_handle = None
+                else:
                     handle._run()
-                    dt = self.time() - t0
-                    if dt >= self.slow_callback_duration:
-                        logger.warning('Executing %s took %.3f seconds',
-                                       _format_handle(handle), dt)
-                finally:
-                    self._current_handle = None
-            else:
-                handle._run()
+        except BaseException:
+            if io_handles:
+                # Keep the order of the _ready queue: the callbacks which
+                # didn't run, the I/O callbacks, then the other callbacks
+                nleft = ntodo - i - 1
+                ready = self._ready
+                ready.rotate(-nleft)
+                ready.extendleft(reversed(io_handles))
+                ready.rotate(nleft)
+            raise
         handle = None  # Needed to break cycles when an exception occurs.
 
     def _set_coroutine_wrapper(self, enabled):
@@ -5,3 +5,7 @@
 
 # Seconds to wait before retrying accept().
 ACCEPT_RETRY_DELAY = 1
+
+# Size of the chunks read from the file when sendfile() falls back on
+# reading the file and writing its content.
+SENDFILE_FALLBACK_READBUFFER_SIZE = 256 * 1024
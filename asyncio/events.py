@@ -6,6 +6,7 @@
            'get_event_loop_policy', 'set_event_loop_policy',
            'get_event_loop', 'set_event_loop', 'new_event_loop',
            'get_child_watcher', 'set_child_watcher',
+           'SendfileNotAvailableError',
            ]
 
 import functools
@@ -19,6 +20,11 @@
 
 from asyncio import compat
 
+try:
+    from asyncio import _speedups
+except ImportError:
+    _speedups = None
+
 
 def _get_function_source(func):
     if compat.PY34:
@@ -74,8 +80,12 @@ def _format_callback_source(func, args):
     return func_repr
 
 
-class Handle:
-    """Object returned by callback registration methods."""
+class _PyHandle:
+    """Pure Python implementation of the Handle hot paths.
+
+    The _speedups extension module provides a C implementation of the same
+    attributes and methods; Handle uses it when it is available.
+    """
 
     __slots__ = ('_callback', '_args', '_cancelled', '_loop',
                  '_source_traceback', '_repr', '__weakref__')
@@ -92,6 +102,36 @@ def __init__(self, callback, args, loop):
         else:
             self._source_traceback = None
 
+    def cancel(self):
+        if not self._cancelled:
+            self._cancelled = True
+            if self._loop.get_debug():
+                # Keep a representation in debug mode to keep callback and
+                # parameters. For example, to log the warning
+                # "Executing <Handle...> took 2.5 second"
+                self._repr = repr(self)
+            self._callback = None
+            self._args = None
+
+    def _run(self):
+        try:
+            self._callback(*self._args)
+        except Exception as exc:
+            self._report_exception(exc)
+        self = None  # Needed to break cycles when an exception occurs.
+
+
+if _speedups is not None:
+    _HandleBase = _speedups.Handle
+else:
+    _HandleBase = _PyHandle
+
+
+class Handle(_HandleBase):
+    """Object returned by callback registration methods."""
+
+    __slots__ = ()
+
     def _repr_info(self):
         info = [self.__class__.__name__]
         if self._cancelled:
@@ -109,32 +149,17 @@ def __repr__(self):
         info = self._repr_info()
         return '<%s>' % ' '.join(info)
 
-    def cancel(self):
-        if not self._cancelled:
-            self._cancelled = True
-            if self._loop.get_debug():
-                # Keep a representation in debug mode to keep callback and
-                # parameters. For example, to log the warning
-                # "Executing <Handle...> took 2.5 second"
-                self._repr = repr(self)
-            self._callback = None
-            self._args = None
-
-    def _run(self):
-        try:
-            self._callback(*self._args)
-        except Exception as exc:
-            cb = _format_callback_source(self._callback, self._args)
-            msg = 'Exception in callback {}'.format(cb)
-            context = {
-                'message': msg,
-                'exception': exc,
-                'handle': self,
-            }
-            if self._source_traceback:
-                context['source_traceback'] = self._source_traceback
-            self._loop.call_exception_handler(context)
-        self = None  # Needed to break cycles when an exception occurs.
+    def _report_exception(self, exc):
+        cb = _format_callback_source(self._callback, self._args)
+        msg = 'Exception in callback {}'.format(cb)
+        context = {
+            'message': msg,
+            'exception': exc,
+            'handle': self,
+        }
+        if self._source_traceback:
+            context['source_traceback'] = self._source_traceback
+        self._loop.call_exception_handler(context)
 
 
 class TimerHandle(Handle):
@@ -193,6 +218,14 @@ def cancel(self):
         super().cancel()
 
 
+class SendfileNotAvailableError(RuntimeError):
+    """Sendfile syscall is not available.
+
+    Raised if the OS does not support the sendfile syscall for the given
+    socket or file type.
+    """
+
+
 class AbstractServer:
     """Abstract server returned by create_server()."""
 
@@ -268,7 +301,7 @@ def time(self):
 
     # Method scheduling a coroutine object: create a task.
 
-    def create_task(self, coro):
+    def create_task(self, coro, *, eager=False):
         raise NotImplementedError
 
     # Methods for interacting with threads.
@@ -276,6 +309,9 @@ def create_task(self, coro):
     def call_soon_threadsafe(self, callback, *args):
         raise NotImplementedError
 
+    def call_soon_threadsafe_many(self, calls):
+        raise NotImplementedError
+
     def run_in_executor(self, executor, func, *args):
         raise NotImplementedError
 
@@ -292,12 +328,16 @@ def getnameinfo(self, sockaddr, flags=0):
 
     def create_connection(self, protocol_factory, host=None, port=None, *,
                           ssl=None, family=0, proto=0, flags=0, sock=None,
-                          local_addr=None, server_hostname=None):
+                          local_addr=None, server_hostname=None,
+                          min_read_size=None, max_read_size=None,
+                          happy_eyeballs_delay=None, interleave=None,
+                          pool=None):
         raise NotImplementedError
 
     def create_server(self, protocol_factory, host=None, port=None, *,
                       family=socket.AF_UNSPEC, flags=socket.AI_PASSIVE,
-                      sock=None, backlog=100, ssl=None, reuse_address=None):
+                      sock=None, backlog=100, ssl=None, reuse_address=None,
+                      reuse_port=None, min_read_size=None, max_read_size=None):
         """A coroutine which creates a TCP server bound to host and port.
 
         The return value is a Server object which can be used to stop
@@ -326,6 +366,16 @@ def create_server(self, protocol_factory, host=None, port=None, *,
         TIME_WAIT state, without waiting for its natural timeout to
         expire. If not specified will automatically be set to True on
         UNIX.
+
+        reuse_port tells the kernel to allow this endpoint to be bound to
+        the same port as other existing endpoints are bound to, so long as
+        they all set this flag when being created. The kernel balances the
+        incoming connections between them. This option is not supported on
+        Windows.
+
+        min_read_size and max_read_size bound the size of the reads of
+        the accepted connections, which grows and shrinks with the
+        traffic.  If not specified, transports use their own defaults.
         """
         raise NotImplementedError
 
@@ -360,6 +410,20 @@ def create_datagram_endpoint(self, protocol_factory,
                                  family=0, proto=0, flags=0):
         raise NotImplementedError
 
+    def sendfile(self, transport, file, offset=0, count=None,
+                 *, fallback=True):
+        """A coroutine which sends a file through a transport.
+
+        The file is sent without copying its content in user space when
+        the platform and the transport support it: os.sendfile() on UNIX,
+        TransmitFile() with the IOCP proactor.  Otherwise, if fallback is
+        true, the file is read by chunks and written to the transport.
+
+        Return the total number of bytes sent.  The file position is
+        updated to the end of the sent data.
+        """
+        raise NotImplementedError
+
     # Pipes and subprocesses.
 
     def connect_read_pipe(self, protocol_factory, pipe):
@@ -420,9 +484,16 @@ def remove_writer(self, fd):
     def sock_recv(self, sock, nbytes):
         raise NotImplementedError
 
+    def sock_recv_into(self, sock, buf):
+        raise NotImplementedError
+
     def sock_sendall(self, sock, data):
         raise NotImplementedError
 
+    def sock_sendfile(self, sock, file, offset=0, count=None,
+                      *, fallback=True):
+        raise NotImplementedError
+
     def sock_connect(self, sock, address):
         raise NotImplementedError
 
@@ -445,6 +516,14 @@ def set_task_factory(self, factory):
     def get_task_factory(self):
         raise NotImplementedError
 
+    # Resolver.
+
+    def set_resolver(self, resolver):
+        raise NotImplementedError
+
+    def get_resolver(self):
+        raise NotImplementedError
+
     # Error handlers.
 
     def set_exception_handler(self, handler):
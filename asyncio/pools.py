@@ -0,0 +1,126 @@
+"""Pool of idle connections, reused by create_connection()."""
+
+__all__ = ['ConnectionPool']
+
+import collections
+import weakref
+
+from . import events
+from .log import logger
+
+
+class ConnectionPool:
+    """Pool of idle connections, keyed by the arguments of create_connection().
+
+    Pass the pool to loop.create_connection() or open_connection(): an idle
+    connection to the same host and port, with the same SSL parameters, is
+    reused if there is one.  Otherwise a new connection is created.
+
+    When a connection is no more used, put it back into the pool with
+    release() instead of closing it.  At most max_idle idle connections are
+    kept per key, and they are closed after idle_timeout seconds.
+    """
+
+    def __init__(self, *, max_idle=10, idle_timeout=60.0, loop=None):
+        if max_idle < 0:
+            raise ValueError('max_idle must be >= 0, got %r' % max_idle)
+        if loop is None:
+            self._loop = events.get_event_loop()
+        else:
+            self._loop = loop
+        self._max_idle = max_idle
+        self._idle_timeout = idle_timeout
+        # key => deque of (transport, protocol, release time),
+        # the most recently released connection is the last
+        self._idle = {}
+        # transport => (key, weak reference to the protocol) of the
+        # connections created for the pool: don't keep them alive
+        self._connections = weakref.WeakKeyDictionary()
+        self._expire_handle = None
+        self._closed = False
+
+    def __repr__(self):
+        info = [self.__class__.__name__]
+        if self._closed:
+            info.append('closed')
+        info.append('idle=%s' % len(self))
+        return '<%s>' % ' '.join(info)
+
+    def __len__(self):
+        """Return the number of idle connections."""
+        return sum(map(len, self._idle.values()))
+
+    def _register(self, key, transport, protocol):
+        self._connections[transport] = (key, weakref.ref(protocol))
+
+    def _acquire(self, key):
+        # Return an idle (transport, protocol) pair, or None
+        idle = self._idle.get(key)
+        while idle:
+            transport, protocol, release_time = idle.pop()
+            if not idle:
+                del self._idle[key]
+            if not transport.is_closing():
+                return transport, protocol
+        return None
+
+    def release(self, transport):
+        """Put back a connection created with the pool.
+
+        The connection is closed if the pool is closed or full, or if the
+        transport is closing.
+        """
+        try:
+            key, protocol = self._connections[transport]
+        except KeyError:
+            raise ValueError('%r was not created by the pool' % transport)
+        protocol = protocol()
+        if protocol is None or transport.is_closing():
+            return
+        idle = self._idle.get(key)
+        if idle is None:
+            idle = self._idle[key] = collections.deque()
+        if self._closed or len(idle) >= self._max_idle:
+            if not idle:
+                del self._idle[key]
+            transport.close()
+            return
+        idle.append((transport, protocol, self._loop.time()))
+        if self._expire_handle is None:
+            self._expire_handle = self._loop.call_later(self._idle_timeout,
+                                                        self._expire)
+
+    def _expire(self):
+        # Close the connections idle for more than idle_timeout seconds
+        self._expire_handle = None
+        deadline = self._loop.time() - self._idle_timeout
+        next_expiration = None
+        for key, idle in list(self._idle.items()):
+            while idle and idle[0][2] <= deadline:
+                transport = idle.popleft()[0]
+                if self._loop.get_debug():
+                    logger.debug("%r closes the idle %r", self, transport)
+                transport.close()
+            if idle:
+                if next_expiration is None or idle[0][2] < next_expiration:
+                    next_expiration = idle[0][2]
+            else:
+                del self._idle[key]
+        if next_expiration is not None:
+            self._expire_handle = self._loop.call_at(
+                next_expiration + self._idle_timeout, self._expire)
+
+    def close(self):
+        """Close the idle connections.
+
+        The connections released later are closed.
+        """
+        self._closed = True
+        if self._expire_handle is not None:
+            self._expire_handle.cancel()
+            self._expire_handle = None
+        idle_connections = self._idle
+        self._idle = {}
+        for idle in idle_connections.values():
+            for transport, protocol, release_time in idle:
+                transport.close()
@@ -6,15 +6,24 @@
 
 __all__ = ['BaseProactorEventLoop']
 
+import collections
+import io
+import os
 import socket
 import warnings
+try:
+    import ssl
+except ImportError:  # pragma: no cover
+    ssl = None
 
 from . import base_events
 from . import compat
 from . import constants
+from . import events
 from . import futures
 from . import sslproto
 from . import transports
+from .coroutines import coroutine
 from .log import logger
 
 
@@ -29,7 +38,7 @@ def __init__(self, loop, sock, protocol, waiter=None,
         self._sock = sock
         self._protocol = protocol
         self._server = server
-        self._buffer = None  # None or bytearray.
+        self._buffer = None  # None or list of bytes-like objects.
         self._read_fut = None
         self._write_fut = None
         self._pending_write = 0
@@ -38,6 +47,9 @@ def __init__(self, loop, sock, protocol, waiter=None,
         self._eof_written = False
         if self._server is not None:
             self._server._attach()
+        self._connection_made(waiter)
+
+    def _connection_made(self, waiter):
         self._loop.call_soon(self._protocol.connection_made, self)
         if waiter is not None:
             # only wake up the waiter when connection_made() has been called
@@ -56,7 +68,7 @@ def __repr__(self):
         if self._write_fut is not None:
             info.append("write=%r" % self._write_fut)
         if self._buffer:
-            bufsize = len(self._buffer)
+            bufsize = sum(map(len, self._buffer))
             info.append('write_bufsize=%s' % bufsize)
         if self._eof_written:
             info.append('EOF written')
@@ -65,6 +77,9 @@ def __repr__(self):
     def _set_extra(self, sock):
         self._extra['pipe'] = sock
 
+    def is_closing(self):
+        return self._closing
+
     def close(self):
         if self._closing:
             return
@@ -117,34 +132,51 @@ def _call_connection_lost(self, exc):
         try:
             self._protocol.connection_lost(exc)
         finally:
-            # XXX If there is a pending overlapped read on the other
-            # end then it may fail with ERROR_NETNAME_DELETED if we
-            # just close our end.  First calling shutdown() seems to
-            # cure it, but maybe using DisconnectEx() would be better.
+            self._close_socket()
+
+    def _close_socket(self):
+        # XXX If there is a pending overlapped read on the other
+        # end then it may fail with ERROR_NETNAME_DELETED if we
+        # just close our end.  First calling shutdown() seems to
+        # cure it, but maybe using DisconnectEx() would be better.
+        # Accepted sockets may instead be disconnected and reused
+        # by the proactor for new accept operations.
+        if (self._server is None or
+            not self._loop._proactor.recycle_accept_socket(self._sock)):
             if hasattr(self._sock, 'shutdown'):
                 self._sock.shutdown(socket.SHUT_RDWR)
             self._sock.close()
-            self._sock = None
-            server = self._server
-            if server is not None:
-                server._detach()
-                self._server = None
+        self._sock = None
+        server = self._server
+        if server is not None:
+            server._detach()
+            self._server = None
 
     def get_write_buffer_size(self):
         size = self._pending_write
         if self._buffer is not None:
-            size += len(self._buffer)
+            size += sum(map(len, self._buffer))
         return size
 
 
-class _ProactorReadPipeTransport(_ProactorBasePipeTransport,
+class _ProactorReadPipeTransport(transports._ReadSizeMixin,
+                                 _ProactorBasePipeTransport,
                                  transports.ReadTransport):
     """Transport for read pipes."""
 
     def __init__(self, loop, sock, protocol, waiter=None,
-                 extra=None, server=None):
+                 extra=None, server=None, *, read_size_limits=None):
         super().__init__(loop, sock, protocol, waiter, extra, server)
         self._paused = False
+        if read_size_limits is None:
+            self._set_read_size_limits()
+        else:
+            self._set_read_size_limits(*read_size_limits)
+        # The same buffer is used by all reads: only the number of bytes
+        # actually read is copied before being passed to data_received().
+        # It is only reallocated when the read size changes.
+        self._read_buffer = bytearray(self._read_size)
+        self._read_view = memoryview(self._read_buffer)
         self._loop.call_soon(self._loop_reading)
 
     def pause_reading(self):
@@ -153,6 +185,7 @@ def pause_reading(self):
         if self._paused:
             raise RuntimeError('Already paused')
         self._paused = True
+        self._stats.reading_pauses += 1
         if self._loop.get_debug():
             logger.debug("%r pauses reading", self)
 
@@ -160,6 +193,7 @@ def resume_reading(self):
         if not self._paused:
             raise RuntimeError('Not paused')
         self._paused = False
+        self._stats.reading_resumes += 1
         if self._closing:
             return
         self._loop.call_soon(self._loop_reading, self._read_fut)
@@ -176,7 +210,15 @@ def _loop_reading(self, fut=None):
                 assert self._read_fut is fut or (self._read_fut is None and
                                                  self._closing)
                 self._read_fut = None
-                data = fut.result()  # deliver data later in "finally" clause
+                nbytes = fut.result()
+                if nbytes:
+                    stats = self._stats
+                    stats.reads += 1
+                    stats.bytes_received += nbytes
+                # Copy the data before the next read reuses the buffer,
+                # deliver it later in "finally" clause
+                data = self._read_data(nbytes)
+                self._update_read_size(nbytes)
 
             if self._closing:
                 # since close() has been called we ignore any read data
@@ -188,7 +230,11 @@ def _loop_reading(self, fut=None):
                 return
 
             # reschedule a new read
-            self._read_fut = self._loop._proactor.recv(self._sock, 4096)
+            if len(self._read_buffer) != self._read_size:
+                self._read_buffer = bytearray(self._read_size)
+                self._read_view = memoryview(self._read_buffer)
+            self._read_fut = self._loop._proactor.recv_into(self._sock,
+                                                            self._read_buffer)
         except ConnectionAbortedError as exc:
             if not self._closing:
                 self._fatal_error(exc, 'Fatal read error on pipe transport')
@@ -208,23 +254,41 @@ def _loop_reading(self, fut=None):
             if data:
                 self._protocol.data_received(data)
             elif data is not None:
-                if self._loop.get_debug():
-                    logger.debug("%r received EOF", self)
-                keep_open = self._protocol.eof_received()
-                if not keep_open:
-                    self.close()
+                self._eof_received()
+
+    def _read_data(self, nbytes):
+        # Return the data passed to data_received(): b'' for end-of-file,
+        # None if there is nothing to deliver yet
+        return bytes(self._read_view[:nbytes])
+
+    def _eof_received(self):
+        if self._loop.get_debug():
+            logger.debug("%r received EOF", self)
+        keep_open = self._protocol.eof_received()
+        if not keep_open:
+            self.close()
 
 
 class _ProactorBaseWritePipeTransport(_ProactorBasePipeTransport,
                                       transports.WriteTransport):
     """Transport for write pipes."""
 
+    # True while loop.sendfile() sends a file through the socket
+    _sendfile_active = False
+    # Future set when the write buffer is empty, see _make_empty_waiter()
+    _empty_waiter = None
+    # Corked mode, see set_corked(): handle of the scheduled flush()
+    _corked = False
+    _cork_handle = None
+
     def write(self, data):
         if not isinstance(data, (bytes, bytearray, memoryview)):
             raise TypeError('data argument must be byte-ish (%r)',
                             type(data))
         if self._eof_written:
             raise RuntimeError('write_eof() already called')
+        if self._sendfile_active:
+            raise RuntimeError('unable to write; sendfile is in progress')
 
         if not data:
             return
@@ -238,22 +302,86 @@ def write(self, data):
         # Observable states:
         # 1. IDLE: _write_fut and _buffer both None
         # 2. WRITING: _write_fut set; _buffer None
-        # 3. BACKED UP: _write_fut set; _buffer a bytearray
+        # 3. BACKED UP: _write_fut set; _buffer a non-empty list
+        # 4. CORKED: _write_fut None; _buffer a non-empty list, sent by
+        #    flush()
         # We always copy the data, so the caller can't modify it
         # while we're still waiting for the I/O to happen.
-        if self._write_fut is None:  # IDLE -> WRITING
+        if self._write_fut is None and self._corked:  # IDLE -> CORKED
+            self._cork([bytes(data)])
+        elif self._write_fut is None:  # IDLE -> WRITING
             assert self._buffer is None
             # Pass a copy, except if it's already immutable.
             self._loop_writing(data=bytes(data))
         elif not self._buffer:  # WRITING -> BACKED UP
             # Make a mutable copy which we can extend.
-            self._buffer = bytearray(data)
+            self._buffer = [bytearray(data)]
             self._maybe_pause_protocol()
         else:  # BACKED UP
-            # Append to buffer (also copies).
-            self._buffer.extend(data)
+            # Append to the last buffer if it is ours (also copies).
+            last = self._buffer[-1]
+            if isinstance(last, bytearray):
+                last.extend(data)
+            else:
+                self._buffer.append(bytearray(data))
             self._maybe_pause_protocol()
 
+    def writelines(self, list_of_data):
+        buffers = []
+        for data in list_of_data:
+            if not isinstance(data, (bytes, bytearray, memoryview)):
+                raise TypeError('data argument must be byte-ish (%r)',
+                                type(data))
+            if data:
+                # Immutable bytes are kept as is, without copying.
+                buffers.append(bytes(data))
+        if self._eof_written:
+            raise RuntimeError('write_eof() already called')
+        if self._sendfile_active:
+            raise RuntimeError('unable to write; sendfile is in progress')
+
+        if not buffers:
+            return
+
+        if self._conn_lost:
+            if self._conn_lost >= constants.LOG_THRESHOLD_FOR_CONNLOST_WRITES:
+                logger.warning('socket.send() raised exception.')
+            self._conn_lost += 1
+            return
+
+        # The buffers are flushed with a single vectored send.
+        if self._write_fut is None and self._corked:  # IDLE -> CORKED
+            self._cork(buffers)
+        elif self._write_fut is None:  # IDLE -> WRITING
+            assert self._buffer is None
+            self._loop_writing(data=buffers)
+        else:  # WRITING or BACKED UP -> BACKED UP
+            if self._buffer is None:
+                self._buffer = []
+            self._buffer.extend(buffers)
+            self._maybe_pause_protocol()
+
+    def _cork(self, buffers):
+        if self._buffer is None:
+            self._buffer = []
+            self._cork_handle = self._loop.call_soon(self.flush)
+        self._buffer.extend(buffers)
+        self._maybe_pause_protocol()
+
+    def set_corked(self, corked):
+        self._corked = bool(corked)
+        if not corked:
+            self.flush()
+
+    def flush(self):
+        if self._cork_handle is not None:
+            self._cork_handle.cancel()
+            self._cork_handle = None
+        # If a send is in progress, the buffer is sent when it completes
+        if self._write_fut is None and self._buffer:
+            # CORKED -> WRITING
+            self._loop_writing()
+
     def _loop_writing(self, f=None, data=None):
         try:
             assert f is self._write_fut
@@ -264,7 +392,10 @@ def _loop_writing(self, f=None, data=None):
             if data is None:
                 data = self._buffer
                 self._buffer = None
+            if isinstance(data, list) and len(data) == 1:
+                data = data[0]
             if not data:
+                self._wakeup_empty_waiter()
                 if self._closing:
                     self._loop.call_soon(self._call_connection_lost, None)
                 if self._eof_written:
@@ -276,10 +407,20 @@ def _loop_writing(self, f=None, data=None):
                 # protocol to be paused again).
                 self._maybe_resume_protocol()
             else:
-                self._write_fut = self._loop._proactor.send(self._sock, data)
+                if isinstance(data, list):
+                    self._write_fut = self._loop._proactor.send_buffers(
+                        self._sock, data)
+                    size = sum(map(len, data))
+                else:
+                    self._write_fut = self._loop._proactor.send(self._sock,
+                                                                data)
+                    size = len(data)
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += size
                 if not self._write_fut.done():
                     assert self._pending_write == 0
-                    self._pending_write = len(data)
+                    self._pending_write = size
                     self._write_fut.add_done_callback(self._loop_writing)
                     self._maybe_pause_protocol()
                 else:
@@ -298,6 +439,38 @@ def write_eof(self):
     def abort(self):
         self._force_close(None)
 
+    def _force_close(self, exc):
+        if self._cork_handle is not None:
+            self._cork_handle.cancel()
+            self._cork_handle = None
+        if exc is None:
+            self._wakeup_empty_waiter(ConnectionError("Connection is closed"))
+        else:
+            self._wakeup_empty_waiter(exc)
+        super()._force_close(exc)
+
+    def _make_empty_waiter(self):
+        # Return a future set when the write buffer is empty, used by
+        # loop.sendfile()
+        if self._empty_waiter is not None:
+            raise RuntimeError("Empty waiter is already set")
+        self._empty_waiter = futures.Future(loop=self._loop)
+        if self._write_fut is None and not self._buffer:
+            self._empty_waiter.set_result(None)
+        return self._empty_waiter
+
+    def _reset_empty_waiter(self):
+        self._empty_waiter = None
+
+    def _wakeup_empty_waiter(self, exc=None):
+        waiter = self._empty_waiter
+        if waiter is None or waiter.done():
+            return
+        if exc is None:
+            waiter.set_result(None)
+        else:
+            waiter.set_exception(exc)
+
 
 class _ProactorWritePipeTransport(_ProactorBaseWritePipeTransport):
     def __init__(self, *args, **kw):
@@ -338,6 +511,9 @@ class _ProactorSocketTransport(_ProactorReadPipeTransport,
                                transports.Transport):
     """Transport for connected sockets."""
 
+    # loop.sendfile() can send files directly through the socket
+    _sendfile_compatible = True
+
     def _set_extra(self, sock):
         self._extra['socket'] = sock
         try:
@@ -361,40 +537,464 @@ def write_eof(self):
         if self._closing or self._eof_written:
             return
         self._eof_written = True
-        if self._write_fut is None:
+        # In corked mode, the buffer is not empty while no send is in
+        # progress: the last _loop_writing() shuts down the socket
+        if self._write_fut is None and not self._buffer:
             self._sock.shutdown(socket.SHUT_WR)
 
 
+class _ProactorSSLTransport(_ProactorSocketTransport):
+    """Transport for SSL connections.
+
+    The records are encrypted and decrypted with an SSL object using
+    memory BIOs, directly in the completion callbacks of the socket reads
+    and writes, instead of stacking an sslproto.SSLProtocol on top of a
+    socket transport.
+    """
+
+    max_size = 256 * 1024   # Buffer size passed to SSLObject.read()
+
+    # The file must be encrypted: loop.sendfile() writes its chunks
+    _sendfile_compatible = False
+
+    def __init__(self, loop, sock, protocol, sslcontext, waiter=None,
+                 server_side=False, server_hostname=None,
+                 extra=None, server=None, *, read_size_limits=None):
+        if not sslcontext:
+            sslcontext = sslproto._create_transport_context(server_side,
+                                                            server_hostname)
+        if server_side:
+            server_hostname = None
+        self._incoming = ssl.MemoryBIO()
+        self._outgoing = ssl.MemoryBIO()
+        self._sslobj = sslcontext.wrap_bio(self._incoming, self._outgoing,
+                                           server_side=server_side,
+                                           server_hostname=server_hostname)
+        self._handshaking = True
+        self._handshake_start_time = None
+        self._session_established = False
+        # Plaintext data which cannot be encrypted before the end of the
+        # handshake or of a renegotiation
+        self._app_backlog = collections.deque()
+        super().__init__(loop, sock, protocol, waiter, extra, server,
+                         read_size_limits=read_size_limits)
+        self._extra['sslcontext'] = sslcontext
+
+    def _connection_made(self, waiter):
+        # connection_made() is only called when the handshake completes
+        self._waiter = waiter
+        self._loop.call_soon(self._start_handshake)
+
+    def _wakeup_waiter(self, exc=None):
+        if self._waiter is None:
+            return
+        if not self._waiter.cancelled():
+            if exc is not None:
+                self._waiter.set_exception(exc)
+            else:
+                self._waiter.set_result(None)
+        self._waiter = None
+
+    def _start_handshake(self):
+        if self._closing:
+            return
+        if self._loop.get_debug():
+            logger.debug("%r starts SSL handshake", self)
+            self._handshake_start_time = self._loop.time()
+        self._do_handshake()
+
+    def _do_handshake(self):
+        # Return True if the handshake completed successfully
+        try:
+            self._sslobj.do_handshake()
+        except (ssl.SSLError, ssl.CertificateError) as exc:
+            if getattr(exc, 'errno', None) in (ssl.SSL_ERROR_WANT_READ,
+                                               ssl.SSL_ERROR_WANT_WRITE,
+                                               ssl.SSL_ERROR_SYSCALL):
+                return False
+            handshake_exc = exc
+        else:
+            handshake_exc = None
+        finally:
+            # Send the handshake records, or the alert of a failure
+            self._flush_outgoing()
+        self._handshaking = False
+
+        if handshake_exc is not None:
+            if self._loop.get_debug():
+                if isinstance(handshake_exc, ssl.CertificateError):
+                    logger.warning("%r: SSL handshake failed "
+                                   "on verifying the certificate",
+                                   self, exc_info=True)
+                else:
+                    logger.warning("%r: SSL handshake failed",
+                                   self, exc_info=True)
+            self.close()
+            self._wakeup_waiter(handshake_exc)
+            return False
+
+        if self._handshake_start_time is not None:
+            dt = self._loop.time() - self._handshake_start_time
+            logger.debug("%r: SSL handshake took %.1f ms", self, dt * 1e3)
+
+        # Add extra info that becomes available after handshake.
+        self._extra.update(peercert=self._sslobj.getpeercert(),
+                           cipher=self._sslobj.cipher(),
+                           compression=self._sslobj.compression(),
+                           )
+        self._session_established = True
+        self._protocol.connection_made(self)
+        self._wakeup_waiter()
+        return True
+
+    def _read_data(self, nbytes):
+        if not nbytes:
+            return b''
+        self._incoming.write(self._read_view[:nbytes])
+        if self._handshaking and not self._do_handshake():
+            return None
+
+        chunks = []
+        close_notify = False
+        try:
+            while True:
+                chunk = self._sslobj.read(self.max_size)
+                if not chunk:
+                    close_notify = True
+                    break
+                chunks.append(chunk)
+        except ssl.SSLError as exc:
+            if exc.errno not in (ssl.SSL_ERROR_WANT_READ,
+                                 ssl.SSL_ERROR_WANT_WRITE,
+                                 ssl.SSL_ERROR_SYSCALL):
+                raise
+
+        # Encrypt the data blocked by a renegotiation and send the records
+        # produced by the reads
+        self._encrypt_backlog()
+        self._flush_outgoing()
+
+        if len(chunks) == 1:
+            data = chunks[0]
+        else:
+            data = b''.join(chunks)
+        if close_notify:
+            # Deliver the data received before the close_notify alert,
+            # then handle the alert as an end-of-file
+            if data:
+                self._protocol.data_received(data)
+            return b''
+        return data or None
+
+    def _eof_received(self):
+        try:
+            if self._loop.get_debug():
+                logger.debug("%r received EOF", self)
+
+            self._wakeup_waiter(ConnectionResetError)
+
+            if self._session_established:
+                keep_open = self._protocol.eof_received()
+                if keep_open:
+                    logger.warning('returning true from eof_received() '
+                                   'has no effect when using ssl')
+        finally:
+            self.close()
+
+    def _call_connection_lost(self, exc):
+        # The waiter is still pending if the handshake did not complete
+        if exc is None:
+            self._wakeup_waiter(ConnectionResetError())
+        else:
+            self._wakeup_waiter(exc)
+        if self._session_established:
+            super()._call_connection_lost(exc)
+        else:
+            # connection_made() was not called: don't call connection_lost()
+            self._close_socket()
+
+    def close(self):
+        if self._closing:
+            return
+        if self._session_established:
+            # Send the close_notify alert, don't wait for the one of the peer
+            try:
+                self._sslobj.unwrap()
+            except ssl.SSLError:
+                pass
+            self._flush_outgoing()
+        super().close()
+
+    def _encrypt(self, data):
+        # Encrypt data into the outgoing BIO, return the part of data which
+        # cannot be encrypted until more data is received
+        view = memoryview(data)
+        offset = 0
+        while offset < len(view):
+            try:
+                offset += self._sslobj.write(view[offset:])
+            except ssl.SSLError as exc:
+                if exc.errno not in (ssl.SSL_ERROR_WANT_READ,
+                                     ssl.SSL_ERROR_WANT_WRITE):
+                    raise
+                break
+        return view[offset:]
+
+    def _encrypt_backlog(self):
+        backlog = self._app_backlog
+        while backlog:
+            data = self._encrypt(backlog[0])
+            if data:
+                backlog[0] = data
+                break
+            backlog.popleft()
+
+    def _flush_outgoing(self):
+        # Send all the records produced since the last call with a single
+        # socket write
+        if self._outgoing.pending:
+            super().write(self._outgoing.read())
+
+    def _write_appdata(self, list_of_data):
+        if self._conn_lost:
+            if self._conn_lost >= constants.LOG_THRESHOLD_FOR_CONNLOST_WRITES:
+                logger.warning('socket.send() raised exception.')
+            self._conn_lost += 1
+            return
+
+        try:
+            for data in list_of_data:
+                if not self._app_backlog and not self._handshaking:
+                    data = self._encrypt(data)
+                if data:
+                    # Copy the data, so the caller can modify it
+                    self._app_backlog.append(bytes(data))
+        except ssl.SSLError as exc:
+            self._fatal_error(exc, 'Fatal error on SSL transport')
+            return
+        self._flush_outgoing()
+
+    def write(self, data):
+        if not isinstance(data, (bytes, bytearray, memoryview)):
+            raise TypeError('data argument must be byte-ish (%r)',
+                            type(data))
+        if data:
+            self._write_appdata((data,))
+
+    def writelines(self, list_of_data):
+        buffers = []
+        for data in list_of_data:
+            if not isinstance(data, (bytes, bytearray, memoryview)):
+                raise TypeError('data argument must be byte-ish (%r)',
+                                type(data))
+            if data:
+                buffers.append(data)
+        # The records of all buffers are sent with a single socket write
+        if buffers:
+            self._write_appdata(buffers)
+
+    def get_write_buffer_size(self):
+        return super().get_write_buffer_size() + sum(map(len,
+                                                         self._app_backlog))
+
+    def can_write_eof(self):
+        return False
+
+    def write_eof(self):
+        raise NotImplementedError
+
+
+class _ProactorDatagramTransport(transports._DatagramMixin,
+                                 _ProactorBasePipeTransport,
+                                 transports.DatagramTransport):
+    """Transport for datagram sockets.
+
+    A single WSARecvFrom() operation is kept posted.  Datagrams passed to
+    sendto() are queued and sent one at a time with WSASendTo(), or
+    WSASend() if the socket is connected.
+    """
+
+    max_size = 256 * 1024  # Buffer size passed to recvfrom().
+
+    def __init__(self, loop, sock, protocol, address=None,
+                 waiter=None, extra=None):
+        self._address = address
+        super().__init__(loop, sock, protocol, waiter=waiter, extra=extra)
+        # deque of (data, addr) pairs
+        self._buffer = collections.deque()
+        # only start reading when connection_made() has been called
+        self._loop.call_soon(self._loop_reading)
+
+    def _set_extra(self, sock):
+        self._extra['socket'] = sock
+        try:
+            self._extra['sockname'] = sock.getsockname()
+        except (socket.error, AttributeError):
+            if self._loop.get_debug():
+                logger.warning("getsockname() failed on %r",
+                               sock, exc_info=True)
+        if self._address is not None:
+            self._extra['peername'] = self._address
+
+    def get_write_buffer_size(self):
+        if self._buffer is None:
+            return 0
+        return sum(len(data) for data, _ in self._buffer)
+
+    def abort(self):
+        self._force_close(None)
+
+    def sendto(self, data, addr=None):
+        if not isinstance(data, (bytes, bytearray, memoryview)):
+            raise TypeError('data argument must be byte-ish (%r)',
+                            type(data))
+        if not data:
+            return
+
+        if self._address is not None and addr not in (None, self._address):
+            raise ValueError('Invalid address: must be None or %s' %
+                             (self._address,))
+
+        if self._conn_lost:
+            if self._conn_lost >= constants.LOG_THRESHOLD_FOR_CONNLOST_WRITES:
+                logger.warning('socket.sendto() raised exception.')
+            self._conn_lost += 1
+            return
+
+        # Ensure that what we buffer is immutable.
+        self._buffer.append((bytes(data), addr))
+        if self._write_fut is None:
+            # No write operation is pending, start one
+            self._loop_writing()
+        self._maybe_pause_protocol()
+
+    def _loop_writing(self, fut=None):
+        try:
+            if self._buffer is None:
+                # _force_close() was called
+                return
+            assert fut is self._write_fut
+            self._write_fut = None
+            if fut is not None:
+                try:
+                    fut.result()
+                except OSError as exc:
+                    # a failed datagram doesn't prevent sending the next ones
+                    self._protocol.error_received(exc)
+            if not self._buffer:
+                self._maybe_resume_protocol()
+                if self._closing:
+                    self._loop.call_soon(self._call_connection_lost, None)
+                return
+            data, addr = self._buffer.popleft()
+            if self._address is not None:
+                self._write_fut = self._loop._proactor.send(self._sock, data)
+            else:
+                self._write_fut = self._loop._proactor.sendto(self._sock,
+                                                              data,
+                                                              addr=addr)
+            stats = self._stats
+            stats.writes += 1
+            stats.bytes_sent += len(data)
+        except OSError as exc:
+            self._protocol.error_received(exc)
+            if self._buffer:
+                self._loop.call_soon(self._loop_writing)
+        except Exception as exc:
+            self._fatal_error(exc, 'Fatal write error on datagram transport')
+        else:
+            self._write_fut.add_done_callback(self._loop_writing)
+            self._maybe_resume_protocol()
+
+    def _loop_reading(self, fut=None):
+        datagram = None
+        try:
+            if self._conn_lost:
+                return
+            assert self._read_fut is fut or (self._read_fut is None and
+                                             self._closing)
+            self._read_fut = None
+            if fut is not None:
+                try:
+                    res = fut.result()
+                except OSError as exc:
+                    # for example, ICMP port unreachable for a previous
+                    # datagram: continue reading
+                    self._protocol.error_received(exc)
+                else:
+                    if self._address is not None:
+                        datagram = (res, self._address)
+                    else:
+                        datagram = res
+                    stats = self._stats
+                    stats.reads += 1
+                    stats.bytes_received += len(datagram[0])
+
+            if self._conn_lost:
+                # since close() has been called we ignore any read data
+                datagram = None
+                return
+
+            if self._address is not None:
+                self._read_fut = self._loop._proactor.recv(self._sock,
+                                                           self.max_size)
+            else:
+                self._read_fut = self._loop._proactor.recvfrom(self._sock,
+                                                               self.max_size)
+        except OSError as exc:
+            self._protocol.error_received(exc)
+        except futures.CancelledError:
+            if not self._closing:
+                raise
+        except Exception as exc:
+            self._fatal_error(exc, 'Fatal read error on datagram transport')
+        else:
+            self._read_fut.add_done_callback(self._loop_reading)
+        finally:
+            if datagram is not None:
+                self._datagrams_received([datagram])
+
+
 class BaseProactorEventLoop(base_events.BaseEventLoop):
 
+    # Number of accept operations kept posted on each listening socket or
+    # pipe server; start_serving_pipe() also takes it as argument
+    accept_concurrency = 1
+
     def __init__(self, proactor):
         super().__init__()
         logger.debug('Using proactor: %s', proactor.__class__.__name__)
         self._proactor = proactor
         self._selector = proactor   # convenient alias
         self._self_reading_future = None
-        self._accept_futures = {}   # socket file descriptor => Future
+        self._accept_futures = set()    # Futures of pending accept()
         proactor.set_loop(self)
         self._make_self_pipe()
 
     def _make_socket_transport(self, sock, protocol, waiter=None,
-                               extra=None, server=None):
+                               extra=None, server=None, *,
+                               read_size_limits=None):
         return _ProactorSocketTransport(self, sock, protocol, waiter,
-                                        extra, server)
+                                        extra, server,
+                                        read_size_limits=read_size_limits)
 
     def _make_ssl_transport(self, rawsock, protocol, sslcontext, waiter=None,
                             *, server_side=False, server_hostname=None,
-                            extra=None, server=None):
+                            extra=None, server=None, read_size_limits=None):
         if not sslproto._is_sslproto_available():
             raise NotImplementedError("Proactor event loop requires Python 3.5"
                                       " or newer (ssl.MemoryBIO) to support "
                                       "SSL")
 
-        ssl_protocol = sslproto.SSLProtocol(self, protocol, sslcontext, waiter,
-                                            server_side, server_hostname)
-        _ProactorSocketTransport(self, rawsock, ssl_protocol,
-                                 extra=extra, server=server)
-        return ssl_protocol._app_transport
+        return _ProactorSSLTransport(self, rawsock, protocol, sslcontext,
+                                     waiter, server_side, server_hostname,
+                                     extra, server,
+                                     read_size_limits=read_size_limits)
+
+    def _make_datagram_transport(self, sock, protocol,
+                                 address=None, waiter=None, extra=None):
+        return _ProactorDatagramTransport(self, sock, protocol, address,
+                                          waiter, extra)
 
     def _make_duplex_pipe_transport(self, sock, protocol, waiter=None,
                                     extra=None):
@@ -429,9 +1029,19 @@ def close(self):
         # Close the event loop
         super().close()
 
+    def get_stats(self):
+        info = super().get_stats()
+        if info is not None and self._proactor is not None:
+            # Number of overlapped operations waiting for their completion
+            info['pending_operations'] = len(self._proactor._cache)
+        return info
+
     def sock_recv(self, sock, n):
         return self._proactor.recv(sock, n)
 
+    def sock_recv_into(self, sock, buf):
+        return self._proactor.recv_into(sock, buf)
+
     def sock_sendall(self, sock, data):
         return self._proactor.send(sock, data)
 
@@ -449,6 +1059,42 @@ def sock_connect(self, sock, address):
     def sock_accept(self, sock):
         return self._proactor.accept(sock)
 
+    @coroutine
+    def _sock_sendfile_native(self, sock, file, offset, count):
+        sendfile = getattr(self._proactor, 'sendfile', None)
+        if sendfile is None:
+            raise events.SendfileNotAvailableError(
+                "the proactor does not support sendfile")
+        try:
+            fileno = file.fileno()
+        except (AttributeError, io.UnsupportedOperation):
+            raise events.SendfileNotAvailableError("not a regular file")
+        try:
+            fsize = os.fstat(fileno).st_size
+        except OSError:
+            raise events.SendfileNotAvailableError("not a regular file")
+        blocksize = count if count else fsize
+        if not blocksize:
+            # empty file
+            return 0
+
+        # TransmitFile() sends at most 2**32 - 1 bytes per call
+        blocksize = min(blocksize, 0xffffffff)
+        end_pos = min(offset + count, fsize) if count else fsize
+        offset = min(offset, fsize)
+        total_sent = 0
+        try:
+            while True:
+                blocksize = min(end_pos - offset, blocksize)
+                if blocksize <= 0:
+                    return total_sent
+                yield from sendfile(sock, file, offset, blocksize)
+                offset += blocksize
+                total_sent += blocksize
+        finally:
+            if total_sent > 0:
+                file.seek(offset)
+
     def _socketpair(self):
         raise NotImplementedError
 
@@ -492,11 +1138,12 @@ def _write_to_self(self):
         self._csock.send(b'\0')
 
     def _start_serving(self, protocol_factory, sock,
-                       sslcontext=None, server=None):
+                       sslcontext=None, server=None, read_size_limits=None):
 
         def loop(f=None):
             try:
                 if f is not None:
+                    self._accept_futures.discard(f)
                     conn, addr = f.result()
                     if self._debug:
                         logger.debug("%r got a new connection from %r: %r",
@@ -505,11 +1152,13 @@ def loop(f=None):
                     if sslcontext is not None:
                         self._make_ssl_transport(
                             conn, protocol, sslcontext, server_side=True,
-                            extra={'peername': addr}, server=server)
+                            extra={'peername': addr}, server=server,
+                            read_size_limits=read_size_limits)
                     else:
                         self._make_socket_transport(
                             conn, protocol,
-                            extra={'peername': addr}, server=server)
+                            extra={'peername': addr}, server=server,
+                            read_size_limits=read_size_limits)
                 if self.is_closed():
                     return
                 f = self._proactor.accept(sock)
@@ -527,17 +1176,20 @@ def loop(f=None):
             except futures.CancelledError:
                 sock.close()
             else:
-                self._accept_futures[sock.fileno()] = f
+                self._accept_futures.add(f)
                 f.add_done_callback(loop)
 
-        self.call_soon(loop)
+        # Each loop keeps one accept operation posted: incoming connections
+        # are accepted without waiting for the previous one to be handled
+        for i in range(self.accept_concurrency):
+            self.call_soon(loop)
 
     def _process_events(self, event_list):
         # Events are processed in the IocpProactor._poll() method
         pass
 
     def _stop_accept_futures(self):
-        for future in self._accept_futures.values():
+        for future in self._accept_futures:
             future.cancel()
         self._accept_futures.clear()
 
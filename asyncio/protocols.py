@@ -106,6 +106,17 @@ class DatagramProtocol(BaseProtocol):
     def datagram_received(self, data, addr):
         """Called when some datagram is received."""
 
+    def datagrams_received(self, datagrams):
+        """Called when datagrams are received.
+
+        datagrams is a list of (data, addr) pairs, the datagrams read at
+        once by the transport.  The default implementation calls
+        datagram_received() for each datagram: override this method to
+        process a batch of datagrams at once.
+        """
+        for data, addr in datagrams:
+            self.datagram_received(data, addr)
+
     def error_received(self, exc):
         """Called when a send or receive operation raises an OSError.
 
@@ -4,6 +4,7 @@
 
 import collections
 import heapq
+import threading
 
 from . import compat
 from . import events
@@ -52,6 +53,12 @@ def __init__(self, maxsize=0, *, loop=None):
         self._unfinished_tasks = 0
         self._finished = locks.Event(loop=self._loop)
         self._finished.set()
+        # Items put by put_many_threadsafe(), not yet moved to the queue
+        self._threadsafe_lock = threading.Lock()
+        self._threadsafe_items = []
+        self._threadsafe_scheduled = False
+        # Task putting the items of other threads into a full queue
+        self._threadsafe_feeder = None
         self._init(maxsize)
 
     # These three are overridable in subclasses.
@@ -72,6 +79,30 @@ def __put_internal(self, item):
         self._unfinished_tasks += 1
         self._finished.clear()
 
+    def __put_available(self, items):
+        # Put items until the queue is full, return the remaining items
+        items = list(items)
+        index = 0
+        nitem = len(items)
+        self._consume_done_getters()
+        while self._getters and index < nitem:
+            getter = self._getters.popleft()
+            self.__put_internal(items[index])
+            index += 1
+            # getter cannot be cancelled, we just removed done getters
+            getter.set_result(self._get())
+            self._consume_done_getters()
+
+        count = nitem - index
+        if self._maxsize > 0:
+            count = max(min(count, self._maxsize - self.qsize()), 0)
+        if count:
+            for item in items[index:index + count]:
+                self._put(item)
+            self._unfinished_tasks += count
+            self._finished.clear()
+        return items[index + count:]
+
     def __repr__(self):
         return '<{} at {:#x} {}>'.format(
             type(self).__name__, id(self), self._format())
@@ -134,26 +165,15 @@ def put(self, item):
 
         This method is a coroutine.
         """
-        self._consume_done_getters()
-        if self._getters:
-            assert not self._queue, (
-                'queue non-empty, why are getters waiting?')
-
-            getter = self._getters.popleft()
-            self.__put_internal(item)
-
-            # getter cannot be cancelled, we just removed done getters
-            getter.set_result(self._get())
-
-        elif self._maxsize > 0 and self._maxsize <= self.qsize():
+        while self._maxsize > 0 and self._maxsize <= self.qsize():
             waiter = futures.Future(loop=self._loop)
 
             self._putters.append(waiter)
             yield from waiter
-            self._put(item)
+            # A getter may have emptied the queue and be waiting in the
+            # meanwhile: check again
 
-        else:
-            self.__put_internal(item)
+        self.put_nowait(item)
 
     def put_nowait(self, item):
         """Put an item into the queue without blocking.
@@ -216,6 +236,77 @@ def get(self):
                     self._put_it_back(waiter.result())
                 raise
 
+    @coroutine
+    def put_many(self, items):
+        """Put items into the queue, in order.
+
+        The items which fit into the queue are put without suspending the
+        caller.  If the queue is full, wait until free slots are available
+        before adding the other items.
+
+        This method is a coroutine.
+        """
+        items = self.__put_available(items)
+        for item in items:
+            yield from self.put(item)
+
+    def put_many_nowait(self, items):
+        """Put items into the queue without blocking.
+
+        If there are not enough free slots for all items, put the items
+        which fit and raise QueueFull.
+        """
+        if self.__put_available(items):
+            raise QueueFull
+
+    def put_many_threadsafe(self, items):
+        """Put items into the queue from another thread.
+
+        The items are put from a callback of the event loop, scheduled once
+        for all the calls made before it runs.  If the queue is full, they
+        wait in the event loop for free slots: the calling thread is never
+        blocked.  The items of successive calls are put in order.
+        """
+        with self._threadsafe_lock:
+            self._threadsafe_items.extend(items)
+            if self._threadsafe_scheduled:
+                return
+            self._threadsafe_scheduled = True
+        self._loop.call_soon_threadsafe(self._feed_threadsafe)
+
+    def put_threadsafe(self, item):
+        """Put an item into the queue from another thread.
+
+        See put_many_threadsafe().
+        """
+        self.put_many_threadsafe((item,))
+
+    def _take_threadsafe_items(self):
+        with self._threadsafe_lock:
+            items = self._threadsafe_items
+            self._threadsafe_items = []
+            self._threadsafe_scheduled = False
+        return items
+
+    def _feed_threadsafe(self):
+        if self._threadsafe_feeder is not None:
+            # The feeder task takes the new items once it put the previous
+            # ones
+            return
+        items = self.__put_available(self._take_threadsafe_items())
+        if items:
+            self._threadsafe_feeder = self._loop.create_task(
+                self._feed_threadsafe_full(items))
+
+    @coroutine
+    def _feed_threadsafe_full(self, items):
+        try:
+            while items:
+                yield from self.put_many(items)
+                items = self._take_threadsafe_items()
+        finally:
+            self._threadsafe_feeder = None
+
     def _put_it_back(self, item):
         """
         This is called when we have a waiter to get() an item and this waiter
@@ -256,6 +347,51 @@ def get_nowait(self):
         else:
             raise QueueEmpty
 
+    @coroutine
+    def get_many(self, max=None):
+        """Remove and return a list of items from the queue.
+
+        Return all the available items, or at most max items if max is not
+        None.  If the queue is empty, wait until an item is available.
+
+        This method is a coroutine.
+        """
+        if max is not None and max < 1:
+            raise ValueError('max must be >= 1, got %r' % max)
+        if self.qsize():
+            return self.get_many_nowait(max)
+        items = [(yield from self.get())]
+        if self.qsize() and (max is None or max > 1):
+            items.extend(self.get_many_nowait(None if max is None
+                                              else max - 1))
+        return items
+
+    def get_many_nowait(self, max=None):
+        """Remove and return a list of items from the queue without blocking.
+
+        Return all the available items, or at most max items if max is not
+        None.  If the queue is empty, raise QueueEmpty.
+        """
+        if max is not None and max < 1:
+            raise ValueError('max must be >= 1, got %r' % max)
+        count = self.qsize()
+        if not count:
+            raise QueueEmpty
+        if max is not None:
+            count = min(count, max)
+        get = self._get
+        items = [get() for index in range(count)]
+
+        # Wake up one putter per free slot
+        for index in range(count):
+            self._consume_done_putters()
+            if not self._putters:
+                break
+            putter = self._putters.popleft()
+            # putter cannot be cancelled, we just removed done putters
+            putter.set_result(None)
+        return items
+
     def task_done(self):
         """Indicate that a formerly enqueued task is complete.
 
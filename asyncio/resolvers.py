@@ -0,0 +1,552 @@
+"""Resolvers of host names used by the event loop.
+
+By default, the event loop calls socket.getaddrinfo() in its default
+executor.  A resolver can be set with loop.set_resolver() to replace it.
+"""
+
+__all__ = ['AbstractResolver', 'ExecutorResolver', 'DNSResolver']
+
+import collections
+import os
+import random
+import socket
+import struct
+
+from . import events
+from . import futures
+from . import protocols
+from . import tasks
+from .coroutines import coroutine
+from .log import logger
+
+
+_DNS_PORT = 53
+
+_RESOLV_CONF_PATH = '/etc/resolv.conf'
+_HOSTS_PATH = '/etc/hosts'
+
+# Delay in seconds between two checks of the modification time of the hosts
+# file
+_HOSTS_CHECK_INTERVAL = 5.0
+
+# Maximum value of the ndots option of resolv.conf
+_MAX_NDOTS = 15
+
+# DNS record types and class
+_TYPE_A = 1
+_TYPE_CNAME = 5
+_TYPE_SOA = 6
+_TYPE_AAAA = 28
+_CLASS_IN = 1
+
+# DNS response codes
+_RCODE_NOERROR = 0
+_RCODE_NXDOMAIN = 3
+
+_QTYPE_FAMILY = {_TYPE_A: socket.AF_INET, _TYPE_AAAA: socket.AF_INET6}
+
+# Flags of getaddrinfo() which don't change the result of the DNS resolver
+_SUPPORTED_FLAGS = socket.AI_PASSIVE | getattr(socket, 'AI_ADDRCONFIG', 0)
+
+# (type, proto) pairs returned by getaddrinfo() for each socket type
+_SOCKET_TYPES = {
+    socket.SOCK_STREAM: ((socket.SOCK_STREAM, socket.IPPROTO_TCP),),
+    socket.SOCK_DGRAM: ((socket.SOCK_DGRAM, socket.IPPROTO_UDP),),
+    socket.SOCK_RAW: ((socket.SOCK_RAW, 0),),
+}
+_SOCKET_TYPES[0] = (_SOCKET_TYPES[socket.SOCK_STREAM]
+                    + _SOCKET_TYPES[socket.SOCK_DGRAM]
+                    + _SOCKET_TYPES[socket.SOCK_RAW])
+
+_random = random.SystemRandom()
+
+
+class _DNSError(Exception):
+    """Failure of the DNS resolution: the fallback resolver is used."""
+
+
+def _read_resolv_conf(path=_RESOLV_CONF_PATH):
+    # Return a (nameservers, search, ndots) tuple
+    nameservers = []
+    search = []
+    ndots = 1
+    try:
+        with open(path) as fp:
+            for line in fp:
+                fields = line.split()
+                if len(fields) < 2:
+                    continue
+                if fields[0] == 'nameserver':
+                    nameservers.append(fields[1])
+                elif fields[0] in ('search', 'domain'):
+                    # The last search or domain line wins
+                    search = fields[1:]
+                elif fields[0] == 'options':
+                    for option in fields[1:]:
+                        if option.startswith('ndots:'):
+                            try:
+                                ndots = min(int(option[6:]), _MAX_NDOTS)
+                            except ValueError:
+                                pass
+    except (OSError, UnicodeDecodeError):
+        pass
+    return nameservers, search, ndots
+
+
+def _read_hosts(path=_HOSTS_PATH):
+    names = set()
+    try:
+        with open(path) as fp:
+            for line in fp:
+                fields = line.split('#', 1)[0].split()
+                names.update(name.lower() for name in fields[1:])
+    except (OSError, UnicodeDecodeError):
+        pass
+    return names
+
+
+def _is_ip_address(host):
+    for family in (socket.AF_INET, socket.AF_INET6):
+        try:
+            socket.inet_pton(family, host)
+        except (OSError, ValueError):
+            pass
+        else:
+            return True
+    return False
+
+
+def _encode_name(name):
+    # Return the name encoded in the DNS wire format
+    labels = name.encode('idna').split(b'.')
+    if len(name) > 253 or not all(0 < len(label) < 64 for label in labels):
+        raise ValueError('invalid host name: %r' % name)
+    return b''.join(bytes((len(label),)) + label for label in labels) + b'\0'
+
+
+def _build_query(query_id, name, qtype):
+    # Header with the "recursion desired" flag, followed by the question
+    header = struct.pack('!6H', query_id, 0x0100, 1, 0, 0, 0)
+    return header + _encode_name(name) + struct.pack('!2H', qtype, _CLASS_IN)
+
+
+def _read_name(data, offset):
+    # Return a (name, offset) tuple: the offset is the end of the name in data
+    labels = []
+    end = None
+    # Limit the number of compression pointers to detect loops
+    for jumps in range(64):
+        while True:
+            length = data[offset]
+            if length & 0xC0 == 0xC0:
+                break
+            if not length:
+                name = b'.'.join(labels).decode('ascii').lower()
+                if end is None:
+                    end = offset + 1
+                return name, end
+            labels.append(data[offset + 1:offset + 1 + length])
+            offset += 1 + length
+        if end is None:
+            end = offset + 2
+        offset = ((length & 0x3F) << 8) | data[offset + 1]
+    raise _DNSError('too many compression pointers')
+
+
+def _parse_response(data, query_id, name, qtype):
+    """Parse a DNS response.
+
+    Return an (rcode, answers, authority) tuple, the answers and authority
+    lists contain (name, type, ttl, rdata) tuples.  Return None if data is
+    not the response to the query.  Raise _DNSError if the response is
+    invalid or truncated.
+    """
+    try:
+        (response_id, flags, qdcount,
+         ancount, nscount, arcount) = struct.unpack_from('!6H', data)
+        if response_id != query_id or not flags & 0x8000 or qdcount != 1:
+            return None
+        qname, offset = _read_name(data, 12)
+        if (qname != name
+        or struct.unpack_from('!2H', data, offset) != (qtype, _CLASS_IN)):
+            return None
+        if flags & 0x0200:
+            raise _DNSError('truncated response')
+        offset += 4
+
+        sections = []
+        for count in (ancount, nscount):
+            records = []
+            for index in range(count):
+                rname, offset = _read_name(data, offset)
+                rtype, rclass, ttl, size = struct.unpack_from('!HHIH', data,
+                                                               offset)
+                offset += 10
+                rdata = data[offset:offset + size]
+                if len(rdata) != size:
+                    raise _DNSError('truncated record')
+                if rtype == _TYPE_CNAME:
+                    rdata = _read_name(data, offset)[0]
+                offset += size
+                if rclass == _CLASS_IN:
+                    records.append((rname, rtype, ttl, rdata))
+            sections.append(records)
+    except (IndexError, struct.error, UnicodeDecodeError) as exc:
+        raise _DNSError('invalid response: %s' % exc)
+    return (flags & 0x000F, sections[0], sections[1])
+
+
+def _extract_addresses(name, qtype, answers, authority):
+    # Return an (addresses, ttl) tuple, ttl is None if unknown.  Follow the
+    # chain of CNAME records starting at name.
+    names = {name}
+    addresses = []
+    ttl = None
+    for rname, rtype, rttl, rdata in answers:
+        if rname not in names:
+            continue
+        if rtype == _TYPE_CNAME:
+            names.add(rdata)
+        elif rtype == qtype and len(rdata) in (4, 16):
+            addresses.append(socket.inet_ntop(_QTYPE_FAMILY[qtype], rdata))
+        else:
+            continue
+        ttl = rttl if ttl is None else min(ttl, rttl)
+    if not addresses:
+        # Negative answer: use the TTL of the SOA record (RFC 2308)
+        ttl = None
+        for rname, rtype, rttl, rdata in authority:
+            if rtype == _TYPE_SOA and len(rdata) >= 4:
+                minimum = struct.unpack('!I', rdata[-4:])[0]
+                ttl = min(rttl, minimum)
+    return addresses, ttl
+
+
+class _DNSProtocol(protocols.DatagramProtocol):
+
+    def __init__(self, query_id, name, qtype, waiter):
+        self._query_id = query_id
+        self._name = name
+        self._qtype = qtype
+        self._waiter = waiter
+
+    def datagram_received(self, data, addr):
+        if self._waiter.done():
+            return
+        try:
+            response = _parse_response(data, self._query_id,
+                                       self._name, self._qtype)
+        except _DNSError as exc:
+            self._waiter.set_exception(exc)
+        else:
+            # Ignore datagrams which are not a response to the query
+            if response is not None:
+                self._waiter.set_result(response)
+
+    def error_received(self, exc):
+        if not self._waiter.done():
+            self._waiter.set_exception(exc)
+
+    def connection_lost(self, exc):
+        if exc is not None and not self._waiter.done():
+            self._waiter.set_exception(exc)
+
+
+class AbstractResolver:
+    """Abstract resolver of host names."""
+
+    def getaddrinfo(self, host, port, *, family=0, type=0, proto=0, flags=0):
+        """Resolve host and port like socket.getaddrinfo().
+
+        Return a future or a coroutine object, its result is a list of
+        (family, type, proto, canonname, sockaddr) tuples.
+        """
+        raise NotImplementedError
+
+
+class ExecutorResolver(AbstractResolver):
+    """Resolver calling socket.getaddrinfo() in an executor.
+
+    If executor is None, the default executor of the event loop is used.
+    """
+
+    def __init__(self, executor=None, *, loop=None):
+        if loop is None:
+            self._loop = events.get_event_loop()
+        else:
+            self._loop = loop
+        self._executor = executor
+
+    def getaddrinfo(self, host, port, *, family=0, type=0, proto=0, flags=0):
+        return self._loop.run_in_executor(self._executor, socket.getaddrinfo,
+                                          host, port, family, type, proto,
+                                          flags)
+
+
+class DNSResolver(AbstractResolver):
+    """Resolver sending DNS queries over UDP to the name servers.
+
+    The name servers are a list of IP addresses or (address, port) tuples.
+    By default, they are read from /etc/resolv.conf.  A query is sent to
+    each name server in turn until a response is received, the list is
+    tried tries times.  The addresses of a host are cached for the TTL of
+    the DNS records, up to max_ttl seconds, and at most cache_size records
+    are kept.  Concurrent lookups of the same host share their queries.
+
+    A relative name is qualified with the domains of the search list, like
+    the system resolver does: a name with at least ndots dots is tried as
+    is before the search list, other names after it.  The search list and
+    ndots are also read from /etc/resolv.conf if nameservers is None.
+
+    IP addresses are converted without any query.  The fallback resolver,
+    an ExecutorResolver by default, is used for hosts which are not sent
+    to the name servers (names without a dot, names of the hosts file,
+    which is reloaded when it is modified), for unsupported arguments
+    (service names, AI_CANONNAME flag, etc.) and when no name server
+    answers.  IPv4 addresses are returned before IPv6 addresses.
+    """
+
+    def __init__(self, nameservers=None, *, search=None, ndots=None,
+                 timeout=2.0, tries=2, cache_size=1024, max_ttl=3600.0,
+                 fallback=None, loop=None):
+        if loop is None:
+            self._loop = events.get_event_loop()
+        else:
+            self._loop = loop
+        if nameservers is None:
+            nameservers, conf_search, conf_ndots = _read_resolv_conf()
+            self._hosts_path = _HOSTS_PATH
+        else:
+            conf_search, conf_ndots = [], 1
+            self._hosts_path = None
+        if search is None:
+            search = conf_search
+        if ndots is None:
+            ndots = conf_ndots
+        self._nameservers = []
+        for nameserver in nameservers:
+            if isinstance(nameserver, str):
+                nameserver = (nameserver, _DNS_PORT)
+            self._nameservers.append(tuple(nameserver))
+        self._search = [domain.rstrip('.').lower() for domain in search]
+        self._ndots = ndots
+        # Names of the hosts file, its modification time and the loop time
+        # of the next check
+        self._hosts = set()
+        self._hosts_mtime = None
+        self._hosts_check = None
+        self._update_hosts()
+        self._timeout = timeout
+        self._tries = tries
+        self._cache_size = cache_size
+        self._max_ttl = max_ttl
+        if fallback is None:
+            fallback = ExecutorResolver(loop=self._loop)
+        self._fallback = fallback
+        # (name, qtype) => (expiration time, list of addresses)
+        self._cache = collections.OrderedDict()
+        # (name, qtype) => task of the pending query
+        self._pending = {}
+
+    def __repr__(self):
+        return ('<%s nameservers=%r cached=%s>'
+                % (self.__class__.__name__, self._nameservers,
+                   len(self._cache)))
+
+    def clear_cache(self):
+        """Remove all the addresses from the cache."""
+        self._cache.clear()
+
+    def _update_hosts(self):
+        # Reload the hosts file if it was modified since it was read
+        if self._hosts_path is None:
+            return
+        now = self._loop.time()
+        if self._hosts_check is not None and now < self._hosts_check:
+            return
+        self._hosts_check = now + _HOSTS_CHECK_INTERVAL
+        try:
+            mtime = os.stat(self._hosts_path).st_mtime
+        except OSError:
+            mtime = None
+        if mtime != self._hosts_mtime:
+            self._hosts_mtime = mtime
+            self._hosts = _read_hosts(self._hosts_path)
+
+    def _get_names(self, host):
+        # Return the list of names to query for host, in order
+        name = host.rstrip('.').lower()
+        if host.endswith('.') or not self._search:
+            names = [name]
+        else:
+            qualified = [name + '.' + domain for domain in self._search]
+            if name.count('.') >= self._ndots:
+                names = [name] + qualified
+            else:
+                names = qualified + [name]
+        valid_names = []
+        for name in names:
+            try:
+                _encode_name(name)
+            except (ValueError, UnicodeError):
+                continue
+            valid_names.append(name)
+        return valid_names
+
+    def _get_qtypes(self, host, port, family, type, flags):
+        # Return the record types to query, or None to use the fallback
+        if (not self._nameservers
+        or not isinstance(host, str)
+        or flags & ~_SUPPORTED_FLAGS
+        or type not in _SOCKET_TYPES
+        or not isinstance(port, int)):
+            return None
+        self._update_hosts()
+        name = host.rstrip('.').lower()
+        if '.' not in name or name in self._hosts:
+            return None
+        if family == socket.AF_UNSPEC:
+            return (_TYPE_A, _TYPE_AAAA)
+        elif family == socket.AF_INET:
+            return (_TYPE_A,)
+        elif family == socket.AF_INET6:
+            return (_TYPE_AAAA,)
+        else:
+            return None
+
+    @coroutine
+    def getaddrinfo(self, host, port, *, family=0, type=0, proto=0, flags=0):
+        if port is None:
+            port = 0
+        elif isinstance(port, (str, bytes)) and port.isdigit():
+            port = int(port)
+        if isinstance(host, str) and _is_ip_address(host):
+            # No name resolution is needed
+            return socket.getaddrinfo(host, port, family, type, proto,
+                                      flags | socket.AI_NUMERICHOST)
+
+        qtypes = self._get_qtypes(host, port, family, type, flags)
+        if qtypes is not None:
+            names = self._get_names(host)
+            if not names:
+                qtypes = None
+        if qtypes is None:
+            return (yield from self._fallback.getaddrinfo(
+                host, port, family=family, type=type, proto=proto,
+                flags=flags))
+
+        try:
+            for name in names:
+                # The queries are shared with the other lookups: don't
+                # cancel them if this lookup is cancelled
+                results = yield from tasks.gather(
+                    *[tasks.shield(self._resolve(name, qtype),
+                                   loop=self._loop)
+                      for qtype in qtypes], loop=self._loop)
+                if any(results):
+                    break
+        except _DNSError as exc:
+            if self._loop.get_debug():
+                logger.debug('%r failed to resolve %r: %s, '
+                             'use the fallback resolver', self, host, exc)
+            return (yield from self._fallback.getaddrinfo(
+                host, port, family=family, type=type, proto=proto,
+                flags=flags))
+
+        if type and proto:
+            socket_types = ((type, proto),)
+        else:
+            socket_types = _SOCKET_TYPES[type]
+        infos = []
+        for qtype, addresses in zip(qtypes, results):
+            addr_family = _QTYPE_FAMILY[qtype]
+            for address in addresses:
+                if addr_family == socket.AF_INET6:
+                    sockaddr = (address, port, 0, 0)
+                else:
+                    sockaddr = (address, port)
+                for sock_type, sock_proto in socket_types:
+                    infos.append((addr_family, sock_type, sock_proto,
+                                  '', sockaddr))
+        if not infos:
+            raise socket.gaierror(socket.EAI_NONAME,
+                                  'Name or service not known')
+        return infos
+
+    def _resolve(self, name, qtype):
+        # Return a future of the list of addresses
+        key = (name, qtype)
+        entry = self._cache.get(key)
+        if entry is not None:
+            expires, addresses = entry
+            if expires > self._loop.time():
+                self._cache.move_to_end(key)
+                fut = futures.Future(loop=self._loop)
+                fut.set_result(addresses)
+                return fut
+            del self._cache[key]
+
+        task = self._pending.get(key)
+        if task is None:
+            task = tasks.ensure_future(self._query(name, qtype),
+                                       loop=self._loop)
+            self._pending[key] = task
+        return task
+
+    def _cache_addresses(self, key, addresses, ttl):
+        if not ttl or not self._cache_size:
+            return
+        ttl = min(ttl, self._max_ttl)
+        self._cache[key] = (self._loop.time() + ttl, addresses)
+        self._cache.move_to_end(key)
+        if len(self._cache) > self._cache_size:
+            self._cache.popitem(last=False)
+
+    @coroutine
+    def _query(self, name, qtype):
+        key = (name, qtype)
+        try:
+            for attempt in range(self._tries):
+                for nameserver in self._nameservers:
+                    try:
+                        response = yield from self._send_query(nameserver,
+                                                               name, qtype)
+                    except NotImplementedError:
+                        # The event loop has no datagram transport
+                        raise _DNSError('UDP is not supported by the loop')
+                    except (OSError, _DNSError,
+                            futures.TimeoutError) as exc:
+                        if self._loop.get_debug():
+                            logger.debug('%r: query to %r failed: %r',
+                                         self, nameserver, exc)
+                        continue
+                    rcode, answers, authority = response
+                    if rcode not in (_RCODE_NOERROR, _RCODE_NXDOMAIN):
+                        # SERVFAIL, REFUSED, etc.: try the next name server
+                        continue
+                    addresses, ttl = _extract_addresses(name, qtype,
+                                                        answers, authority)
+                    self._cache_addresses(key, addresses, ttl)
+                    return addresses
+            raise _DNSError('no response from the name servers')
+        finally:
+            del self._pending[key]
+
+    @coroutine
+    def _send_query(self, nameserver, name, qtype):
+        query_id = _random.getrandbits(16)
+        query = _build_query(query_id, name, qtype)
+        waiter = futures.Future(loop=self._loop)
+        protocol = _DNSProtocol(query_id, name, qtype, waiter)
+
+        # The address of the name server is numeric: its getaddrinfo() call
+        # doesn't send any query
+        transport, protocol = yield from self._loop.create_datagram_endpoint(
+            lambda: protocol, remote_addr=nameserver,
+            flags=socket.AI_NUMERICHOST)
+        try:
+            transport.sendto(query)
+            return (yield from tasks.wait_for(waiter, self._timeout,
+                                              loop=self._loop))
+        finally:
+            transport.close()
@@ -9,6 +9,8 @@
 import collections
 import errno
 import functools
+import itertools
+import os
 import socket
 import warnings
 try:
@@ -28,6 +30,13 @@
 from .log import logger
 
 
+# Maximum number of buffers passed to a single sendmsg() call.
+try:
+    _IOV_MAX = max(os.sysconf('SC_IOV_MAX'), 16)
+except (AttributeError, ValueError, OSError):
+    _IOV_MAX = 16
+
+
 def _test_selector_event(selector, fd, event):
     # Test if the selector is monitoring 'event' events
     # for the file descriptor 'fd'.
@@ -45,6 +54,10 @@ class BaseSelectorEventLoop(base_events.BaseEventLoop):
     See events.EventLoop for API specification.
     """
 
+    # Use the buffered mode of the SSL pipe in the SSL transports: see
+    # sslproto.SSLProtocol
+    ssl_buffered = False
+
     def __init__(self, selector=None):
         super().__init__()
 
@@ -55,13 +68,15 @@ def __init__(self, selector=None):
         self._make_self_pipe()
 
     def _make_socket_transport(self, sock, protocol, waiter=None, *,
-                               extra=None, server=None):
+                               extra=None, server=None,
+                               read_size_limits=None):
         return _SelectorSocketTransport(self, sock, protocol, waiter,
-                                        extra, server)
+                                        extra, server,
+                                        read_size_limits=read_size_limits)
 
     def _make_ssl_transport(self, rawsock, protocol, sslcontext, waiter=None,
                             *, server_side=False, server_hostname=None,
-                            extra=None, server=None):
+                            extra=None, server=None, read_size_limits=None):
         if not sslproto._is_sslproto_available():
             return self._make_legacy_ssl_transport(
                 rawsock, protocol, sslcontext, waiter,
@@ -69,9 +84,11 @@ def _make_ssl_transport(self, rawsock, protocol, sslcontext, waiter=None,
                 extra=extra, server=server)
 
         ssl_protocol = sslproto.SSLProtocol(self, protocol, sslcontext, waiter,
-                                            server_side, server_hostname)
+                                            server_side, server_hostname,
+                                            buffered=self.ssl_buffered)
         _SelectorSocketTransport(self, rawsock, ssl_protocol,
-                                 extra=extra, server=server)
+                                 extra=extra, server=server,
+                                 read_size_limits=read_size_limits)
         return ssl_protocol._app_transport
 
     def _make_legacy_ssl_transport(self, rawsock, protocol, sslcontext,
@@ -151,12 +168,14 @@ def _write_to_self(self):
                                  exc_info=True)
 
     def _start_serving(self, protocol_factory, sock,
-                       sslcontext=None, server=None):
+                       sslcontext=None, server=None, read_size_limits=None):
         self.add_reader(sock.fileno(), self._accept_connection,
-                        protocol_factory, sock, sslcontext, server)
+                        protocol_factory, sock, sslcontext, server,
+                        read_size_limits)
 
     def _accept_connection(self, protocol_factory, sock,
-                           sslcontext=None, server=None):
+                           sslcontext=None, server=None,
+                           read_size_limits=None):
         try:
             conn, addr = sock.accept()
             if self._debug:
@@ -180,18 +199,21 @@ def _accept_connection(self, protocol_factory, sock,
                 self.remove_reader(sock.fileno())
                 self.call_later(constants.ACCEPT_RETRY_DELAY,
                                 self._start_serving,
-                                protocol_factory, sock, sslcontext, server)
+                                protocol_factory, sock, sslcontext, server,
+                                read_size_limits)
             else:
                 raise  # The event loop will catch, log and ignore it.
         else:
             extra = {'peername': addr}
             accept = self._accept_connection2(protocol_factory, conn, extra,
-                                              sslcontext, server)
+                                              sslcontext, server,
+                                              read_size_limits)
             self.create_task(accept)
 
     @coroutine
     def _accept_connection2(self, protocol_factory, conn, extra,
-                            sslcontext=None, server=None):
+                            sslcontext=None, server=None,
+                            read_size_limits=None):
         protocol = None
         transport = None
         try:
@@ -200,11 +222,12 @@ def _accept_connection2(self, protocol_factory, conn, extra,
             if sslcontext:
                 transport = self._make_ssl_transport(
                     conn, protocol, sslcontext, waiter=waiter,
-                    server_side=True, extra=extra, server=server)
+                    server_side=True, extra=extra, server=server,
+                    read_size_limits=read_size_limits)
             else:
                 transport = self._make_socket_transport(
                     conn, protocol, waiter=waiter, extra=extra,
-                    server=server)
+                    server=server, read_size_limits=read_size_limits)
 
             try:
                 yield from waiter
@@ -339,6 +362,37 @@ def _sock_recv(self, fut, registered, sock, n):
         else:
             fut.set_result(data)
 
+    def sock_recv_into(self, sock, buf):
+        """Receive data from the socket into the writable buffer buf.
+
+        The return value is the number of bytes written into buf.
+
+        This method is a coroutine.
+        """
+        if self._debug and sock.gettimeout() != 0:
+            raise ValueError("the socket must be non-blocking")
+        fut = futures.Future(loop=self)
+        self._sock_recv_into(fut, False, sock, buf)
+        return fut
+
+    def _sock_recv_into(self, fut, registered, sock, buf):
+        # _sock_recv_into() can add itself as an I/O callback if the operation
+        # can't be done immediately. Don't use it directly, call
+        # sock_recv_into().
+        fd = sock.fileno()
+        if registered:
+            self.remove_reader(fd)
+        if fut.cancelled():
+            return
+        try:
+            nbytes = sock.recv_into(buf)
+        except (BlockingIOError, InterruptedError):
+            self.add_reader(fd, self._sock_recv_into, fut, True, sock, buf)
+        except Exception as exc:
+            fut.set_exception(exc)
+        else:
+            fut.set_result(nbytes)
+
     def sock_sendall(self, sock, data):
         """Send data to the socket.
 
@@ -475,18 +529,25 @@ def _sock_accept(self, fut, registered, sock):
             fut.set_result((conn, address))
 
     def _process_events(self, event_list):
+        if self._debug or self._stats is not None:
+            # _run_once() measures the duration of each callback of _ready
+            add_callback = self._add_callback
+        else:
+            # _run_once() calls the handles after the callbacks which were
+            # ready before the poll: the order is the same than with _ready
+            add_callback = self._io_handles.append
         for key, mask in event_list:
             fileobj, (reader, writer) = key.fileobj, key.data
             if mask & selectors.EVENT_READ and reader is not None:
                 if reader._cancelled:
                     self.remove_reader(fileobj)
                 else:
-                    self._add_callback(reader)
+                    add_callback(reader)
             if mask & selectors.EVENT_WRITE and writer is not None:
                 if writer._cancelled:
                     self.remove_writer(fileobj)
                 else:
-                    self._add_callback(writer)
+                    add_callback(writer)
 
     def _stop_serving(self, sock):
         self.remove_reader(sock.fileno())
@@ -556,6 +617,9 @@ def __repr__(self):
     def abort(self):
         self._force_close(None)
 
+    def is_closing(self):
+        return self._closing
+
     def close(self):
         if self._closing:
             return
@@ -619,13 +683,31 @@ def get_write_buffer_size(self):
         return len(self._buffer)
 
 
-class _SelectorSocketTransport(_SelectorTransport):
+class _SelectorSocketTransport(transports._ReadSizeMixin,
+                               transports._WriteQueueMixin,
+                               _SelectorTransport):
+
+    _buffer_factory = collections.deque
+
+    # loop.sendfile() can send files directly through the socket
+    _sendfile_compatible = True
+    # True while loop.sendfile() sends a file through the socket
+    _sendfile_active = False
+    # Future set when the write buffer is empty, see _make_empty_waiter()
+    _empty_waiter = None
+    # Corked mode, see set_corked(): handle of the scheduled flush()
+    _corked = False
+    _cork_handle = None
 
     def __init__(self, loop, sock, protocol, waiter=None,
-                 extra=None, server=None):
+                 extra=None, server=None, *, read_size_limits=None):
         super().__init__(loop, sock, protocol, extra, server)
         self._eof = False
         self._paused = False
+        if read_size_limits is None:
+            self._set_read_size_limits()
+        else:
+            self._set_read_size_limits(*read_size_limits)
 
         self._loop.call_soon(self._protocol.connection_made, self)
         # only start reading when connection_made() has been called
@@ -641,6 +723,7 @@ def pause_reading(self):
         if self._paused:
             raise RuntimeError('Already paused')
         self._paused = True
+        self._stats.reading_pauses += 1
         self._loop.remove_reader(self._sock_fd)
         if self._loop.get_debug():
             logger.debug("%r pauses reading", self)
@@ -649,6 +732,7 @@ def resume_reading(self):
         if not self._paused:
             raise RuntimeError('Not paused')
         self._paused = False
+        self._stats.reading_resumes += 1
         if self._closing:
             return
         self._loop.add_reader(self._sock_fd, self._read_ready)
@@ -657,13 +741,18 @@ def resume_reading(self):
 
     def _read_ready(self):
         try:
-            data = self._sock.recv(self.max_size)
+            data = self._sock.recv(self._read_size)
         except (BlockingIOError, InterruptedError):
             pass
         except Exception as exc:
             self._fatal_error(exc, 'Fatal read error on socket transport')
         else:
             if data:
+                nbytes = len(data)
+                stats = self._stats
+                stats.reads += 1
+                stats.bytes_received += nbytes
+                self._update_read_size(nbytes)
                 self._protocol.data_received(data)
             else:
                 if self._loop.get_debug():
@@ -683,6 +772,8 @@ def write(self, data):
                             type(data))
         if self._eof:
             raise RuntimeError('Cannot call write() after write_eof()')
+        if self._sendfile_active:
+            raise RuntimeError('unable to write; sendfile is in progress')
         if not data:
             return
 
@@ -692,7 +783,9 @@ def write(self, data):
             self._conn_lost += 1
             return
 
-        if not self._buffer:
+        if self._corked:
+            self._cork()
+        elif not self._buffer:
             # Optimization: try to send now.
             try:
                 n = self._sock.send(data)
@@ -702,37 +795,136 @@ def write(self, data):
                 self._fatal_error(exc, 'Fatal write error on socket transport')
                 return
             else:
-                data = data[n:]
-                if not data:
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += n
+                if n == len(data):
                     return
+                if n:
+                    data = memoryview(data)[n:]
             # Not all was written; register write handler.
             self._loop.add_writer(self._sock_fd, self._write_ready)
 
         # Add it to the buffer.
-        self._buffer.extend(data)
+        self._buffer_append(data)
+        self._maybe_pause_protocol()
+
+    def writelines(self, list_of_data):
+        if self._sendfile_active:
+            raise RuntimeError('unable to write; sendfile is in progress')
+        buffers = []
+        for data in list_of_data:
+            if not isinstance(data, (bytes, bytearray, memoryview)):
+                raise TypeError('data argument must be byte-ish (%r)',
+                                type(data))
+            if data:
+                buffers.append(data)
+        if self._eof:
+            raise RuntimeError('Cannot call write() after write_eof()')
+        if not buffers:
+            return
+
+        if self._conn_lost:
+            if self._conn_lost >= constants.LOG_THRESHOLD_FOR_CONNLOST_WRITES:
+                logger.warning('socket.send() raised exception.')
+            self._conn_lost += 1
+            return
+
+        n = 0
+        if self._corked:
+            self._cork()
+        elif not self._buffer:
+            # Optimization: try to send now with a single vectored write,
+            # without concatenating the buffers.
+            try:
+                if hasattr(self._sock, 'sendmsg'):
+                    n = self._sock.sendmsg(buffers[:_IOV_MAX])
+                else:
+                    n = self._sock.send(buffers[0])
+            except (BlockingIOError, InterruptedError):
+                pass
+            except Exception as exc:
+                self._fatal_error(exc, 'Fatal write error on socket transport')
+                return
+            else:
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += n
+            if n == sum(map(len, buffers)):
+                return
+            # Not all was written; register write handler.
+            self._loop.add_writer(self._sock_fd, self._write_ready)
+
+        # Only queue what was not written.
+        for data in buffers:
+            if n >= len(data):
+                n -= len(data)
+            else:
+                if n:
+                    data = memoryview(data)[n:]
+                    n = 0
+                self._buffer_append(data)
         self._maybe_pause_protocol()
 
+    def _cork(self):
+        # Schedule a flush at the first write since the last flush
+        if self._cork_handle is None and not self._buffer:
+            self._cork_handle = self._loop.call_soon(self.flush)
+
+    def set_corked(self, corked):
+        self._corked = bool(corked)
+        if not corked:
+            self.flush()
+
+    def flush(self):
+        if self._cork_handle is not None:
+            self._cork_handle.cancel()
+            self._cork_handle = None
+        if not self._buffer or self._conn_lost:
+            return
+        self._write_ready()
+        if self._buffer and not self._conn_lost:
+            # Not all was written; register write handler.
+            self._loop.add_writer(self._sock_fd, self._write_ready)
+
     def _write_ready(self):
         assert self._buffer, 'Data should not be empty'
 
+        buffer = self._buffer
+        stats = self._stats
         try:
-            n = self._sock.send(self._buffer)
+            if len(buffer) > 1 and hasattr(self._sock, 'sendmsg'):
+                n = self._sock.sendmsg(list(itertools.islice(buffer,
+                                                             _IOV_MAX)))
+                stats.writes += 1
+                stats.bytes_sent += n
+                self._buffer_consume(n)
+            else:
+                # Send the buffers one by one until the socket is full
+                while buffer:
+                    head = buffer[0]
+                    n = self._sock.send(head)
+                    stats.writes += 1
+                    stats.bytes_sent += n
+                    self._buffer_consume(n)
+                    if n < len(head):
+                        break
         except (BlockingIOError, InterruptedError):
             pass
         except Exception as exc:
             self._loop.remove_writer(self._sock_fd)
-            self._buffer.clear()
+            self._buffer_clear()
             self._fatal_error(exc, 'Fatal write error on socket transport')
-        else:
-            if n:
-                del self._buffer[:n]
-            self._maybe_resume_protocol()  # May append to buffer.
-            if not self._buffer:
-                self._loop.remove_writer(self._sock_fd)
-                if self._closing:
-                    self._call_connection_lost(None)
-                elif self._eof:
-                    self._sock.shutdown(socket.SHUT_WR)
+            return
+
+        self._maybe_resume_protocol()  # May append to buffer.
+        if not self._buffer:
+            self._loop.remove_writer(self._sock_fd)
+            self._wakeup_empty_waiter()
+            if self._closing:
+                self._call_connection_lost(None)
+            elif self._eof:
+                self._sock.shutdown(socket.SHUT_WR)
 
     def write_eof(self):
         if self._eof:
@@ -744,11 +936,47 @@ def write_eof(self):
     def can_write_eof(self):
         return True
 
+    def _force_close(self, exc):
+        if self._cork_handle is not None:
+            self._cork_handle.cancel()
+            self._cork_handle = None
+        if exc is None:
+            self._wakeup_empty_waiter(ConnectionError("Connection is closed"))
+        else:
+            self._wakeup_empty_waiter(exc)
+        super()._force_close(exc)
+        self._buffer_size = 0
+
+    def _make_empty_waiter(self):
+        # Return a future set when the write buffer is empty, used by
+        # loop.sendfile()
+        if self._empty_waiter is not None:
+            raise RuntimeError("Empty waiter is already set")
+        self._empty_waiter = futures.Future(loop=self._loop)
+        if not self._buffer:
+            self._empty_waiter.set_result(None)
+        return self._empty_waiter
+
+    def _reset_empty_waiter(self):
+        self._empty_waiter = None
+
+    def _wakeup_empty_waiter(self, exc=None):
+        waiter = self._empty_waiter
+        if waiter is None or waiter.done():
+            return
+        if exc is None:
+            waiter.set_result(None)
+        else:
+            waiter.set_exception(exc)
+
 
 class _SelectorSslTransport(_SelectorTransport):
 
     _buffer_factory = bytearray
 
+    # Future set when the write buffer is empty, see _make_empty_waiter()
+    _empty_waiter = None
+
     def __init__(self, loop, rawsock, protocol, sslcontext, waiter=None,
                  server_side=False, server_hostname=None,
                  extra=None, server=None):
@@ -869,6 +1097,7 @@ def pause_reading(self):
         if self._paused:
             raise RuntimeError('Already paused')
         self._paused = True
+        self._stats.reading_pauses += 1
         self._loop.remove_reader(self._sock_fd)
         if self._loop.get_debug():
             logger.debug("%r pauses reading", self)
@@ -877,6 +1106,7 @@ def resume_reading(self):
         if not self._paused:
             raise RuntimeError('Not paused')
         self._paused = False
+        self._stats.reading_resumes += 1
         if self._closing:
             return
         self._loop.add_reader(self._sock_fd, self._read_ready)
@@ -903,6 +1133,9 @@ def _read_ready(self):
             self._fatal_error(exc, 'Fatal read error on SSL transport')
         else:
             if data:
+                stats = self._stats
+                stats.reads += 1
+                stats.bytes_received += len(data)
                 self._protocol.data_received(data)
             else:
                 try:
@@ -939,12 +1172,16 @@ def _write_ready(self):
                 return
 
             if n:
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += n
                 del self._buffer[:n]
 
         self._maybe_resume_protocol()  # May append to buffer.
 
         if not self._buffer:
             self._loop.remove_writer(self._sock_fd)
+            self._wakeup_empty_waiter()
             if self._closing:
                 self._call_connection_lost(None)
 
@@ -971,8 +1208,39 @@ def write(self, data):
     def can_write_eof(self):
         return False
 
+    def _force_close(self, exc):
+        if exc is None:
+            self._wakeup_empty_waiter(ConnectionError("Connection is closed"))
+        else:
+            self._wakeup_empty_waiter(exc)
+        super()._force_close(exc)
+
+    # The empty waiter is used by the fallback of loop.sendfile(): the file
+    # is encrypted and written by chunks
+
+    def _make_empty_waiter(self):
+        if self._empty_waiter is not None:
+            raise RuntimeError("Empty waiter is already set")
+        self._empty_waiter = futures.Future(loop=self._loop)
+        if not self._buffer:
+            self._empty_waiter.set_result(None)
+        return self._empty_waiter
+
+    def _reset_empty_waiter(self):
+        self._empty_waiter = None
+
+    def _wakeup_empty_waiter(self, exc=None):
+        waiter = self._empty_waiter
+        if waiter is None or waiter.done():
+            return
+        if exc is None:
+            waiter.set_result(None)
+        else:
+            waiter.set_exception(exc)
 
-class _SelectorDatagramTransport(_SelectorTransport):
+
+class _SelectorDatagramTransport(transports._DatagramMixin,
+                                 _SelectorTransport):
 
     _buffer_factory = collections.deque
 
@@ -992,16 +1260,31 @@ def get_write_buffer_size(self):
         return sum(len(data) for data, _ in self._buffer)
 
     def _read_ready(self):
-        try:
-            data, addr = self._sock.recvfrom(self.max_size)
-        except (BlockingIOError, InterruptedError):
-            pass
-        except OSError as exc:
-            self._protocol.error_received(exc)
-        except Exception as exc:
-            self._fatal_error(exc, 'Fatal read error on datagram transport')
+        # Read datagrams until the socket would block, the batch is full or
+        # an error occurs, then deliver the datagrams before the error
+        datagrams = []
+        error = None
+        while len(datagrams) < self.max_batch_size:
+            try:
+                datagrams.append(self._sock.recvfrom(self.max_size))
+            except (BlockingIOError, InterruptedError):
+                break
+            except Exception as exc:
+                error = exc
+                break
+        if datagrams:
+            stats = self._stats
+            stats.reads += len(datagrams)
+            stats.bytes_received += sum(len(data) for data, addr in datagrams)
+            self._datagrams_received(datagrams)
+        if error is None or self._closing:
+            # no error, or the protocol closed the transport: don't report
+            # the error
+            return
+        if isinstance(error, OSError):
+            self._protocol.error_received(error)
         else:
-            self._protocol.datagram_received(data, addr)
+            self._fatal_error(error, 'Fatal read error on datagram transport')
 
     def sendto(self, data, addr=None):
         if not isinstance(data, (bytes, bytearray, memoryview)):
@@ -1027,6 +1310,9 @@ def sendto(self, data, addr=None):
                     self._sock.send(data)
                 else:
                     self._sock.sendto(data, addr)
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += len(data)
                 return
             except (BlockingIOError, InterruptedError):
                 self._loop.add_writer(self._sock_fd, self._sendto_ready)
@@ -1060,6 +1346,10 @@ def _sendto_ready(self):
                 self._fatal_error(exc,
                                   'Fatal write error on datagram transport')
                 return
+            else:
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += len(data)
 
         self._maybe_resume_protocol()  # May append to buffer.
         if not self._buffer:
@@ -392,14 +392,17 @@ def __init__(self):
         def fileno(self):
             return self._epoll.fileno()
 
-        def register(self, fileobj, events, data=None):
-            key = super().register(fileobj, events, data)
+        def _epoll_events(self, events):
             epoll_events = 0
             if events & EVENT_READ:
                 epoll_events |= select.EPOLLIN
             if events & EVENT_WRITE:
                 epoll_events |= select.EPOLLOUT
-            self._epoll.register(key.fd, epoll_events)
+            return epoll_events
+
+        def register(self, fileobj, events, data=None):
+            key = super().register(fileobj, events, data)
+            self._epoll.register(key.fd, self._epoll_events(events))
             return key
 
         def unregister(self, fileobj):
@@ -444,10 +447,102 @@ def select(self, timeout=None):
                     ready.append((key, events & key.events))
             return ready
 
+        def _modify_key(self, fileobj, events, data):
+            # Return (new key, True if the events changed)
+            try:
+                key = self._fd_to_key[self._fileobj_lookup(fileobj)]
+            except KeyError:
+                raise KeyError("{!r} is not registered"
+                               .format(fileobj)) from None
+            if events != key.events:
+                if (not events) or (events & ~(EVENT_READ | EVENT_WRITE)):
+                    raise ValueError("Invalid events: {!r}".format(events))
+                return SelectorKey(fileobj, key.fd, events, data), True
+            if data != key.data:
+                # Use a shortcut to update the data.
+                key = key._replace(data=data)
+                self._fd_to_key[key.fd] = key
+            return key, False
+
+        def modify(self, fileobj, events, data=None):
+            # A single epoll_ctl(EPOLL_CTL_MOD) call instead of
+            # unregister() + register()
+            key, changed = self._modify_key(fileobj, events, data)
+            if changed:
+                self._epoll.modify(key.fd, self._epoll_events(events))
+                self._fd_to_key[key.fd] = key
+            return key
+
         def close(self):
             self._epoll.close()
             super().close()
 
+    class BatchedEpollSelector(EpollSelector):
+        """Epoll-based selector applying the modifications in select().
+
+        modify() only records the new events of the file descriptor: the
+        last events of each file descriptor are passed to epoll_ctl() at
+        the next select() call, and not at all if they are the events
+        already registered in the kernel.  An event loop adding and
+        removing a writer between two iterations doesn't make any system
+        call.
+
+        register() and unregister() are applied immediately: errors are
+        raised to the caller, and a file descriptor can be closed as soon
+        as it is unregistered.
+        """
+
+        def __init__(self):
+            super().__init__()
+            # fd => epoll events registered in the kernel
+            self._epoll_registered = {}
+            # fd => epoll events to register at the next select() call
+            self._pending = {}
+
+        def register(self, fileobj, events, data=None):
+            key = super().register(fileobj, events, data)
+            self._epoll_registered[key.fd] = self._epoll_events(events)
+            return key
+
+        def unregister(self, fileobj):
+            key = super().unregister(fileobj)
+            del self._epoll_registered[key.fd]
+            self._pending.pop(key.fd, None)
+            return key
+
+        def modify(self, fileobj, events, data=None):
+            key, changed = self._modify_key(fileobj, events, data)
+            if changed:
+                self._fd_to_key[key.fd] = key
+                self._pending[key.fd] = self._epoll_events(events)
+            return key
+
+        def _apply_pending(self):
+            pending = self._pending
+            self._pending = {}
+            registered = self._epoll_registered
+            for fd, epoll_events in pending.items():
+                if registered[fd] == epoll_events:
+                    continue
+                try:
+                    self._epoll.modify(fd, epoll_events)
+                except OSError:
+                    # The FD was closed since it was registered: there is
+                    # no caller to report the error to, and select() will
+                    # not return it
+                    continue
+                registered[fd] = epoll_events
+
+        def select(self, timeout=None):
+            if self._pending:
+                self._apply_pending()
+            return super().select(timeout)
+
+        def close(self):
+            self._pending.clear()
+            self._epoll_registered.clear()
+            super().close()
+
 
 if hasattr(select, 'devpoll'):
 
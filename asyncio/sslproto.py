@@ -60,11 +60,17 @@ class _SSLPipe(object):
 
     An SslPipe initially is in "unwrapped" mode. To start SSL, call
     do_handshake(). To shutdown SSL again, call unwrap().
+
+    In buffered mode, plaintext data is decrypted into a preallocated buffer
+    and consecutive records are returned as a single buffer. Record level
+    data is kept in the outgoing buffer instead of being returned by each
+    call: call flush_ssldata() to get it as a single buffer.
     """
 
     max_size = 256 * 1024   # Buffer size passed to read()
 
-    def __init__(self, context, server_side, server_hostname=None):
+    def __init__(self, context, server_side, server_hostname=None, *,
+                 buffered=False):
         """
         The *context* argument specifies the ssl.SSLContext to use.
 
@@ -74,6 +80,8 @@ def __init__(self, context, server_side, server_hostname=None):
         The optional *server_hostname* argument can be used to specify the
         hostname you are connecting to. You may only specify this parameter if
         the _ssl module supports Server Name Indication (SNI).
+
+        If *buffered* is true, the pipe works in buffered mode.
         """
         self._context = context
         self._server_side = server_side
@@ -85,6 +93,11 @@ def __init__(self, context, server_side, server_hostname=None):
         self._need_ssldata = False
         self._handshake_cb = None
         self._shutdown_cb = None
+        self._buffered = buffered
+        if buffered:
+            self._read_view = memoryview(bytearray(self.max_size))
+        else:
+            self._read_view = None
 
     @property
     def context(self):
@@ -105,6 +118,11 @@ def need_ssldata(self):
         that is currently in progress."""
         return self._need_ssldata
 
+    @property
+    def buffered(self):
+        """Whether the pipe works in buffered mode."""
+        return self._buffered
+
     @property
     def wrapped(self):
         """
@@ -207,11 +225,14 @@ def feed_ssldata(self, data, only_handshake=False):
 
             if self._state == _WRAPPED:
                 # Main state: read data from SSL until close_notify
-                while True:
-                    chunk = self._sslobj.read(self.max_size)
-                    appdata.append(chunk)
-                    if not chunk:  # close_notify
-                        break
+                if self._buffered:
+                    self._read_into_buffer(appdata)
+                else:
+                    while True:
+                        chunk = self._sslobj.read(self.max_size)
+                        appdata.append(chunk)
+                        if not chunk:  # close_notify
+                            break
 
             elif self._state == _SHUTDOWN:
                 # Call shutdown() until it doesn't raise anymore.
@@ -235,10 +256,32 @@ def feed_ssldata(self, data, only_handshake=False):
 
         # Check for record level data that needs to be sent back.
         # Happens for the initial handshake and renegotiations.
-        if self._outgoing.pending:
+        if self._outgoing.pending and not self._buffered:
             ssldata.append(self._outgoing.read())
         return (ssldata, appdata)
 
+    def _read_into_buffer(self, appdata):
+        # Decrypt all available records into the preallocated buffer, a new
+        # chunk is only started when the buffer is full
+        view = self._read_view
+        size = len(view)
+        nbytes = 0
+        try:
+            while True:
+                if nbytes == size:
+                    appdata.append(bytes(view))
+                    nbytes = 0
+                count = self._sslobj.read(size - nbytes, view[nbytes:])
+                if not count:  # close_notify
+                    break
+                nbytes += count
+        finally:
+            # Deliver the decrypted data before the SSL_ERROR_WANT_READ
+            # exception is handled
+            if nbytes:
+                appdata.append(bytes(view[:nbytes]))
+        appdata.append(b'')
+
     def feed_appdata(self, data, offset=0):
         """Feed plaintext data into the pipe.
 
@@ -283,12 +326,23 @@ def feed_appdata(self, data, offset=0):
                 self._need_ssldata = (exc.errno == ssl.SSL_ERROR_WANT_READ)
 
             # See if there's any record level data back for us.
-            if self._outgoing.pending:
+            if self._outgoing.pending and not self._buffered:
                 ssldata.append(self._outgoing.read())
             if offset == len(view) or self._need_ssldata:
                 break
         return (ssldata, offset)
 
+    def flush_ssldata(self):
+        """Return the record level data waiting to be sent.
+
+        Return a list of buffers which is empty, or contains all the data
+        produced since the last call. Only the buffered mode keeps data
+        waiting.
+        """
+        if self._outgoing.pending:
+            return [self._outgoing.read()]
+        return []
+
 
 class _SSLProtocolTransport(transports._FlowControlMixin,
                             transports.Transport):
@@ -303,6 +357,9 @@ def get_extra_info(self, name, default=None):
         """Get optional transport information."""
         return self._ssl_protocol._get_extra_info(name, default)
 
+    def is_closing(self):
+        return self._closed
+
     def close(self):
         """Close the transport.
 
@@ -364,6 +421,14 @@ def get_write_buffer_size(self):
         """Return the current size of the write buffer."""
         return self._ssl_protocol._transport.get_write_buffer_size()
 
+    def _make_empty_waiter(self):
+        # loop.sendfile() writes the chunks of the file to this transport
+        # once the records are flushed by the underlying transport
+        return self._ssl_protocol._transport._make_empty_waiter()
+
+    def _reset_empty_waiter(self):
+        self._ssl_protocol._transport._reset_empty_waiter()
+
     def write(self, data):
         """Write some data bytes to the transport.
 
@@ -396,10 +461,15 @@ class SSLProtocol(protocols.Protocol):
 
     Implementation of SSL on top of a socket using incoming and outgoing
     buffers which are ssl.MemoryBIO objects.
+
+    If buffered is true, use the buffered mode of _SSLPipe: decrypted data
+    is delivered to the application in a single data_received() call, and
+    the SSL records produced by a call to data_received() or
+    _process_write_backlog() are sent with a single transport write.
     """
 
     def __init__(self, loop, app_protocol, sslcontext, waiter,
-                 server_side=False, server_hostname=None):
+                 server_side=False, server_hostname=None, *, buffered=False):
         if ssl is None:
             raise RuntimeError('stdlib ssl module not available')
 
@@ -412,6 +482,7 @@ def __init__(self, loop, app_protocol, sslcontext, waiter,
         else:
             self._server_hostname = None
         self._sslcontext = sslcontext
+        self.buffered = buffered
         # SSL-specific extra info. More info are set when the handshake
         # completes.
         self._extra = dict(sslcontext=sslcontext)
@@ -449,7 +520,8 @@ def connection_made(self, transport):
         self._transport = transport
         self._sslpipe = _SSLPipe(self._sslcontext,
                                  self._server_side,
-                                 self._server_hostname)
+                                 self._server_hostname,
+                                 buffered=self.buffered)
         self._start_handshake()
 
     def connection_lost(self, exc):
@@ -493,6 +565,8 @@ def data_received(self, data):
 
         for chunk in ssldata:
             self._transport.write(chunk)
+        if self.buffered:
+            self._flush_ssldata()
 
         for chunk in appdata:
             if chunk:
@@ -602,6 +676,13 @@ def _on_handshake_complete(self, handshake_exc):
         # reentrant.
         self._loop.call_soon(self._process_write_backlog)
 
+    def _flush_ssldata(self):
+        # The transport is None if a callback called connection_lost()
+        if self._transport is None:
+            return
+        for chunk in self._sslpipe.flush_ssldata():
+            self._transport.write(chunk)
+
     def _process_write_backlog(self):
         # Try to make progress on the write backlog.
         if self._transport is None:
@@ -636,6 +717,10 @@ def _process_write_backlog(self):
                 # delete it and reduce the outstanding buffer size.
                 del self._write_backlog[0]
                 self._write_buffer_size -= len(data)
+
+            if self.buffered:
+                # Send the records of all processed chunks at once
+                self._flush_ssldata()
         except BaseException as exc:
             if self._in_handshake:
                 # BaseExceptions will be re-raised in _on_handshake_complete.
@@ -2,9 +2,10 @@
 
 __all__ = ['StreamReader', 'StreamWriter', 'StreamReaderProtocol',
            'open_connection', 'start_server',
-           'IncompleteReadError',
+           'IncompleteReadError', 'LimitOverrunError',
            ]
 
+import collections
 import socket
 
 if hasattr(socket, 'AF_UNIX'):
@@ -36,6 +37,141 @@ def __init__(self, partial, expected):
         self.expected = expected
 
 
+class LimitOverrunError(Exception):
+    """Reached the buffer limit while looking for a separator.
+
+    Attributes:
+
+    - consumed: total number of to be consumed bytes.
+    """
+    def __init__(self, message, consumed):
+        super().__init__(message)
+        self.consumed = consumed
+
+
+class _ChunkedBuffer:
+    """Buffer of a StreamReader: a queue of bytes chunks.
+
+    Data is appended without copying it into a contiguous buffer, and
+    consuming the head of the buffer doesn't move the rest of the data, so
+    reading a large frame received in small pieces costs O(n).
+    """
+
+    def __init__(self):
+        self._chunks = collections.deque()
+        self._offset = 0    # Number of consumed bytes of the first chunk
+        self._size = 0
+
+    def __len__(self):
+        return self._size
+
+    def __bytes__(self):
+        return self._join(self._size, consume=False)
+
+    def __eq__(self, other):
+        # Mostly used by tests
+        try:
+            return bytes(self) == bytes(memoryview(other))
+        except TypeError:
+            return NotImplemented
+
+    def __repr__(self):
+        return '<%s %r>' % (self.__class__.__name__, bytes(self))
+
+    def append(self, data):
+        if type(data) is not bytes:
+            # The producer may reuse its buffer
+            data = bytes(data)
+        self._chunks.append(data)
+        self._size += len(data)
+
+    def clear(self):
+        self._chunks.clear()
+        self._offset = 0
+        self._size = 0
+
+    def find(self, sep, start=0):
+        """Return the lowest index of sep found at start or later, or -1.
+
+        Only the chunks of the buffer from start are scanned, so a caller
+        resuming its search after receiving more data doesn't scan the
+        beginning of the buffer again.
+        """
+        pos = self._size
+        chunks = []
+        for chunk in reversed(self._chunks):
+            if pos <= start:
+                break
+            pos -= len(chunk)
+            chunks.append(chunk)
+        if not chunks:
+            return -1
+        # pos is the index of the first scanned chunk: it is negative if
+        # it is the first chunk of the buffer, partially consumed
+        if len(chunks) == 1:
+            data = chunks[0]
+        else:
+            chunks.reverse()
+            data = b''.join(chunks)
+        index = data.find(sep, start - pos)
+        if index < 0:
+            return -1
+        return pos + index
+
+    def take(self, n):
+        """Remove and return up to n bytes from the head of the buffer."""
+        return self._join(min(n, self._size), consume=True)
+
+    def _join(self, n, consume):
+        chunks = []
+        offset = self._offset
+        remaining = n
+        for chunk in self._chunks:
+            if not remaining:
+                break
+            size = min(len(chunk) - offset, remaining)
+            if offset or size < len(chunk):
+                chunk = chunk[offset:offset + size]
+            chunks.append(chunk)
+            remaining -= size
+            offset = 0
+        if consume:
+            self._consume(n)
+        if len(chunks) == 1:
+            return chunks[0]
+        return b''.join(chunks)
+
+    def _consume(self, n):
+        self._size -= n
+        chunks = self._chunks
+        offset = self._offset + n
+        while chunks and offset >= len(chunks[0]):
+            offset -= len(chunks.popleft())
+        self._offset = offset
+
+    def readinto(self, buffer):
+        """Move data from the head of the buffer into a writable buffer.
+
+        Return the number of bytes copied.
+        """
+        view = memoryview(buffer).cast('B')
+        try:
+            nbytes = 0
+            offset = self._offset
+            for chunk in self._chunks:
+                if nbytes == len(view):
+                    break
+                size = min(len(chunk) - offset, len(view) - nbytes)
+                with memoryview(chunk) as data:
+                    view[nbytes:nbytes + size] = data[offset:offset + size]
+                nbytes += size
+                offset = 0
+        finally:
+            view.release()
+        self._consume(nbytes)
+        return nbytes
+
+
 @coroutine
 def open_connection(host=None, port=None, *,
                     loop=None, limit=_DEFAULT_LIMIT, **kwds):
@@ -52,6 +188,10 @@ def open_connection(host=None, port=None, *,
     instance to use) and limit (to set the buffer limit passed to the
     StreamReader).
 
+    If a ConnectionPool is passed as pool, an idle connection may be
+    reused: put it back with pool.release(writer.transport) once the
+    response has been read.
+
     (If you want to customize the StreamReader and/or
     StreamReaderProtocol classes, just copy the code -- there's
     really nothing special here except some convenience.)
@@ -60,8 +200,29 @@ def open_connection(host=None, port=None, *,
         loop = events.get_event_loop()
     reader = StreamReader(limit=limit, loop=loop)
     protocol = StreamReaderProtocol(reader, loop=loop)
-    transport, _ = yield from loop.create_connection(
-        lambda: protocol, host, port, **kwds)
+    # Idle connections of the pool created by loop.create_connection() with
+    # another protocol: put them back once a connection was found
+    skipped = []
+    try:
+        while True:
+            transport, conn_protocol = yield from loop.create_connection(
+                lambda: protocol, host, port, **kwds)
+            if conn_protocol is protocol:
+                break
+            if not isinstance(conn_protocol, StreamReaderProtocol):
+                skipped.append(transport)
+                continue
+            # Idle connection of a pool: only reuse it if nothing was
+            # received since it was released
+            conn_reader = conn_protocol._stream_reader
+            if (not conn_reader._eof and not conn_reader._buffer
+            and conn_reader._exception is None):
+                reader, protocol = conn_reader, conn_protocol
+                break
+            transport.close()
+    finally:
+        for skipped_transport in skipped:
+            kwds['pool'].release(skipped_transport)
     writer = StreamWriter(transport, protocol, reader, loop)
     return reader, writer
 
@@ -314,7 +475,7 @@ def __init__(self, limit=_DEFAULT_LIMIT, loop=None):
             self._loop = events.get_event_loop()
         else:
             self._loop = loop
-        self._buffer = bytearray()
+        self._buffer = _ChunkedBuffer()
         self._eof = False    # Whether we're done.
         self._waiter = None  # A future used by _wait_for_data()
         self._exception = None
@@ -324,7 +485,7 @@ def __init__(self, limit=_DEFAULT_LIMIT, loop=None):
     def __repr__(self):
         info = ['StreamReader']
         if self._buffer:
-            info.append('%d bytes' % len(info))
+            info.append('%d bytes' % len(self._buffer))
         if self._eof:
             info.append('eof')
         if self._limit != _DEFAULT_LIMIT:
@@ -382,7 +543,7 @@ def feed_data(self, data):
         if not data:
             return
 
-        self._buffer.extend(data)
+        self._buffer.append(data)
         self._wakeup_waiter()
 
         if (self._transport is not None and
@@ -417,36 +578,75 @@ def _wait_for_data(self, func_name):
 
     @coroutine
     def readline(self):
+        """Read a line: data up to and including b'\\n'.
+
+        At the end of the stream, return the remaining data, which doesn't
+        end with b'\\n'.  If the line is longer than the limit, it is
+        consumed and ValueError is raised.
+        """
+        sep = b'\n'
+        try:
+            line = yield from self.readuntil(sep)
+        except IncompleteReadError as exc:
+            return exc.partial
+        except LimitOverrunError as exc:
+            if self._buffer.find(sep, exc.consumed) == exc.consumed:
+                self._buffer.take(exc.consumed + len(sep))
+            else:
+                self._buffer.clear()
+            self._maybe_resume_transport()
+            raise ValueError(exc.args[0])
+        return line
+
+    @coroutine
+    def readuntil(self, separator=b'\n'):
+        """Read data up to and including separator.
+
+        Raise IncompleteReadError if the end of the stream is reached before
+        the separator: the buffer is cleared and the partial attribute of
+        the exception contains the remaining data.
+
+        Raise LimitOverrunError if the separator is not found in the limit:
+        the data is left in the buffer.
+
+        The position where the search stopped is remembered while waiting
+        for data: each byte is only scanned once.
+        """
+        seplen = len(separator)
+        if seplen == 0:
+            raise ValueError('Separator should be at least one-byte string')
+
         if self._exception is not None:
             raise self._exception
 
-        line = bytearray()
-        not_enough = True
-
-        while not_enough:
-            while self._buffer and not_enough:
-                ichar = self._buffer.find(b'\n')
-                if ichar < 0:
-                    line.extend(self._buffer)
-                    self._buffer.clear()
-                else:
-                    ichar += 1
-                    line.extend(self._buffer[:ichar])
-                    del self._buffer[:ichar]
-                    not_enough = False
-
-                if len(line) > self._limit:
-                    self._maybe_resume_transport()
-                    raise ValueError('Line is too long')
+        offset = 0
+        while True:
+            buflen = len(self._buffer)
+            if buflen - offset >= seplen:
+                isep = self._buffer.find(separator, offset)
+                if isep != -1:
+                    break
+                # The separator can start in the last seplen-1 bytes
+                offset = buflen + 1 - seplen
+                if offset > self._limit:
+                    raise LimitOverrunError(
+                        'Separator is not found, and chunk exceed the limit',
+                        offset)
 
             if self._eof:
-                break
+                chunk = bytes(self._buffer)
+                self._buffer.clear()
+                raise IncompleteReadError(chunk, None)
 
-            if not_enough:
-                yield from self._wait_for_data('readline')
+            yield from self._wait_for_data('readuntil')
 
+        if isep > self._limit:
+            raise LimitOverrunError(
+                'Separator is found, but chunk is longer than limit', isep)
+
+        chunk = self._buffer.take(isep + seplen)
         self._maybe_resume_transport()
-        return bytes(line)
+        return chunk
 
     @coroutine
     def read(self, n=-1):
@@ -472,17 +672,32 @@ def read(self, n=-1):
             if not self._buffer and not self._eof:
                 yield from self._wait_for_data('read')
 
-        if n < 0 or len(self._buffer) <= n:
-            data = bytes(self._buffer)
-            self._buffer.clear()
-        else:
-            # n > 0 and len(self._buffer) > n
-            data = bytes(self._buffer[:n])
-            del self._buffer[:n]
-
+        data = self._buffer.take(n)
         self._maybe_resume_transport()
         return data
 
+    @coroutine
+    def readinto(self, buffer):
+        """Read up to len(buffer) bytes into a writable buffer.
+
+        Wait until data is available or the end of the stream is reached,
+        return the number of bytes read: 0 at the end of the stream.
+        """
+        if self._exception is not None:
+            raise self._exception
+
+        with memoryview(buffer) as view:
+            size = view.nbytes
+        if not size:
+            return 0
+
+        if not self._buffer and not self._eof:
+            yield from self._wait_for_data('readinto')
+
+        nbytes = self._buffer.readinto(buffer)
+        self._maybe_resume_transport()
+        return nbytes
+
     @coroutine
     def readexactly(self, n):
         if self._exception is not None:
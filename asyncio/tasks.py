@@ -3,7 +3,7 @@
 __all__ = ['Task',
            'FIRST_COMPLETED', 'FIRST_EXCEPTION', 'ALL_COMPLETED',
            'wait', 'wait_for', 'as_completed', 'sleep', 'async',
-           'gather', 'shield', 'ensure_future',
+           'gather', 'shield', 'ensure_future', 'eager_task_factory',
            ]
 
 import concurrent.futures
@@ -44,6 +44,10 @@ class Task(futures.Future):
     # status is still pending
     _log_destroy_pending = True
 
+    # Bound _wakeup() method, created at the first suspension and reused
+    # by the next ones; cleared when the task is done to break the cycle
+    _wakeup_cb = None
+
     @classmethod
     def current_task(cls, loop=None):
         """Return the currently running task in an event loop or None.
@@ -66,7 +70,7 @@ def all_tasks(cls, loop=None):
             loop = events.get_event_loop()
         return {t for t in cls._all_tasks if t._loop is loop}
 
-    def __init__(self, coro, *, loop=None):
+    def __init__(self, coro, *, loop=None, eager_start=False):
         assert coroutines.iscoroutine(coro), repr(coro)
         super().__init__(loop=loop)
         if self._source_traceback:
@@ -74,8 +78,22 @@ def __init__(self, coro, *, loop=None):
         self._coro = coro
         self._fut_waiter = None
         self._must_cancel = False
-        self._loop.call_soon(self._step)
         self.__class__._all_tasks.add(self)
+        if eager_start and self._loop.is_running():
+            self._eager_start()
+        else:
+            self._loop.call_soon(self._step)
+
+    def _eager_start(self):
+        # Run the first step now, in the context of the caller: a coroutine
+        # which doesn't suspend is done when the constructor returns
+        current_tasks = self.__class__._current_tasks
+        outer_task = current_tasks.get(self._loop)
+        try:
+            self._step()
+        finally:
+            if outer_task is not None:
+                current_tasks[self._loop] = outer_task
 
     # On Python 3.3 or older, objects with a destructor that are part of a
     # reference cycle are never destroyed. That's not the case any more on
@@ -238,12 +256,16 @@ def _step(self, value=None, exc=None):
             else:
                 result = coro.send(value)
         except StopIteration as exc:
+            self._wakeup_cb = None
             self.set_result(exc.value)
         except futures.CancelledError as exc:
+            self._wakeup_cb = None
             super().cancel()  # I.e., Future.cancel(self).
         except Exception as exc:
+            self._wakeup_cb = None
             self.set_exception(exc)
         except BaseException as exc:
+            self._wakeup_cb = None
             self.set_exception(exc)
             raise
         else:
@@ -251,7 +273,10 @@ def _step(self, value=None, exc=None):
                 # Yielded Future must come from Future.__iter__().
                 if result._blocking:
                     result._blocking = False
-                    result.add_done_callback(self._wakeup)
+                    wakeup = self._wakeup_cb
+                    if wakeup is None:
+                        wakeup = self._wakeup_cb = self._wakeup
+                    result.add_done_callback(wakeup)
                     self._fut_waiter = result
                     if self._must_cancel:
                         if self._fut_waiter.cancel():
@@ -511,6 +536,17 @@ def async(coro_or_future, *, loop=None):
     return ensure_future(coro_or_future, loop=loop)
 
 
+def eager_task_factory(loop, coro, *, eager_start=True):
+    """Task factory running the first step of the tasks immediately.
+
+    Pass it to loop.set_task_factory(): a coroutine which completes
+    without suspending is done when create_task() returns, without
+    waiting for an iteration of the event loop.  Tasks are only started
+    eagerly if the loop is running.
+    """
+    return Task(coro, loop=loop, eager_start=eager_start)
+
+
 def ensure_future(coro_or_future, *, loop=None):
     """Wrap a coroutine in a future.
 
@@ -45,6 +45,31 @@ def dummy_ssl_context():
         return ssl.SSLContext(ssl.PROTOCOL_SSLv23)
 
 
+def _test_data_file(filename):
+    # The relative location of our test directory (which
+    # contains the ssl key and certificate files) differs
+    # between the stdlib and stand-alone asyncio.
+    # Prefer our own if we can find it.
+    here = os.path.join(os.path.dirname(__file__), '..', 'tests')
+    if not os.path.isdir(here):
+        here = os.path.join(os.path.dirname(os.__file__),
+                            'test', 'test_asyncio')
+    return os.path.join(here, filename)
+
+
+def server_ssl_context():
+    """Return a server SSL context using the keycert3.pem certificate."""
+    sslcontext = ssl.SSLContext(ssl.PROTOCOL_SSLv23)
+    try:
+        # the key of the test certificate is too small for the default
+        # security level of recent OpenSSL versions
+        sslcontext.set_ciphers('DEFAULT@SECLEVEL=0')
+    except ssl.SSLError:
+        pass
+    sslcontext.load_cert_chain(_test_data_file('keycert3.pem'))
+    return sslcontext
+
+
 def run_briefly(loop):
     @coroutine
     def once():
@@ -105,16 +130,8 @@ def handle_error(self, request, client_address):
 class SSLWSGIServerMixin:
 
     def finish_request(self, request, client_address):
-        # The relative location of our test directory (which
-        # contains the ssl key and certificate files) differs
-        # between the stdlib and stand-alone asyncio.
-        # Prefer our own if we can find it.
-        here = os.path.join(os.path.dirname(__file__), '..', 'tests')
-        if not os.path.isdir(here):
-            here = os.path.join(os.path.dirname(os.__file__),
-                                'test', 'test_asyncio')
-        keyfile = os.path.join(here, 'ssl_key.pem')
-        certfile = os.path.join(here, 'ssl_cert.pem')
+        keyfile = _test_data_file('ssl_key.pem')
+        certfile = _test_data_file('ssl_cert.pem')
         ssock = ssl.wrap_socket(request,
                                 keyfile=keyfile,
                                 certfile=certfile,
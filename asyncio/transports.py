@@ -7,18 +7,99 @@
            ]
 
 
+class _TransportStats:
+    """I/O counters of a transport, see get_extra_info('stats').
+
+    The counters are always enabled: updating them only costs a few
+    attribute increments per read or write.
+    """
+
+    __slots__ = ('_loop', 'bytes_received', 'bytes_sent', 'reads', 'writes',
+                 'reading_pauses', 'reading_resumes', 'writing_pauses',
+                 'writing_resumes', 'writing_paused_time', '_paused_since')
+
+    def __init__(self, loop):
+        self._loop = loop
+        self.bytes_received = 0
+        self.bytes_sent = 0
+        self.reads = 0
+        self.writes = 0
+        self.reading_pauses = 0
+        self.reading_resumes = 0
+        self.writing_pauses = 0
+        self.writing_resumes = 0
+        self.writing_paused_time = 0.0
+        # loop time when the protocol was paused, None if it is not paused
+        self._paused_since = None
+
+    def writing_paused(self):
+        self.writing_pauses += 1
+        self._paused_since = self._loop.time()
+
+    def writing_resumed(self):
+        self.writing_resumes += 1
+        if self._paused_since is not None:
+            self.writing_paused_time += self._loop.time() - self._paused_since
+            self._paused_since = None
+
+    def as_dict(self):
+        paused_time = self.writing_paused_time
+        if self._paused_since is not None:
+            paused_time += self._loop.time() - self._paused_since
+        return {
+            'bytes_received': self.bytes_received,
+            'bytes_sent': self.bytes_sent,
+            'reads': self.reads,
+            'writes': self.writes,
+            'reading_pauses': self.reading_pauses,
+            'reading_resumes': self.reading_resumes,
+            'writing_pauses': self.writing_pauses,
+            'writing_resumes': self.writing_resumes,
+            'writing_paused': self._paused_since is not None,
+            'writing_paused_time': paused_time,
+        }
+
+
 class BaseTransport:
     """Base class for transports."""
 
+    # _TransportStats of the transport, if it counts its I/O
+    _stats = None
+
     def __init__(self, extra=None):
         if extra is None:
             extra = {}
         self._extra = extra
 
     def get_extra_info(self, name, default=None):
-        """Get optional transport information."""
+        """Get optional transport information.
+
+        'stats' returns a new dict of the I/O counters of the transport,
+        if it supports them:
+
+        - bytes_received, bytes_sent: number of bytes read and written
+        - reads, writes: number of read and write system calls (selector
+          event loop) or of completed read and submitted write operations
+          (proactor event loop) which transferred data
+        - reading_pauses, reading_resumes: number of calls to
+          pause_reading() and resume_reading()
+        - writing_pauses, writing_resumes: number of calls to the
+          pause_writing() and resume_writing() methods of the protocol
+        - writing_paused: True if the protocol is paused
+        - writing_paused_time: time spent with the protocol paused, in
+          seconds
+
+        For SSL transports, the counters are those of the underlying
+        socket and bytes are counted encrypted.
+        """
+        if name == 'stats' and self._stats is not None:
+            return self._stats.as_dict()
         return self._extra.get(name, default)
 
+    def is_closing(self):
+        """Return True if the transport is closing or closed."""
+        raise NotImplementedError
+
     def close(self):
         """Close the transport.
 
@@ -95,6 +176,25 @@ def writelines(self, list_of_data):
         data = compat.flatten_list_bytes(list_of_data)
         self.write(data)
 
+    def set_corked(self, corked):
+        """Enable or disable the corked mode.
+
+        In corked mode, write() and writelines() only buffer the data: the
+        data written during an iteration of the event loop is sent at once,
+        with a single vectored send when possible, by a callback scheduled
+        by the first write.  Disabling the corked mode flushes the buffer.
+        """
+        raise NotImplementedError
+
+    def flush(self):
+        """Start sending the data buffered in corked mode now.
+
+        Latency-sensitive callers can use it instead of waiting for the
+        end of the event loop iteration.  The data which cannot be sent
+        immediately stays in the write buffer, as with write().
+        """
+        raise NotImplementedError
+
     def write_eof(self):
         """Close the write end after flushing buffered data.
 
@@ -237,6 +337,7 @@ def __init__(self, extra=None, loop=None):
         assert loop is not None
         self._loop = loop
         self._protocol_paused = False
+        self._stats = _TransportStats(loop)
         self._set_write_buffer_limits()
 
     def _maybe_pause_protocol(self):
@@ -245,6 +346,7 @@ def _maybe_pause_protocol(self):
             return
         if not self._protocol_paused:
             self._protocol_paused = True
+            self._stats.writing_paused()
             try:
                 self._protocol.pause_writing()
             except Exception as exc:
@@ -259,6 +361,7 @@ def _maybe_resume_protocol(self):
         if (self._protocol_paused and
             self.get_write_buffer_size() <= self._low_water):
             self._protocol_paused = False
+            self._stats.writing_resumed()
             try:
                 self._protocol.resume_writing()
             except Exception as exc:
@@ -292,3 +395,114 @@ def set_write_buffer_limits(self, high=None, low=None):
 
     def get_write_buffer_size(self):
         raise NotImplementedError
+
+
+class _ReadSizeMixin:
+    """All the logic for adaptive read sizes in a mix-in class.
+
+    Reads start with min_size bytes.  The read size is doubled each time
+    a read fills the buffer, and halved when a read uses less than a
+    quarter of it, without leaving the [min_size, max_size] range.  Bulk
+    transfers quickly get large reads, while idle connections keep small
+    buffers.
+
+    The subclass constructor must call _set_read_size_limits().  The
+    subclass must read at most _read_size bytes at once and call
+    _update_read_size() with the number of bytes read.
+    """
+
+    min_size = 4 * 1024
+    max_size = 256 * 1024
+
+    def _set_read_size_limits(self, min_size=None, max_size=None):
+        if max_size is None:
+            if min_size is None:
+                max_size = self.max_size
+            else:
+                max_size = max(min_size, self.max_size)
+        if min_size is None:
+            min_size = min(self.min_size, max_size)
+        if min_size <= 0:
+            raise ValueError('min_size must be > 0, got %r' % min_size)
+        if max_size < min_size:
+            raise ValueError('max_size (%r) must be >= min_size (%r)'
+                             % (max_size, min_size))
+        self._min_read_size = min_size
+        self._max_read_size = max_size
+        self._read_size = min_size
+
+    def _update_read_size(self, nbytes):
+        if nbytes >= self._read_size:
+            self._read_size = min(self._read_size * 2, self._max_read_size)
+        elif nbytes < self._read_size // 4:
+            self._read_size = max(self._read_size // 2, self._min_read_size)
+
+
+class _DatagramMixin:
+    """Delivery of received datagrams by batches in a mix-in class.
+
+    The subclass reads up to max_batch_size datagrams when the socket is
+    readable and passes the list of (data, addr) pairs to
+    _datagrams_received(), which calls the datagrams_received() method of
+    the protocol.  Protocols which don't inherit from DatagramProtocol may
+    only implement datagram_received(): it is then called for each
+    datagram, until the protocol closes the transport.
+    """
+
+    max_batch_size = 64
+
+    def _datagrams_received(self, datagrams):
+        protocol = self._protocol
+        try:
+            datagrams_received = protocol.datagrams_received
+        except AttributeError:
+            for data, addr in datagrams:
+                protocol.datagram_received(data, addr)
+                if self._closing:
+                    break
+        else:
+            datagrams_received(datagrams)
+
+
+class _WriteQueueMixin:
+    """Write buffer stored as a queue of memoryviews in a mix-in class.
+
+    bytes objects are queued without copying them.  Other bytes-like
+    objects are copied once, since the caller may modify them after
+    write() returns.  Sent data is consumed by slicing the memoryview at
+    the head of the queue: the remaining data is never moved.
+
+    The subclass constructor must set _buffer to an empty deque.
+    """
+
+    _buffer_size = 0
+
+    def get_write_buffer_size(self):
+        return self._buffer_size
+
+    def _buffer_append(self, data):
+        if not isinstance(data, memoryview):
+            if not isinstance(data, bytes):
+                data = bytes(data)
+            data = memoryview(data)
+        elif not (isinstance(data.obj, bytes) and data.format == 'B'
+                  and data.c_contiguous):
+            data = memoryview(bytes(data))
+        self._buffer.append(data)
+        self._buffer_size += len(data)
+
+    def _buffer_consume(self, nbytes):
+        # Remove the first nbytes bytes of the queue
+        self._buffer_size -= nbytes
+        buffer = self._buffer
+        while nbytes:
+            head = buffer[0]
+            if nbytes < len(head):
+                buffer[0] = head[nbytes:]
+                break
+            nbytes -= len(head)
+            buffer.popleft()
+
+    def _buffer_clear(self):
+        self._buffer.clear()
+        self._buffer_size = 0
@@ -1,7 +1,11 @@
 """Selector event loop for Unix with signal handling."""
 
+import collections
 import errno
+import io
+import itertools
 import os
+import platform
 import signal
 import socket
 import stat
@@ -27,7 +31,8 @@
 
 __all__ = ['SelectorEventLoop',
            'AbstractChildWatcher', 'SafeChildWatcher',
-           'FastChildWatcher', 'DefaultEventLoopPolicy',
+           'FastChildWatcher', 'PidfdChildWatcher',
+           'DefaultEventLoopPolicy',
            ]
 
 if sys.platform == 'win32':  # pragma: no cover
@@ -39,6 +44,60 @@ def _sighandler_noop(signum, frame):
     pass
 
 
+# Read buffer of the pipe transports, one per thread
+_read_buffers = threading.local()
+
+
+def _get_read_buffer(size):
+    # Return (buffers, view): reading into a buffer shared by the pipe
+    # transports of the thread and copying the data is much faster than
+    # allocating a bytes object of size bytes for each os.read() call
+    try:
+        buffers, view = _read_buffers.buffer
+    except AttributeError:
+        pass
+    else:
+        if len(view) == size:
+            return buffers, view
+    buf = bytearray(size)
+    _read_buffers.buffer = buffers, view = [buf], memoryview(buf)
+    return buffers, view
+
+
+def _pidfd_open_syscall(machine):
+    # Return the number of the pidfd_open syscall on Linux, or None if the
+    # architecture is unknown
+    if machine == 'alpha':
+        return 544
+    if machine == 'ia64':
+        return 1458
+    # Architectures using the unified syscall table
+    if (machine in ('x86_64', 'aarch64', 's390x')
+    or machine.startswith(('i386', 'i486', 'i586', 'i686', 'arm', 'ppc',
+                           'mips', 'riscv', 'sparc', 'loongarch'))):
+        return 434
+    return None
+
+
+if hasattr(os, 'pidfd_open'):
+    _pidfd_open = os.pidfd_open
+elif (sys.platform.startswith('linux')
+and _pidfd_open_syscall(platform.machine()) is not None):
+    _PIDFD_OPEN_SYSCALL = _pidfd_open_syscall(platform.machine())
+
+    def _pidfd_open(pid):
+        # os.pidfd_open() is new in Python 3.9: call the syscall
+        import ctypes
+        libc = ctypes.CDLL(None, use_errno=True)
+        fd = libc.syscall(_PIDFD_OPEN_SYSCALL, pid, 0)
+        if fd < 0:
+            err = ctypes.get_errno()
+            raise OSError(err, os.strerror(err))
+        return fd
+else:
+    _pidfd_open = None
+
+
 class _UnixSelectorEventLoop(selector_events.BaseSelectorEventLoop):
     """Unix event loop.
 
@@ -282,6 +341,65 @@ def create_unix_server(self, protocol_factory, path=None, *,
         self._start_serving(protocol_factory, sock, ssl, server)
         return server
 
+    @coroutine
+    def _sock_sendfile_native(self, sock, file, offset, count):
+        try:
+            os.sendfile
+        except AttributeError:
+            raise events.SendfileNotAvailableError(
+                "os.sendfile() is not available")
+        try:
+            fileno = file.fileno()
+        except (AttributeError, io.UnsupportedOperation):
+            raise events.SendfileNotAvailableError("not a regular file")
+        try:
+            fsize = os.fstat(fileno).st_size
+        except OSError:
+            raise events.SendfileNotAvailableError("not a regular file")
+        blocksize = count if count else fsize
+        if not blocksize:
+            # empty file
+            return 0
+
+        fd = sock.fileno()
+        total_sent = 0
+        try:
+            while True:
+                if count:
+                    blocksize = min(count - total_sent, blocksize)
+                    if blocksize <= 0:
+                        break
+                try:
+                    sent = os.sendfile(fd, fileno, offset, blocksize)
+                except (BlockingIOError, InterruptedError):
+                    yield from self._sock_wait_writable(fd)
+                    continue
+                except OSError as exc:
+                    if total_sent == 0:
+                        # the file or the socket type is not supported:
+                        # let the caller read the file instead
+                        raise events.SendfileNotAvailableError(
+                            "os.sendfile() failed: %s" % exc) from exc
+                    raise
+                if not sent:
+                    # end of file
+                    break
+                offset += sent
+                total_sent += sent
+            return total_sent
+        finally:
+            if total_sent > 0:
+                file.seek(offset)
+
+    @coroutine
+    def _sock_wait_writable(self, fd):
+        fut = futures.Future(loop=self)
+        self.add_writer(fd, fut._set_result_unless_cancelled, None)
+        try:
+            yield from fut
+        finally:
+            self.remove_writer(fd)
+
 
 if hasattr(os, 'set_blocking'):
     def _set_nonblocking(fd):
@@ -303,6 +421,7 @@ def __init__(self, loop, pipe, protocol, waiter=None, extra=None):
         super().__init__(extra)
         self._extra['pipe'] = pipe
         self._loop = loop
+        self._stats = transports._TransportStats(loop)
         self._pipe = pipe
         self._fileno = pipe.fileno()
         mode = os.fstat(self._fileno).st_mode
@@ -341,15 +460,19 @@ def __repr__(self):
         return '<%s>' % ' '.join(info)
 
     def _read_ready(self):
+        buffers, view = _get_read_buffer(self.max_size)
         try:
-            data = os.read(self._fileno, self.max_size)
+            nbytes = os.readv(self._fileno, buffers)
         except (BlockingIOError, InterruptedError):
             pass
         except OSError as exc:
             self._fatal_error(exc, 'Fatal read error on pipe transport')
         else:
-            if data:
-                self._protocol.data_received(data)
+            if nbytes:
+                stats = self._stats
+                stats.reads += 1
+                stats.bytes_received += nbytes
+                self._protocol.data_received(view[:nbytes].tobytes())
             else:
                 if self._loop.get_debug():
                     logger.info("%r was closed by peer", self)
@@ -359,11 +482,16 @@ def _read_ready(self):
                 self._loop.call_soon(self._call_connection_lost, None)
 
     def pause_reading(self):
+        self._stats.reading_pauses += 1
         self._loop.remove_reader(self._fileno)
 
     def resume_reading(self):
+        self._stats.reading_resumes += 1
         self._loop.add_reader(self._fileno, self._read_ready)
 
+    def is_closing(self):
+        return self._closing
+
     def close(self):
         if not self._closing:
             self._close(None)
@@ -406,7 +534,8 @@ def _call_connection_lost(self, exc):
             self._loop = None
 
 
-class _UnixWritePipeTransport(transports._FlowControlMixin,
+class _UnixWritePipeTransport(transports._WriteQueueMixin,
+                              transports._FlowControlMixin,
                               transports.WriteTransport):
 
     def __init__(self, loop, pipe, protocol, waiter=None, extra=None):
@@ -423,7 +552,7 @@ def __init__(self, loop, pipe, protocol, waiter=None, extra=None):
                              "pipes, sockets and character devices")
         _set_nonblocking(self._fileno)
         self._protocol = protocol
-        self._buffer = []
+        self._buffer = collections.deque()
         self._conn_lost = 0
         self._closing = False  # Set when close() or write_eof() called.
 
@@ -463,9 +592,6 @@ def __repr__(self):
             info.append('closed')
         return '<%s>' % ' '.join(info)
 
-    def get_write_buffer_size(self):
-        return sum(len(data) for data in self._buffer)
-
     def _read_ready(self):
         # Pipe was closed by peer.
         if self._loop.get_debug():
@@ -477,8 +603,6 @@ def _read_ready(self):
 
     def write(self, data):
         assert isinstance(data, (bytes, bytearray, memoryview)), repr(data)
-        if isinstance(data, bytearray):
-            data = memoryview(data)
         if not data:
             return
 
@@ -499,42 +623,51 @@ def write(self, data):
                 self._conn_lost += 1
                 self._fatal_error(exc, 'Fatal write error on pipe transport')
                 return
+            if n:
+                stats = self._stats
+                stats.writes += 1
+                stats.bytes_sent += n
             if n == len(data):
                 return
             elif n > 0:
-                data = data[n:]
+                data = memoryview(data)[n:]
             self._loop.add_writer(self._fileno, self._write_ready)
 
-        self._buffer.append(data)
+        self._buffer_append(data)
         self._maybe_pause_protocol()
 
     def _write_ready(self):
-        data = b''.join(self._buffer)
-        assert data, 'Data should not be empty'
+        assert self._buffer, 'Data should not be empty'
 
-        self._buffer.clear()
         try:
-            n = os.write(self._fileno, data)
+            if len(self._buffer) > 1:
+                # Write the queued buffers without concatenating them
+                n = os.writev(self._fileno,
+                              list(itertools.islice(self._buffer,
+                                                    selector_events._IOV_MAX)))
+            else:
+                n = os.write(self._fileno, self._buffer[0])
         except (BlockingIOError, InterruptedError):
-            self._buffer.append(data)
+            return
         except Exception as exc:
             self._conn_lost += 1
             # Remove writer here, _fatal_error() doesn't it
             # because _buffer is empty.
+            self._buffer_clear()
             self._loop.remove_writer(self._fileno)
             self._fatal_error(exc, 'Fatal write error on pipe transport')
-        else:
-            if n == len(data):
-                self._loop.remove_writer(self._fileno)
-                self._maybe_resume_protocol()  # May append to buffer.
-                if not self._buffer and self._closing:
-                    self._loop.remove_reader(self._fileno)
-                    self._call_connection_lost(None)
-                return
-            elif n > 0:
-                data = data[n:]
+            return
 
-            self._buffer.append(data)  # Try again later.
+        stats = self._stats
+        stats.writes += 1
+        stats.bytes_sent += n
+        self._buffer_consume(n)
+        if not self._buffer:
+            self._loop.remove_writer(self._fileno)
+        self._maybe_resume_protocol()  # May append to buffer.
+        if not self._buffer and self._closing:
+            self._loop.remove_reader(self._fileno)
+            self._call_connection_lost(None)
 
     def can_write_eof(self):
         return True
@@ -548,6 +681,9 @@ def write_eof(self):
             self._loop.remove_reader(self._fileno)
             self._loop.call_soon(self._call_connection_lost, None)
 
+    def is_closing(self):
+        return self._closing
+
     def close(self):
         if self._pipe is not None and not self._closing:
             # write_eof is all what we needed to close the write pipe
@@ -583,7 +719,7 @@ def _close(self, exc=None):
         self._closing = True
         if self._buffer:
             self._loop.remove_writer(self._fileno)
-        self._buffer.clear()
+        self._buffer_clear()
         self._loop.remove_reader(self._fileno)
         self._loop.call_soon(self._call_connection_lost, exc)
 
@@ -708,6 +844,20 @@ def __exit__(self, a, b, c):
         raise NotImplementedError()
 
 
+def _compute_returncode(status):
+    if os.WIFSIGNALED(status):
+        # The child process died because of a signal.
+        return -os.WTERMSIG(status)
+    elif os.WIFEXITED(status):
+        # The child process exited (e.g sys.exit()).
+        return os.WEXITSTATUS(status)
+    else:
+        # The child exited, but we don't understand its status.
+        # This shouldn't happen, but if it does, let's just
+        # return that status; perhaps that helps debug it.
+        return status
+
+
 class BaseChildWatcher(AbstractChildWatcher):
 
     def __init__(self):
@@ -749,17 +899,7 @@ def _sig_chld(self):
             })
 
     def _compute_returncode(self, status):
-        if os.WIFSIGNALED(status):
-            # The child process died because of a signal.
-            return -os.WTERMSIG(status)
-        elif os.WIFEXITED(status):
-            # The child process exited (e.g sys.exit()).
-            return os.WEXITSTATUS(status)
-        else:
-            # The child exited, but we don't understand its status.
-            # This shouldn't happen, but if it does, let's just
-            # return that status; perhaps that helps debug it.
-            return status
+        return _compute_returncode(status)
 
 
 class SafeChildWatcher(BaseChildWatcher):
@@ -945,6 +1085,101 @@ def _do_waitpid_all(self):
                 callback(pid, returncode, *args)
 
 
+class PidfdChildWatcher(AbstractChildWatcher):
+    """Child watcher implementation using Linux process file descriptors.
+
+    Each child process gets a file descriptor opened by pidfd_open(), which
+    becomes readable when the process terminates: the watcher registers it
+    in the event loop and calls os.waitpid() only for the process which
+    exited.  There is no SIGCHLD handler, processes spawned by other code
+    are not reaped, and the cost is O(1) each time a child terminates.
+
+    It requires Linux 5.3 or newer.  Handlers must be added from the thread
+    of the attached event loop.
+    """
+
+    def __init__(self):
+        if _pidfd_open is None:
+            raise RuntimeError('pidfd_open() is not supported on %s'
+                               % sys.platform)
+        # Fail early on kernels older than Linux 5.3, rather than when the
+        # first child process has already been spawned
+        try:
+            os.close(_pidfd_open(os.getpid()))
+        except OSError as exc:
+            raise RuntimeError('pidfd_open() is not supported: %s' % exc)
+        self._loop = None
+        # pid => (pidfd, callback, args)
+        self._callbacks = {}
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, a, b, c):
+        pass
+
+    def close(self):
+        self.attach_loop(None)
+
+    def attach_loop(self, loop):
+        assert loop is None or isinstance(loop, events.AbstractEventLoop)
+
+        if self._loop is not None:
+            for pidfd, callback, args in self._callbacks.values():
+                self._loop.remove_reader(pidfd)
+        if loop is None:
+            if self._loop is not None and self._callbacks:
+                warnings.warn('A loop is being detached from a child watcher '
+                              'with pending handlers', RuntimeWarning)
+            for pidfd, callback, args in self._callbacks.values():
+                os.close(pidfd)
+            self._callbacks.clear()
+        else:
+            # Keep watching the running processes from the new loop
+            for pid, (pidfd, callback, args) in self._callbacks.items():
+                loop.add_reader(pidfd, self._do_wait, pid)
+        self._loop = loop
+
+    def add_child_handler(self, pid, callback, *args):
+        existing = self._callbacks.get(pid)
+        if existing is not None:
+            self._callbacks[pid] = existing[0], callback, args
+            return
+        pidfd = _pidfd_open(pid)
+        self._loop.add_reader(pidfd, self._do_wait, pid)
+        self._callbacks[pid] = pidfd, callback, args
+
+    def remove_child_handler(self, pid):
+        try:
+            pidfd, callback, args = self._callbacks.pop(pid)
+        except KeyError:
+            return False
+        self._loop.remove_reader(pidfd)
+        os.close(pidfd)
+        return True
+
+    def _do_wait(self, pid):
+        pidfd, callback, args = self._callbacks.pop(pid)
+        self._loop.remove_reader(pidfd)
+        os.close(pidfd)
+        try:
+            _, status = os.waitpid(pid, os.WNOHANG)
+        except ChildProcessError:
+            # The child process is already reaped
+            # (may happen if waitpid() is called elsewhere).
+            returncode = 255
+            logger.warning(
+                "child process pid %d exit status already read: "
+                "will report returncode 255",
+                pid)
+        else:
+            returncode = _compute_returncode(status)
+            if self._loop.get_debug():
+                logger.debug('process %s exited with returncode %s',
+                             pid, returncode)
+        callback(pid, returncode, *args)
+
+
 class _UnixDefaultEventLoopPolicy(events.BaseDefaultEventLoopPolicy):
     """UNIX event loop policy with a watcher for child processes."""
     _loop_factory = _UnixSelectorEventLoop
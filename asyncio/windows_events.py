@@ -1,10 +1,15 @@
 """Selector and proactor event loops for Windows."""
 
 import _winapi
+import collections
+import concurrent.futures
 import errno
+import itertools
 import math
+import msvcrt
 import socket
 import struct
+import threading
 import weakref
 
 from . import events
@@ -20,7 +25,7 @@
 
 
 __all__ = ['SelectorEventLoop', 'ProactorEventLoop', 'IocpProactor',
-           'DefaultEventLoopPolicy',
+           'IocpCompletionPort', 'DefaultEventLoopPolicy',
            ]
 
 
@@ -35,6 +40,41 @@
 # Maximum delay in seconds for connect_pipe() before retrying to connect
 CONNECT_PIPE_MAX_DELAY = 0.100
 
+# Timeout in milliseconds of the WaitNamedPipe() calls of connect_pipe():
+# it bounds the time a thread of the executor stays blocked once the
+# connection is cancelled
+CONNECT_PIPE_WAIT_TIMEOUT = 100
+
+# Maximum number of WaitNamedPipe() calls of connect_pipe() running at the
+# same time, in the threads of a small executor of the proactor (not the
+# default executor of the loop).  Other busy connections retry with a delay.
+CONNECT_PIPE_MAX_WAITS = 2
+
+ERROR_SEM_TIMEOUT = 121
+
+# Maximum number of completion events dequeued by a single call to
+# GetQueuedCompletionStatusEx() in IocpProactor._poll()
+MAX_COMPLETION_ENTRIES = 64
+
+# Maximum number of Overlapped objects kept by an IocpProactor to be reused
+# by new operations
+MAX_FREE_OVERLAPPED = 256
+
+
+def _is_ifs_socket(sock):
+    # Skipping completion events is only reliable for sockets of installable
+    # file system (IFS) providers: a non-IFS layered service provider may not
+    # report the synchronous completion of an operation as expected.
+    try:
+        info = sock.getsockopt(socket.SOL_SOCKET,
+                               _overlapped.SO_PROTOCOL_INFOW,
+                               _overlapped.SIZEOF_WSAPROTOCOL_INFOW)
+    except OSError:
+        return False
+    # dwServiceFlags1 is the first field of the WSAPROTOCOL_INFOW structure
+    flags, = struct.unpack_from('=L', info)
+    return bool(flags & _overlapped.XP1_IFS_HANDLES)
+
 
 class _OverlappedFuture(futures.Future):
     """Subclass of Future which represents an overlapped operation.
@@ -241,7 +281,7 @@ def __init__(self, address):
         # because this function can raise an exception and the destructor calls
         # the close() method
         self._pipe = None
-        self._accept_pipe_future = None
+        self._accept_pipe_futures = set()
         self._pipe = self._server_pipe_handle(True)
 
     def _get_unconnected_pipe(self):
@@ -274,9 +314,9 @@ def closed(self):
         return (self._address is None)
 
     def close(self):
-        if self._accept_pipe_future is not None:
-            self._accept_pipe_future.cancel()
-            self._accept_pipe_future = None
+        for future in self._accept_pipe_futures:
+            future.cancel()
+        self._accept_pipe_futures.clear()
         # Close all instances which have not been connected to by a client.
         if self._address is not None:
             for pipe in self._free_instances:
@@ -306,6 +346,11 @@ def __init__(self, proactor=None):
     def _socketpair(self):
         return windows_utils.socketpair()
 
+    def _write_to_self(self):
+        # Post a completion event to the proactor, cheaper than writing into
+        # the self-pipe and reading it back
+        self._proactor.wakeup()
+
     @coroutine
     def create_pipe_connection(self, protocol_factory, address):
         f = self._proactor.connect_pipe(address)
@@ -316,13 +361,20 @@ def create_pipe_connection(self, protocol_factory, address):
         return trans, protocol
 
     @coroutine
-    def start_serving_pipe(self, protocol_factory, address):
+    def start_serving_pipe(self, protocol_factory, address, *,
+                           accept_concurrency=None):
+        if accept_concurrency is None:
+            accept_concurrency = self.accept_concurrency
+        if accept_concurrency < 1:
+            raise ValueError('accept_concurrency must be >= 1, got %r'
+                             % (accept_concurrency,))
         server = PipeServer(address)
 
         def loop_accept_pipe(f=None):
             pipe = None
             try:
                 if f:
+                    server._accept_pipe_futures.discard(f)
                     pipe = f.result()
                     server._free_instances.discard(pipe)
 
@@ -356,10 +408,13 @@ def loop_accept_pipe(f=None):
                 if pipe:
                     pipe.close()
             else:
-                server._accept_pipe_future = f
+                server._accept_pipe_futures.add(f)
                 f.add_done_callback(loop_accept_pipe)
 
-        self.call_soon(loop_accept_pipe)
+        # Each loop keeps one pipe instance waiting for a client: a burst of
+        # clients doesn't get ERROR_PIPE_BUSY
+        for i in range(accept_concurrency):
+            self.call_soon(loop_accept_pipe)
         return [server]
 
     @coroutine
@@ -388,18 +443,101 @@ def _make_subprocess_transport(self, protocol, args, shell,
         return transp
 
 
-class IocpProactor:
-    """Proactor implementation using IOCP."""
+class IocpCompletionPort:
+    """I/O completion port shared by the IocpProactor of several threads.
+
+    Each thread runs its own event loop with its own proactor, created with
+    IocpProactor(completion_port=port).  All threads dequeue the completion
+    events of the shared port, so the work done without the GIL is spread
+    over the threads.  The handles of a proactor are registered with its own
+    completion key: an event dequeued by another thread is handed off to the
+    proactor owning it.
+
+    Close the port once the proactors of all threads are closed.
+    """
 
     def __init__(self, concurrency=0xffffffff):
-        self._loop = None
-        self._results = []
         self._iocp = _overlapped.CreateIoCompletionPort(
             _overlapped.INVALID_HANDLE_VALUE, NULL, 0, concurrency)
+        self._lock = threading.Lock()
+        # completion key => proactor; lookups are done without the lock
+        self._proactors = {}
+        self._keys = itertools.count(1)
+
+    def __repr__(self):
+        info = [self.__class__.__name__]
+        if self._iocp is None:
+            info.append('closed')
+        info.append('proactors=%s' % len(self._proactors))
+        return '<%s>' % ' '.join(info)
+
+    def _attach(self, proactor):
+        # Return the completion key of proactor
+        with self._lock:
+            if self._iocp is None:
+                raise RuntimeError('the completion port is closed')
+            key = next(self._keys)
+            self._proactors[key] = proactor
+        return key
+
+    def _detach(self, key):
+        with self._lock:
+            self._proactors.pop(key, None)
+
+    def close(self):
+        with self._lock:
+            if self._proactors:
+                raise RuntimeError('the completion port is still used by %s '
+                                   'proactors' % len(self._proactors))
+            if self._iocp is not None:
+                _winapi.CloseHandle(self._iocp)
+                self._iocp = None
+
+
+class IocpProactor:
+    """Proactor implementation using IOCP.
+
+    By default, the proactor creates its own completion port.  Pass an
+    IocpCompletionPort to share a completion port between the proactors of
+    several threads.
+    """
+
+    # Maximum number of disconnected sockets kept, for each address family,
+    # to be reused by AcceptEx(); 0 disables the reuse of accepted sockets
+    accept_pool_size = 0
+
+    def __init__(self, concurrency=0xffffffff, *, completion_port=None):
+        self._loop = None
+        self._results = []
+        self._port = completion_port
+        if completion_port is None:
+            self._iocp = _overlapped.CreateIoCompletionPort(
+                _overlapped.INVALID_HANDLE_VALUE, NULL, 0, concurrency)
+            self._key = 0
+        else:
+            self._iocp = completion_port._iocp
+            self._key = completion_port._attach(self)
+            # Completion events of this proactor dequeued by other threads,
+            # appended by the other threads and consumed by _poll()
+            self._handoff = collections.deque()
+            # True while _poll() may block in GetQueuedCompletionStatusEx()
+            self._polling = False
+        # Overlapped object used to post wake-up events to this proactor
+        self._wakeup_ov = _overlapped.Overlapped(NULL)
         self._cache = {}
         self._registered = weakref.WeakSet()
+        # Objects in FILE_SKIP_COMPLETION_PORT_ON_SUCCESS mode
+        self._skip_completion_port = weakref.WeakSet()
         self._unregistered = []
         self._stopped_serving = weakref.WeakSet()
+        # Overlapped objects of completed operations, ready to be reused
+        self._free_overlapped = []
+        # family => list of sockets disconnected with TF_REUSE_SOCKET
+        self._accept_sockets = {}
+        # Executor running the WaitNamedPipe() calls of connect_pipe(),
+        # created on demand, and the number of calls in progress
+        self._pipe_wait_executor = None
+        self._pipe_waits = 0
 
     def __repr__(self):
         return ('<%s overlapped#=%s result#=%s>'
@@ -409,6 +547,28 @@ def __repr__(self):
     def set_loop(self, loop):
         self._loop = loop
 
+    def wakeup(self):
+        """Wake up the thread waiting in select().
+
+        This method can be called from any thread: it posts a completion
+        event instead of writing into a self-pipe.
+        """
+        iocp = self._iocp
+        if iocp is None:
+            return
+        if self._port is not None:
+            # the thread dequeuing the event may not be the owner: the
+            # marker makes the owner skip the wait if it was not blocked yet
+            self._handoff.append(None)
+        try:
+            _overlapped.PostQueuedCompletionStatus(
+                iocp, 0, self._key, self._wakeup_ov.address)
+        except OSError:
+            # the proactor has been closed in the meanwhile
+            if self._loop is not None and self._loop.get_debug():
+                logger.debug("Fail to post a wake-up event to %r", self,
+                             exc_info=True)
+
     def select(self, timeout=None):
         if not self._results:
             self._poll(timeout)
@@ -421,9 +581,24 @@ def _result(self, value):
         fut.set_result(value)
         return fut
 
+    def _get_overlapped(self):
+        if self._free_overlapped:
+            return self._free_overlapped.pop()
+        return _overlapped.Overlapped(NULL)
+
+    def _release_overlapped(self, f, ov):
+        # Only reuse the Overlapped object of a completed operation once its
+        # future dropped it: nobody can cancel it or read its result anymore.
+        # Wait handle futures keep their Overlapped object.
+        if (not isinstance(f, _OverlappedFuture) or f._ov is not None
+           or len(self._free_overlapped) >= MAX_FREE_OVERLAPPED):
+            return
+        ov.reset()
+        self._free_overlapped.append(ov)
+
     def recv(self, conn, nbytes, flags=0):
         self._register_with_iocp(conn)
-        ov = _overlapped.Overlapped(NULL)
+        ov = self._get_overlapped()
         try:
             if isinstance(conn, socket.socket):
                 ov.WSARecv(conn.fileno(), nbytes, flags)
@@ -443,9 +618,31 @@ def finish_recv(trans, key, ov):
 
         return self._register(ov, conn, finish_recv)
 
+    def recv_into(self, conn, buf, flags=0):
+        self._register_with_iocp(conn)
+        ov = self._get_overlapped()
+        try:
+            if isinstance(conn, socket.socket):
+                ov.WSARecvInto(conn.fileno(), buf, flags)
+            else:
+                ov.ReadFileInto(conn.fileno(), buf)
+        except BrokenPipeError:
+            return self._result(0)
+
+        def finish_recv(trans, key, ov):
+            try:
+                return ov.getresult()
+            except OSError as exc:
+                if exc.winerror == _overlapped.ERROR_NETNAME_DELETED:
+                    raise ConnectionResetError(*exc.args)
+                else:
+                    raise
+
+        return self._register(ov, conn, finish_recv)
+
     def send(self, conn, buf, flags=0):
         self._register_with_iocp(conn)
-        ov = _overlapped.Overlapped(NULL)
+        ov = self._get_overlapped()
         if isinstance(conn, socket.socket):
             ov.WSASend(conn.fileno(), buf, flags)
         else:
@@ -462,10 +659,89 @@ def finish_send(trans, key, ov):
 
         return self._register(ov, conn, finish_send)
 
+    def send_buffers(self, conn, buffers, flags=0):
+        self._register_with_iocp(conn)
+        ov = self._get_overlapped()
+        if isinstance(conn, socket.socket):
+            ov.WSASendBuffers(conn.fileno(), buffers, flags)
+        else:
+            ov.WriteFile(conn.fileno(), b''.join(buffers))
+
+        def finish_send(trans, key, ov):
+            try:
+                return ov.getresult()
+            except OSError as exc:
+                if exc.winerror == _overlapped.ERROR_NETNAME_DELETED:
+                    raise ConnectionResetError(*exc.args)
+                else:
+                    raise
+
+        return self._register(ov, conn, finish_send)
+
+    def recvfrom(self, conn, nbytes, flags=0):
+        """Receive a datagram: the result is a (data, address) pair."""
+        self._register_with_iocp(conn)
+        ov = self._get_overlapped()
+        ov.WSARecvFrom(conn.fileno(), nbytes, flags)
+
+        def finish_recvfrom(trans, key, ov):
+            try:
+                return ov.getresult()
+            except OSError as exc:
+                if exc.winerror == _overlapped.ERROR_NETNAME_DELETED:
+                    raise ConnectionResetError(*exc.args)
+                else:
+                    raise
+
+        return self._register(ov, conn, finish_recvfrom)
+
+    def sendto(self, conn, buf, flags=0, addr=None):
+        """Send a datagram to addr."""
+        self._register_with_iocp(conn)
+        ov = self._get_overlapped()
+        ov.WSASendTo(conn.fileno(), buf, flags, addr)
+
+        def finish_sendto(trans, key, ov):
+            try:
+                return ov.getresult()
+            except OSError as exc:
+                if exc.winerror == _overlapped.ERROR_NETNAME_DELETED:
+                    raise ConnectionResetError(*exc.args)
+                else:
+                    raise
+
+        return self._register(ov, conn, finish_sendto)
+
+    def sendfile(self, sock, file, offset, count):
+        """Send count bytes of file from offset with TransmitFile().
+
+        The file content is not copied in user space.  count must be
+        positive and lower than 2**32.
+        """
+        self._register_with_iocp(sock)
+        ov = self._get_overlapped()
+        offset_low = offset & 0xffffffff
+        offset_high = (offset >> 32) & 0xffffffff
+        ov.TransmitFile(sock.fileno(),
+                        msvcrt.get_osfhandle(file.fileno()),
+                        offset_low, offset_high,
+                        count, 0, 0)
+
+        def finish_sendfile(trans, key, ov):
+            try:
+                return ov.getresult()
+            except OSError as exc:
+                if exc.winerror == _overlapped.ERROR_NETNAME_DELETED:
+                    raise ConnectionResetError(*exc.args)
+                else:
+                    raise
+
+        return self._register(ov, sock, finish_sendfile)
+
     def accept(self, listener):
         self._register_with_iocp(listener)
         conn = self._get_accept_socket(listener.family)
-        ov = _overlapped.Overlapped(NULL)
+        ov = self._get_overlapped()
         ov.AcceptEx(listener.fileno(), conn.fileno())
 
         def finish_accept(trans, key, ov):
@@ -492,6 +768,11 @@ def accept_coro(future, conn):
         return future
 
     def connect(self, conn, address):
+        if conn.type == socket.SOCK_DGRAM:
+            # Connecting a datagram socket only sets its default destination
+            # and completes immediately
+            conn.connect(address)
+            return self._result(conn)
         self._register_with_iocp(conn)
         # The socket needs to be locally bound before we call ConnectEx().
         try:
@@ -502,7 +783,7 @@ def connect(self, conn, address):
             # Probably already locally bound; check using getsockname().
             if conn.getsockname()[1] == 0:
                 raise
-        ov = _overlapped.Overlapped(NULL)
+        ov = self._get_overlapped()
         ov.ConnectEx(conn.fileno(), address)
 
         def finish_connect(trans, key, ov):
@@ -514,9 +795,20 @@ def finish_connect(trans, key, ov):
 
         return self._register(ov, conn, finish_connect)
 
+    def disconnect(self, conn, flags=0):
+        self._register_with_iocp(conn)
+        ov = self._get_overlapped()
+        ov.DisconnectEx(conn.fileno(), flags)
+
+        def finish_disconnect(trans, key, ov):
+            ov.getresult()
+            return None
+
+        return self._register(ov, conn, finish_disconnect)
+
     def accept_pipe(self, pipe):
         self._register_with_iocp(pipe)
-        ov = _overlapped.Overlapped(NULL)
+        ov = self._get_overlapped()
         connected = ov.ConnectNamedPipe(pipe.fileno())
 
         if connected:
@@ -531,6 +823,16 @@ def finish_accept_pipe(trans, key, ov):
 
         return self._register(ov, pipe, finish_accept_pipe)
 
+    @staticmethod
+    def _wait_named_pipe(address):
+        # Called in a thread: return None when an instance of the pipe
+        # waits for a client, or the error of WaitNamedPipe()
+        try:
+            _winapi.WaitNamedPipe(address, CONNECT_PIPE_WAIT_TIMEOUT)
+        except OSError as exc:
+            return exc
+        return None
+
     @coroutine
     def connect_pipe(self, address):
         delay = CONNECT_PIPE_INIT_DELAY
@@ -545,7 +847,25 @@ def connect_pipe(self, address):
                 if exc.winerror != _overlapped.ERROR_PIPE_BUSY:
                     raise
 
-            # ConnectPipe() failed with ERROR_PIPE_BUSY: retry later
+            # ConnectPipe() failed with ERROR_PIPE_BUSY: wait in a thread
+            # until the server posts ConnectNamedPipe() on an instance.
+            # Another client can connect to it first: retry.
+            if self._pipe_waits < CONNECT_PIPE_MAX_WAITS:
+                if self._pipe_wait_executor is None:
+                    self._pipe_wait_executor = \
+                        concurrent.futures.ThreadPoolExecutor(
+                            CONNECT_PIPE_MAX_WAITS)
+                self._pipe_waits += 1
+                try:
+                    err = yield from self._loop.run_in_executor(
+                        self._pipe_wait_executor, self._wait_named_pipe,
+                        address)
+                finally:
+                    self._pipe_waits -= 1
+                if err is None or err.winerror == ERROR_SEM_TIMEOUT:
+                    continue
+            # All the waiting threads are busy or WaitNamedPipe() failed:
+            # retry later
             delay = min(delay * 2, CONNECT_PIPE_MAX_DELAY)
             yield from tasks.sleep(delay, loop=self._loop)
 
@@ -577,7 +897,7 @@ def _wait_for_handle(self, handle, timeout, _is_cancel):
         # We only create ov so we can use ov.address as a key for the cache.
         ov = _overlapped.Overlapped(NULL)
         wait_handle = _overlapped.RegisterWaitWithQueue(
-            handle, self._iocp, ov.address, ms)
+            handle, self._iocp, ov.address, ms, self._key)
         if _is_cancel:
             f = _WaitCancelFuture(ov, handle, wait_handle, loop=self._loop)
         else:
@@ -603,10 +923,22 @@ def _register_with_iocp(self, obj):
         # completion port, were must register the handle.
         if obj not in self._registered:
             self._registered.add(obj)
-            _overlapped.CreateIoCompletionPort(obj.fileno(), self._iocp, 0, 0)
-            # XXX We could also use SetFileCompletionNotificationModes()
-            # to avoid sending notifications to completion port of ops
-            # that succeed immediately.
+            _overlapped.CreateIoCompletionPort(obj.fileno(), self._iocp,
+                                               self._key, 0)
+            self._set_skip_completion_port(obj)
+
+    def _set_skip_completion_port(self, obj):
+        # Don't send notifications to the completion port for operations
+        # that succeed immediately: _register() finishes them inline.
+        if isinstance(obj, socket.socket) and not _is_ifs_socket(obj):
+            return
+        try:
+            _overlapped.SetFileCompletionNotificationModes(
+                obj.fileno(), _overlapped.FILE_SKIP_COMPLETION_PORT_ON_SUCCESS)
+        except (OSError, NotImplementedError):
+            # Windows XP, or the handle doesn't support the mode
+            return
+        self._skip_completion_port.add(obj)
 
     def _register(self, ov, obj, callback):
         # Return a future which will be set with the result of the
@@ -616,6 +948,10 @@ def _register(self, ov, obj, callback):
         if f._source_traceback:
             del f._source_traceback[-1]
         if not ov.pending:
+            # No completion event is queued for an operation which succeeded
+            # immediately on an object in FILE_SKIP_COMPLETION_PORT_ON_SUCCESS
+            # mode.  Check ov.error before the callback overrides it.
+            skipped = (ov.error == 0 and obj in self._skip_completion_port)
             # The operation has completed, so no need to postpone the
             # work.  We cannot take this short cut if we need the
             # NumberOfBytes, CompletionKey values returned by
@@ -626,11 +962,17 @@ def _register(self, ov, obj, callback):
                 f.set_exception(e)
             else:
                 f.set_result(value)
-            # Even if GetOverlappedResult() was called, we have to wait for the
-            # notification of the completion in GetQueuedCompletionStatus().
-            # Register the overlapped operation to keep a reference to the
-            # OVERLAPPED object, otherwise the memory is freed and Windows may
-            # read uninitialized memory.
+            if skipped:
+                # The kernel is done with the OVERLAPPED structure and
+                # _poll() will never see the operation: don't cache it.
+                self._release_overlapped(f, ov)
+                return f
+            # Otherwise, even if GetOverlappedResult() was called, we have to
+            # wait for the notification of the completion in
+            # GetQueuedCompletionStatusEx().  Register the overlapped
+            # operation to keep a reference to the OVERLAPPED object,
+            # otherwise the memory is freed and Windows may read uninitialized
+            # memory.
 
         # Register the overlapped operation for later.  Note that
         # we only store obj to prevent it from being garbage
@@ -648,10 +990,39 @@ def _unregister(self, ov):
         self._unregistered.append(ov)
 
     def _get_accept_socket(self, family):
+        pool = self._accept_sockets.get(family)
+        if pool:
+            return pool.pop()
         s = socket.socket(family)
         s.settimeout(0)
         return s
 
+    def recycle_accept_socket(self, conn):
+        """Disconnect a socket returned by accept() to reuse it later.
+
+        Return False if the socket is not reused: the caller must close it.
+        Otherwise the proactor takes the ownership of the socket.
+        """
+        if not self.accept_pool_size:
+            return False
+        pool = self._accept_sockets.setdefault(conn.family, [])
+        if len(pool) >= self.accept_pool_size:
+            return False
+        try:
+            fut = self.disconnect(conn, _overlapped.TF_REUSE_SOCKET)
+        except OSError:
+            return False
+
+        def done(fut):
+            if (fut.cancelled() or fut.exception() is not None
+               or self._iocp is None or len(pool) >= self.accept_pool_size):
+                conn.close()
+            else:
+                pool.append(conn)
+
+        fut.add_done_callback(done)
+        return True
+
     def _poll(self, timeout=None):
         if timeout is None:
             ms = INFINITE
@@ -664,49 +1035,122 @@ def _poll(self, timeout=None):
             if ms >= INFINITE:
                 raise ValueError("timeout too big")
 
-        while True:
-            status = _overlapped.GetQueuedCompletionStatus(self._iocp, ms)
-            if status is None:
-                break
-            ms = 0
-
-            err, transferred, key, address = status
-            try:
-                f, ov, obj, callback = self._cache.pop(address)
-            except KeyError:
-                if self._loop.get_debug():
-                    self._loop.call_exception_handler({
-                        'message': ('GetQueuedCompletionStatus() returned an '
-                                    'unexpected event'),
-                        'status': ('err=%s transferred=%s key=%#x address=%#x'
-                                   % (err, transferred, key, address)),
-                    })
-
-                # key is either zero, or it is used to return a pipe
-                # handle which should be closed to avoid a leak.
-                if key not in (0, _overlapped.INVALID_HANDLE_VALUE):
-                    _winapi.CloseHandle(key)
-                continue
-
-            if obj in self._stopped_serving:
-                f.cancel()
-            # Don't call the callback if _register() already read the result or
-            # if the overlapped has been cancelled
-            elif not f.done():
-                try:
-                    value = callback(transferred, key, ov)
-                except OSError as e:
-                    f.set_exception(e)
-                    self._results.append(f)
-                else:
-                    f.set_result(value)
-                    self._results.append(f)
+        port = self._port
+        if port is not None:
+            # Set the flag before checking the handoff queue: a thread
+            # handing off an event after the check wakes us up
+            self._polling = True
+            if self._handoff:
+                ms = 0
+        try:
+            self._poll_statuses(ms)
+        finally:
+            if port is not None:
+                self._polling = False
 
         # Remove unregisted futures
         for ov in self._unregistered:
             self._cache.pop(ov.address, None)
         self._unregistered.clear()
 
+    def _route_statuses(self, statuses):
+        # Hand off the completion events of other proactors sharing the
+        # completion port to their owner, and return the events of this
+        # proactor including the ones handed off by other threads
+        proactors = self._port._proactors
+        own = []
+        wakeup = set()
+        for status in statuses:
+            key = status[2]
+            address = status[3]
+            if key == self._key:
+                if address != self._wakeup_ov.address:
+                    own.append(status)
+                continue
+            owner = proactors.get(key)
+            if owner is None:
+                # unknown key, or the proactor has been closed
+                own.append(status)
+                continue
+            if address != owner._wakeup_ov.address:
+                owner._handoff.append(status)
+            elif not owner._handoff:
+                # the owner already consumed its events
+                continue
+            wakeup.add(owner)
+        for owner in wakeup:
+            if owner._polling:
+                # The owner may be blocked in GetQueuedCompletionStatusEx():
+                # wake it up
+                _overlapped.PostQueuedCompletionStatus(
+                    self._iocp, 0, owner._key, owner._wakeup_ov.address)
+        handoff = self._handoff
+        while handoff:
+            status = handoff.popleft()
+            # None is the marker of wakeup()
+            if status is not None:
+                own.append(status)
+        return own
+
+    def _poll_statuses(self, ms):
+        while True:
+            statuses = _overlapped.GetQueuedCompletionStatusEx(
+                self._iocp, MAX_COMPLETION_ENTRIES, ms)
+            ndequeued = len(statuses)
+            if self._port is not None:
+                self._polling = False
+                statuses = self._route_statuses(statuses)
+            if not statuses:
+                break
+            ms = 0
+
+            wakeup_address = self._wakeup_ov.address
+            for err, transferred, key, address in statuses:
+                if address == wakeup_address:
+                    # posted by wakeup()
+                    continue
+                try:
+                    f, ov, obj, callback = self._cache.pop(address)
+                except KeyError:
+                    if self._loop.get_debug():
+                        self._loop.call_exception_handler({
+                            'message': ('GetQueuedCompletionStatusEx() '
+                                        'returned an unexpected event'),
+                            'status': ('err=%s transferred=%s key=%#x '
+                                       'address=%#x'
+                                       % (err, transferred, key, address)),
+                        })
+
+                    # key is either zero, or it is used to return a pipe
+                    # handle which should be closed to avoid a leak.  On a
+                    # shared completion port, keys are proactor keys.
+                    if (self._port is None
+                       and key not in (0, _overlapped.INVALID_HANDLE_VALUE)):
+                        _winapi.CloseHandle(key)
+                    continue
+
+                if obj in self._stopped_serving:
+                    f.cancel()
+                # Don't call the callback if _register() already read the
+                # result or if the overlapped has been cancelled
+                elif not f.done():
+                    try:
+                        value = callback(transferred, key, ov)
+                    except OSError as e:
+                        f.set_exception(e)
+                        self._results.append(f)
+                    else:
+                        f.set_result(value)
+                        self._results.append(f)
+                self._release_overlapped(f, ov)
+
+            if (ndequeued < MAX_COMPLETION_ENTRIES
+            and _overlapped.HAVE_GET_QUEUED_COMPLETION_STATUS_EX):
+                # The completion port has been drained: don't pay for an
+                # extra call which would only return an empty list.  The
+                # fallback of Windows XP returns one event per call.
+                break
+
     def _stop_serving(self, obj):
         # obj is a socket or pipe handle.  It will be closed in
         # BaseProactorEventLoop._stop_serving() which will make any
@@ -741,8 +1185,22 @@ def close(self):
                 logger.debug('taking long time to close proactor')
 
         self._results = []
+        self._free_overlapped.clear()
+        if self._pipe_wait_executor is not None:
+            # a thread is blocked at most CONNECT_PIPE_WAIT_TIMEOUT ms
+            self._pipe_wait_executor.shutdown(wait=True)
+            self._pipe_wait_executor = None
+        for pool in self._accept_sockets.values():
+            for sock in pool:
+                sock.close()
+        self._accept_sockets.clear()
         if self._iocp is not None:
-            _winapi.CloseHandle(self._iocp)
+            if self._port is not None:
+                # the completion port is owned by the IocpCompletionPort
+                self._port._detach(self._key)
+                self._handoff.clear()
+            else:
+                _winapi.CloseHandle(self._iocp)
             self._iocp = None
 
     def __del__(self):
@@ -0,0 +1,334 @@
+"""Run a TCP server in several event loops, to use more than one core."""
+
+__all__ = ['ServerWorkers']
+
+import os
+import signal
+import socket
+import sys
+import threading
+
+from . import events
+from .coroutines import coroutine
+from .log import logger
+
+
+class _Worker:
+    """Event loop serving connections in a thread or in a child process."""
+
+    def __init__(self, workers, index):
+        self._workers = workers
+        self.index = index
+        self.loop = None
+        self.thread = None
+        self.pid = None
+        self.started = threading.Event()
+        self.error = None
+        # Pipe used by a child process to tell the parent that it started:
+        # its read end in the parent, its write end in the child
+        self.ready_fd = None
+
+    def __repr__(self):
+        info = ['%s #%s' % (self.__class__.__name__, self.index)]
+        if self.pid is not None:
+            info.append('pid=%s' % self.pid)
+        return '<%s>' % ' '.join(info)
+
+    def run(self, in_child=False):
+        # Create an event loop, start the server and run the loop until
+        # the worker is stopped
+        workers = self._workers
+        loop = None
+        servers = ()
+        try:
+            try:
+                loop = workers._loop_factory()
+                self.loop = loop
+                events.set_event_loop(loop)
+                if in_child:
+                    loop.add_signal_handler(signal.SIGTERM, loop.stop)
+                servers = loop.run_until_complete(
+                    workers._create_servers(loop))
+            except BaseException as exc:
+                self.error = exc
+                return
+            finally:
+                self._notify_started()
+            loop.run_forever()
+        finally:
+            if loop is not None:
+                for server in servers:
+                    server.close()
+                    loop.run_until_complete(server.wait_closed())
+                if in_child:
+                    loop.remove_signal_handler(signal.SIGTERM)
+                events.set_event_loop(None)
+                loop.close()
+
+    def _notify_started(self):
+        # Called by the worker once its servers are serving or failed
+        if self.ready_fd is not None:
+            # child process: write the status into the pipe
+            try:
+                os.write(self.ready_fd, b'1' if self.error is None else b'0')
+            finally:
+                os.close(self.ready_fd)
+                self.ready_fd = None
+        self.started.set()
+
+    def wait_started(self):
+        # Block until the worker serves or failed to start
+        if self.ready_fd is not None:
+            # child process: the pipe is closed without any status if it
+            # died before
+            try:
+                status = os.read(self.ready_fd, 1)
+            finally:
+                os.close(self.ready_fd)
+                self.ready_fd = None
+            if status != b'1':
+                self.error = RuntimeError('%r failed to start' % self)
+            self.started.set()
+        self.started.wait()
+
+    def stop(self):
+        if self.thread is not None:
+            loop = self.loop
+            if loop is not None and not loop.is_closed():
+                try:
+                    loop.call_soon_threadsafe(loop.stop)
+                except RuntimeError:
+                    # the loop was closed in the meanwhile
+                    pass
+        elif self.pid is not None:
+            try:
+                os.kill(self.pid, signal.SIGTERM)
+            except ProcessLookupError:
+                pass
+
+    def join(self):
+        if self.ready_fd is not None:
+            os.close(self.ready_fd)
+            self.ready_fd = None
+        if self.thread is not None:
+            self.thread.join()
+            self.thread = None
+        elif self.pid is not None:
+            os.waitpid(self.pid, 0)
+            self.pid = None
+
+
+class ServerWorkers:
+    """Serve TCP connections with several event loops.
+
+    Each worker runs its own event loop with its own server, in a thread
+    or, with use_fork=True, in a child process.  Because of the GIL, only
+    child processes use more than one core to run Python code.
+
+    With reuse_port=True, each worker binds its own listening sockets with
+    SO_REUSEPORT and the kernel balances the incoming connections between
+    the workers: port must then be a port number, not 0.  Otherwise, the
+    listening sockets are created once and shared by the workers: the first
+    worker calling accept() gets the connection.
+
+    protocol_factory, host, port and the other keyword arguments are passed
+    to the create_server() method of each worker loop.  loop_factory creates
+    the event loops of the workers, new_event_loop() by default.
+
+    Usage:
+
+        workers = ServerWorkers(EchoProtocol, '0.0.0.0', 8888, workers=4,
+                                use_fork=True, reuse_port=True)
+        workers.start()
+        try:
+            workers.wait()
+        finally:
+            workers.stop()
+    """
+
+    def __init__(self, protocol_factory, host=None, port=None, *,
+                 workers=None, use_fork=False, reuse_port=False,
+                 loop_factory=None, **kwds):
+        if workers is None:
+            workers = os.cpu_count() or 1
+        if workers < 1:
+            raise ValueError('workers must be >= 1, got %r' % workers)
+        if use_fork and not hasattr(os, 'fork'):
+            raise ValueError('use_fork is not supported on %s'
+                             % sys.platform)
+        if reuse_port and not hasattr(socket, 'SO_REUSEPORT'):
+            raise ValueError('reuse_port not supported by socket module')
+        if reuse_port and kwds.get('sock') is not None:
+            raise ValueError('reuse_port and sock can not be specified '
+                             'at the same time')
+        if reuse_port and not port:
+            # each worker would listen on its own random port
+            raise ValueError('reuse_port requires a port number, got %r'
+                             % (port,))
+        if loop_factory is None:
+            loop_factory = events.new_event_loop
+        self._protocol_factory = protocol_factory
+        self._host = host
+        self._port = port
+        self._kwds = kwds
+        self._nworker = workers
+        self._use_fork = use_fork
+        self._reuse_port = reuse_port
+        self._loop_factory = loop_factory
+        self._workers = []
+        # listening sockets shared by the workers
+        self._sockets = None
+        self._stopped = threading.Event()
+
+    def __repr__(self):
+        info = [self.__class__.__name__]
+        if self._use_fork:
+            info.append('fork')
+        if self._reuse_port:
+            info.append('reuse_port')
+        info.append('workers=%s' % self._nworker)
+        if self._workers:
+            info.append('running')
+        return '<%s>' % ' '.join(info)
+
+    @property
+    def sockets(self):
+        """Listening sockets shared by the workers, or None.
+
+        The sockets are only shared if reuse_port is false: they can be
+        used to get the port chosen by the kernel when port is 0.
+        """
+        return self._sockets
+
+    def _bind(self):
+        # Bind the listening sockets using a temporary event loop and keep
+        # a duplicate of each socket
+        sock = self._kwds.get('sock')
+        if sock is not None:
+            return [sock]
+        loop = self._loop_factory()
+        try:
+            server = loop.run_until_complete(
+                loop.create_server(self._protocol_factory,
+                                   self._host, self._port, **self._kwds))
+            sockets = [sock.dup() for sock in server.sockets]
+            server.close()
+            loop.run_until_complete(server.wait_closed())
+        finally:
+            loop.close()
+        return sockets
+
+    @coroutine
+    def _create_servers(self, loop):
+        # Return the list of the servers of a worker loop
+        kwds = dict(self._kwds)
+        if self._reuse_port:
+            server = yield from loop.create_server(self._protocol_factory,
+                                                   self._host, self._port,
+                                                   reuse_port=True, **kwds)
+            return [server]
+        # create_server() accepts a single socket: start one server per
+        # shared socket
+        kwds.pop('sock', None)
+        servers = []
+        try:
+            for sock in self._sockets:
+                if not self._use_fork:
+                    # each loop needs its own socket object
+                    sock = sock.dup()
+                server = yield from loop.create_server(self._protocol_factory,
+                                                       sock=sock, **kwds)
+                servers.append(server)
+        except:
+            for server in servers:
+                server.close()
+            raise
+        return servers
+
+    def start(self):
+        """Start the workers.
+
+        Return once each worker is serving.  If a worker failed to start
+        its server, stop the workers and raise its exception.  The error
+        of a child process is logged in the child, and RuntimeError is
+        raised.
+        """
+        if self._workers:
+            raise RuntimeError('workers are already running')
+        self._stopped.clear()
+        if not self._reuse_port:
+            self._sockets = self._bind()
+        try:
+            for index in range(self._nworker):
+                worker = _Worker(self, index)
+                self._workers.append(worker)
+                if self._use_fork:
+                    self._fork(worker)
+                else:
+                    worker.thread = threading.Thread(
+                        target=worker.run, name='ServerWorker-%s' % index,
+                        daemon=True)
+                    worker.thread.start()
+            for worker in self._workers:
+                worker.wait_started()
+                if worker.error is not None:
+                    raise worker.error
+        except:
+            self.stop()
+            raise
+
+    def _fork(self, worker):
+        rfd, wfd = os.pipe()
+        try:
+            pid = os.fork()
+        except:
+            os.close(rfd)
+            os.close(wfd)
+            raise
+        if pid:
+            os.close(wfd)
+            worker.pid = pid
+            worker.ready_fd = rfd
+            return
+        # child process
+        status = 1
+        try:
+            os.close(rfd)
+            worker.ready_fd = wfd
+            worker.pid = os.getpid()
+            worker.run(in_child=True)
+            if worker.error is not None:
+                logger.error('%r failed to start', worker,
+                             exc_info=worker.error)
+            else:
+                status = 0
+        except BaseException:
+            logger.exception('%r failed', worker)
+        finally:
+            os._exit(status)
+
+    def wait(self, timeout=None):
+        """Block until stop() is called.
+
+        Return True if the workers were stopped, False on timeout.
+        """
+        return self._stopped.wait(timeout)
+
+    def stop(self):
+        """Stop the workers and wait until they exit.
+
+        The workers close their servers: the connections already accepted
+        are not closed.
+        """
+        workers = self._workers
+        self._workers = []
+        for worker in workers:
+            worker.stop()
+        for worker in workers:
+            worker.join()
+        sockets = self._sockets
+        self._sockets = None
+        if sockets is not None and self._kwds.get('sock') is None:
+            for sock in sockets:
+                sock.close()
+        self._stopped.set()
@@ -33,6 +33,9 @@
 ARGS.add_argument(
     '--select', action='store_true', dest='select',
     default=False, help='Use Select event loop instead of default')
+ARGS.add_argument(
+    '--dns', action='store_true', dest='dns',
+    default=False, help='Resolve host names with asyncio.DNSResolver')
 ARGS.add_argument(
     'roots', nargs='*',
     default=[], help='Root URL (may be repeated)')
@@ -836,6 +839,8 @@ def main():
         asyncio.set_event_loop(loop)
     else:
         loop = asyncio.get_event_loop()
+    if args.dns:
+        loop.set_resolver(asyncio.DNSResolver(loop=loop))
 
     roots = {fix_url(root) for root in args.roots}
 
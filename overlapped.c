@@ -31,9 +31,10 @@
 
 #define T_HANDLE T_POINTER
 
-enum {TYPE_NONE, TYPE_NOT_STARTED, TYPE_READ, TYPE_WRITE, TYPE_ACCEPT,
-      TYPE_CONNECT, TYPE_DISCONNECT, TYPE_CONNECT_NAMED_PIPE,
-      TYPE_WAIT_NAMED_PIPE_AND_CONNECT};
+enum {TYPE_NONE, TYPE_NOT_STARTED, TYPE_READ, TYPE_READ_INTO, TYPE_WRITE,
+      TYPE_WRITE_BUFFERS, TYPE_ACCEPT, TYPE_CONNECT, TYPE_DISCONNECT,
+      TYPE_CONNECT_NAMED_PIPE, TYPE_WAIT_NAMED_PIPE_AND_CONNECT,
+      TYPE_TRANSMIT_FILE, TYPE_READ_FROM, TYPE_WRITE_TO};
 
 typedef struct {
     PyObject_HEAD
@@ -47,8 +48,21 @@ typedef struct {
     union {
         /* Buffer used for reading: TYPE_READ and TYPE_ACCEPT */
         PyObject *read_buffer;
-        /* Buffer used for writing: TYPE_WRITE */
+        /* Buffer used for writing: TYPE_WRITE and TYPE_WRITE_TO */
         Py_buffer write_buffer;
+        /* Buffer provided by the caller for reading: TYPE_READ_INTO */
+        Py_buffer user_buffer;
+        /* Buffers used for a vectored write: TYPE_WRITE_BUFFERS */
+        struct {
+            Py_buffer *buffers;
+            Py_ssize_t count;
+        } write_vector;
+        /* Buffer and source address of a datagram: TYPE_READ_FROM */
+        struct {
+            PyObject *buffer;
+            struct sockaddr_in6 address;
+            int address_length;
+        } read_from;
     };
 } OverlappedObject;
 
@@ -83,7 +97,13 @@ SetFromWindowsErr(DWORD err)
 static LPFN_ACCEPTEX Py_AcceptEx = NULL;
 static LPFN_CONNECTEX Py_ConnectEx = NULL;
 static LPFN_DISCONNECTEX Py_DisconnectEx = NULL;
+static LPFN_TRANSMITFILE Py_TransmitFile = NULL;
 static BOOL (CALLBACK *Py_CancelIoEx)(HANDLE, LPOVERLAPPED) = NULL;
+static BOOL (WINAPI *Py_GetQueuedCompletionStatusEx)(
+    HANDLE, LPOVERLAPPED_ENTRY, ULONG, PULONG, DWORD, BOOL) = NULL;
+static ULONG (WINAPI *Py_RtlNtStatusToDosError)(LONG) = NULL;
+static BOOL (WINAPI *Py_SetFileCompletionNotificationModes)(HANDLE, UCHAR) =
+    NULL;
 
 #define GET_WSA_POINTER(s, x)                                           \
     (SOCKET_ERROR != WSAIoctl(s, SIO_GET_EXTENSION_FUNCTION_POINTER,    \
@@ -96,6 +116,7 @@ initialize_function_pointers(void)
     GUID GuidAcceptEx = WSAID_ACCEPTEX;
     GUID GuidConnectEx = WSAID_CONNECTEX;
     GUID GuidDisconnectEx = WSAID_DISCONNECTEX;
+    GUID GuidTransmitFile = WSAID_TRANSMITFILE;
     HINSTANCE hKernel32;
     SOCKET s;
     DWORD dwBytes;
@@ -108,7 +129,8 @@ initialize_function_pointers(void)
 
     if (!GET_WSA_POINTER(s, AcceptEx) ||
         !GET_WSA_POINTER(s, ConnectEx) ||
-        !GET_WSA_POINTER(s, DisconnectEx))
+        !GET_WSA_POINTER(s, DisconnectEx) ||
+        !GET_WSA_POINTER(s, TransmitFile))
     {
         closesocket(s);
         SetFromWindowsErr(WSAGetLastError());
@@ -120,6 +142,13 @@ initialize_function_pointers(void)
     /* On WinXP we will have Py_CancelIoEx == NULL */
     hKernel32 = GetModuleHandle("KERNEL32");
     *(FARPROC *)&Py_CancelIoEx = GetProcAddress(hKernel32, "CancelIoEx");
+    /* On WinXP we will have Py_GetQueuedCompletionStatusEx == NULL */
+    *(FARPROC *)&Py_GetQueuedCompletionStatusEx = GetProcAddress(
+        hKernel32, "GetQueuedCompletionStatusEx");
+    *(FARPROC *)&Py_SetFileCompletionNotificationModes = GetProcAddress(
+        hKernel32, "SetFileCompletionNotificationModes");
+    *(FARPROC *)&Py_RtlNtStatusToDosError = GetProcAddress(
+        GetModuleHandle("NTDLL"), "RtlNtStatusToDosError");
     return 0;
 }
 
@@ -192,6 +221,119 @@ overlapped_GetQueuedCompletionStatus(PyObject *self, PyObject *args)
                          err, NumberOfBytes, CompletionKey, Overlapped);
 }
 
+PyDoc_STRVAR(
+    GetQueuedCompletionStatusEx_doc,
+    "GetQueuedCompletionStatusEx(port, max_entries, msecs)\n"
+    "    -> [(err, bytes, key, address), ...]\n\n"
+    "Get up to max_entries messages from completion port.  Wait for up to\n"
+    "msecs milliseconds.  Return an empty list on timeout.  On Windows\n"
+    "older than Vista, at most one message is returned per call.");
+
+static PyObject *
+overlapped_GetQueuedCompletionStatusEx(PyObject *self, PyObject *args)
+{
+    HANDLE CompletionPort = NULL;
+    ULONG MaxEntries;
+    DWORD Milliseconds;
+    OVERLAPPED_ENTRY *Entries;
+    ULONG NumEntries = 0;
+    ULONG i;
+    DWORD err;
+    BOOL ret;
+    PyObject *list, *item;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE F_DWORD F_DWORD,
+                          &CompletionPort, &MaxEntries, &Milliseconds))
+        return NULL;
+
+    if (MaxEntries == 0) {
+        PyErr_SetString(PyExc_ValueError, "max_entries must be positive");
+        return NULL;
+    }
+
+    if (Py_GetQueuedCompletionStatusEx == NULL) {
+        /* Fallback on GetQueuedCompletionStatus(): one message per call */
+        OVERLAPPED_ENTRY Entry;
+
+        memset(&Entry, 0, sizeof(Entry));
+        Py_BEGIN_ALLOW_THREADS
+        ret = GetQueuedCompletionStatus(CompletionPort,
+                                        &Entry.dwNumberOfBytesTransferred,
+                                        &Entry.lpCompletionKey,
+                                        &Entry.lpOverlapped, Milliseconds);
+        Py_END_ALLOW_THREADS
+
+        err = ret ? ERROR_SUCCESS : GetLastError();
+        if (Entry.lpOverlapped == NULL) {
+            if (err == WAIT_TIMEOUT)
+                return PyList_New(0);
+            else
+                return SetFromWindowsErr(err);
+        }
+        item = Py_BuildValue(F_DWORD F_DWORD F_ULONG_PTR F_POINTER,
+                             err, Entry.dwNumberOfBytesTransferred,
+                             Entry.lpCompletionKey, Entry.lpOverlapped);
+        if (item == NULL)
+            return NULL;
+        list = PyList_New(1);
+        if (list == NULL) {
+            Py_DECREF(item);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, 0, item);
+        return list;
+    }
+
+    Entries = PyMem_New(OVERLAPPED_ENTRY, MaxEntries);
+    if (Entries == NULL)
+        return PyErr_NoMemory();
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = Py_GetQueuedCompletionStatusEx(CompletionPort, Entries, MaxEntries,
+                                         &NumEntries, Milliseconds, FALSE);
+    Py_END_ALLOW_THREADS
+
+    if (!ret) {
+        err = GetLastError();
+        PyMem_Free(Entries);
+        if (err == WAIT_TIMEOUT)
+            return PyList_New(0);
+        return SetFromWindowsErr(err);
+    }
+
+    list = PyList_New(NumEntries);
+    if (list == NULL) {
+        PyMem_Free(Entries);
+        return NULL;
+    }
+    for (i = 0; i < NumEntries; i++) {
+        /* The Internal field of the OVERLAPPED structure holds the NTSTATUS
+           of the operation, convert it to a Windows error code.  It is
+           meaningless for packets posted by PostQueuedCompletionStatus(),
+           whose overlapped pointer can even be NULL: report no error. */
+        if (Entries[i].lpOverlapped == NULL) {
+            err = 0;
+        }
+        else {
+            err = (DWORD)Entries[i].lpOverlapped->Internal;
+            if (err != 0 && Py_RtlNtStatusToDosError != NULL)
+                err = Py_RtlNtStatusToDosError((LONG)err);
+        }
+        item = Py_BuildValue(F_DWORD F_DWORD F_ULONG_PTR F_POINTER,
+                             err, Entries[i].dwNumberOfBytesTransferred,
+                             Entries[i].lpCompletionKey,
+                             Entries[i].lpOverlapped);
+        if (item == NULL) {
+            Py_DECREF(list);
+            PyMem_Free(Entries);
+            return NULL;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    PyMem_Free(Entries);
+    return list;
+}
+
 PyDoc_STRVAR(
     PostQueuedCompletionStatus_doc,
     "PostQueuedCompletionStatus(port, bytes, key, address) -> None\n\n"
@@ -221,12 +363,45 @@ overlapped_PostQueuedCompletionStatus(PyObject *self, PyObject *args)
     Py_RETURN_NONE;
 }
 
+PyDoc_STRVAR(
+    SetFileCompletionNotificationModes_doc,
+    "SetFileCompletionNotificationModes(handle, flags) -> None\n\n"
+    "Set the completion notification modes of a file handle.\n"
+    "Raise NotImplementedError on Windows older than Vista.");
+
+static PyObject *
+overlapped_SetFileCompletionNotificationModes(PyObject *self, PyObject *args)
+{
+    HANDLE FileHandle;
+    UCHAR Flags;
+    BOOL ret;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE "b", &FileHandle, &Flags))
+        return NULL;
+
+    if (Py_SetFileCompletionNotificationModes == NULL) {
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "SetFileCompletionNotificationModes() "
+                        "requires Windows Vista or newer");
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = Py_SetFileCompletionNotificationModes(FileHandle, Flags);
+    Py_END_ALLOW_THREADS
+
+    if (!ret)
+        return SetFromWindowsErr(0);
+    Py_RETURN_NONE;
+}
+
 /*
  * Wait for a handle
  */
 
 struct PostCallbackData {
     HANDLE CompletionPort;
+    ULONG_PTR CompletionKey;
     LPOVERLAPPED Overlapped;
 };
 
@@ -236,16 +411,17 @@ PostToQueueCallback(PVOID lpParameter, BOOL TimerOrWaitFired)
     struct PostCallbackData *p = (struct PostCallbackData*) lpParameter;
 
     PostQueuedCompletionStatus(p->CompletionPort, TimerOrWaitFired,
-                               0, p->Overlapped);
+                               p->CompletionKey, p->Overlapped);
     /* ignore possible error! */
     PyMem_Free(p);
 }
 
 PyDoc_STRVAR(
     RegisterWaitWithQueue_doc,
-    "RegisterWaitWithQueue(Object, CompletionPort, Overlapped, Timeout)\n"
+    "RegisterWaitWithQueue(Object, CompletionPort, Overlapped, Timeout[, Key])\n"
     "    -> WaitHandle\n\n"
-    "Register wait for Object; when complete CompletionPort is notified.\n");
+    "Register wait for Object; when complete CompletionPort is notified.\n"
+    "The message is posted with the completion key Key (0 by default).\n");
 
 static PyObject *
 overlapped_RegisterWaitWithQueue(PyObject *self, PyObject *args)
@@ -255,11 +431,14 @@ overlapped_RegisterWaitWithQueue(PyObject *self, PyObject *args)
     ULONG Milliseconds;
     struct PostCallbackData data, *pdata;
 
-    if (!PyArg_ParseTuple(args, F_HANDLE F_HANDLE F_POINTER F_DWORD,
+    data.CompletionKey = 0;
+    if (!PyArg_ParseTuple(args, F_HANDLE F_HANDLE F_POINTER F_DWORD
+                          "|" F_ULONG_PTR,
                           &Object,
                           &data.CompletionPort,
                           &data.Overlapped,
-                          &Milliseconds))
+                          &Milliseconds,
+                          &data.CompletionKey))
         return NULL;
 
     pdata = PyMem_Malloc(sizeof(struct PostCallbackData));
@@ -549,6 +728,44 @@ Overlapped_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
     return (PyObject *)self;
 }
 
+static void
+Overlapped_release_write_vector(OverlappedObject *self)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < self->write_vector.count; i++)
+        PyBuffer_Release(&self->write_vector.buffers[i]);
+    PyMem_Free(self->write_vector.buffers);
+    self->write_vector.buffers = NULL;
+    self->write_vector.count = 0;
+}
+
+static void
+Overlapped_clear_buffers(OverlappedObject *self)
+{
+    switch (self->type) {
+    case TYPE_READ:
+    case TYPE_ACCEPT:
+        Py_CLEAR(self->read_buffer);
+        break;
+    case TYPE_WRITE:
+    case TYPE_WRITE_TO:
+        if (self->write_buffer.obj)
+            PyBuffer_Release(&self->write_buffer);
+        break;
+    case TYPE_READ_FROM:
+        Py_CLEAR(self->read_from.buffer);
+        break;
+    case TYPE_READ_INTO:
+        if (self->user_buffer.obj)
+            PyBuffer_Release(&self->user_buffer);
+        break;
+    case TYPE_WRITE_BUFFERS:
+        Overlapped_release_write_vector(self);
+        break;
+    }
+}
+
 static void
 Overlapped_dealloc(OverlappedObject *self)
 {
@@ -585,16 +802,7 @@ Overlapped_dealloc(OverlappedObject *self)
     if (self->overlapped.hEvent != NULL)
         CloseHandle(self->overlapped.hEvent);
 
-    switch (self->type) {
-    case TYPE_READ:
-    case TYPE_ACCEPT:
-        Py_CLEAR(self->read_buffer);
-        break;
-    case TYPE_WRITE:
-        if (self->write_buffer.obj)
-            PyBuffer_Release(&self->write_buffer);
-        break;
-    }
+    Overlapped_clear_buffers(self);
     PyObject_Del(self);
     SetLastError(olderr);
 }
@@ -628,6 +836,82 @@ Overlapped_cancel(OverlappedObject *self)
     Py_RETURN_NONE;
 }
 
+PyDoc_STRVAR(
+    Overlapped_reset_doc,
+    "reset() -> None\n\n"
+    "Release the buffers of a completed operation so that the overlapped\n"
+    "object can be reused for a new operation.  The event handle, if any,\n"
+    "is kept and reset to the non-signaled state.");
+
+static PyObject *
+Overlapped_reset(OverlappedObject *self)
+{
+    HANDLE event = self->overlapped.hEvent;
+
+    if (self->type != TYPE_NONE && self->type != TYPE_NOT_STARTED &&
+        !HasOverlappedIoCompleted(&self->overlapped))
+    {
+        PyErr_SetString(PyExc_ValueError, "operation still pending");
+        return NULL;
+    }
+
+    if (event != NULL && !ResetEvent(event))
+        return SetFromWindowsErr(0);
+
+    Overlapped_clear_buffers(self);
+    self->handle = NULL;
+    self->error = 0;
+    self->type = TYPE_NONE;
+    memset(&self->overlapped, 0, sizeof(OVERLAPPED));
+    memset(&self->write_buffer, 0, sizeof(Py_buffer));
+    self->overlapped.hEvent = event;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+unparse_address(SOCKADDR *Address, int Length)
+{
+    char Host[INET6_ADDRSTRLEN];
+
+    switch (Address->sa_family) {
+        case AF_INET: {
+            SOCKADDR_IN *a = (SOCKADDR_IN *)Address;
+            if (inet_ntop(AF_INET, &a->sin_addr, Host, sizeof(Host)) == NULL)
+                return SetFromWindowsErr(WSAGetLastError());
+            return Py_BuildValue("sH", Host, ntohs(a->sin_port));
+        }
+        case AF_INET6: {
+            SOCKADDR_IN6 *a = (SOCKADDR_IN6 *)Address;
+            if (inet_ntop(AF_INET6, &a->sin6_addr, Host, sizeof(Host)) == NULL)
+                return SetFromWindowsErr(WSAGetLastError());
+            return Py_BuildValue("sHkk", Host, ntohs(a->sin6_port),
+                                 ntohl(a->sin6_flowinfo), a->sin6_scope_id);
+        }
+        default:
+            PyErr_Format(PyExc_ValueError, "unsupported address family %d",
+                         Address->sa_family);
+            return NULL;
+    }
+}
+
+static PyObject *
+Overlapped_datagram(OverlappedObject *self, DWORD transferred)
+{
+    PyObject *addr, *result;
+
+    assert(PyBytes_CheckExact(self->read_from.buffer));
+    if (transferred != PyBytes_GET_SIZE(self->read_from.buffer) &&
+        _PyBytes_Resize(&self->read_from.buffer, transferred))
+        return NULL;
+    addr = unparse_address((SOCKADDR *)&self->read_from.address,
+                           self->read_from.address_length);
+    if (addr == NULL)
+        return NULL;
+    result = PyTuple_Pack(2, self->read_from.buffer, addr);
+    Py_DECREF(addr);
+    return result;
+}
+
 PyDoc_STRVAR(
     Overlapped_getresult_doc,
     "getresult(wait=False) -> result\n\n"
@@ -669,6 +953,8 @@ Overlapped_getresult(OverlappedObject *self, PyObject *args)
         case ERROR_BROKEN_PIPE:
             if ((self->type == TYPE_READ || self->type == TYPE_ACCEPT) && self->read_buffer != NULL)
                 break;
+            if (self->type == TYPE_READ_INTO && self->user_buffer.obj != NULL)
+                break;
             /* fall through */
         default:
             return SetFromWindowsErr(err);
@@ -682,6 +968,8 @@ Overlapped_getresult(OverlappedObject *self, PyObject *args)
                 return NULL;
             Py_INCREF(self->read_buffer);
             return self->read_buffer;
+        case TYPE_READ_FROM:
+            return Overlapped_datagram(self, transferred);
         default:
             return PyLong_FromUnsignedLong((unsigned long) transferred);
     }
@@ -800,6 +1088,126 @@ Overlapped_WSARecv(OverlappedObject *self, PyObject *args)
     }
 }
 
+PyDoc_STRVAR(
+    Overlapped_ReadFileInto_doc,
+    "ReadFileInto(handle, buf) -> Overlapped[bytes_transferred]\n\n"
+    "Start overlapped read into the writable buffer buf");
+
+static PyObject *
+Overlapped_ReadFileInto(OverlappedObject *self, PyObject *args)
+{
+    HANDLE handle;
+    PyObject *bufobj;
+    DWORD nread;
+    BOOL ret;
+    DWORD err;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE "O", &handle, &bufobj))
+        return NULL;
+
+    if (self->type != TYPE_NONE) {
+        PyErr_SetString(PyExc_ValueError, "operation already attempted");
+        return NULL;
+    }
+
+    if (!PyArg_Parse(bufobj, "w*", &self->user_buffer))
+        return NULL;
+
+#if SIZEOF_SIZE_T > SIZEOF_LONG
+    if (self->user_buffer.len > (Py_ssize_t)ULONG_MAX) {
+        PyBuffer_Release(&self->user_buffer);
+        PyErr_SetString(PyExc_ValueError, "buffer to large");
+        return NULL;
+    }
+#endif
+
+    self->type = TYPE_READ_INTO;
+    self->handle = handle;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = ReadFile(handle, self->user_buffer.buf,
+                   (DWORD)self->user_buffer.len,
+                   &nread, &self->overlapped);
+    Py_END_ALLOW_THREADS
+
+    self->error = err = ret ? ERROR_SUCCESS : GetLastError();
+    switch (err) {
+        case ERROR_BROKEN_PIPE:
+            mark_as_completed(&self->overlapped);
+            return SetFromWindowsErr(err);
+        case ERROR_SUCCESS:
+        case ERROR_MORE_DATA:
+        case ERROR_IO_PENDING:
+            Py_RETURN_NONE;
+        default:
+            PyBuffer_Release(&self->user_buffer);
+            self->type = TYPE_NOT_STARTED;
+            return SetFromWindowsErr(err);
+    }
+}
+
+PyDoc_STRVAR(
+    Overlapped_WSARecvInto_doc,
+    "WSARecvInto(handle, buf, flags) -> Overlapped[bytes_transferred]\n\n"
+    "Start overlapped receive into the writable buffer buf");
+
+static PyObject *
+Overlapped_WSARecvInto(OverlappedObject *self, PyObject *args)
+{
+    HANDLE handle;
+    PyObject *bufobj;
+    DWORD flags = 0;
+    DWORD nread;
+    WSABUF wsabuf;
+    int ret;
+    DWORD err;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE "O|" F_DWORD,
+                          &handle, &bufobj, &flags))
+        return NULL;
+
+    if (self->type != TYPE_NONE) {
+        PyErr_SetString(PyExc_ValueError, "operation already attempted");
+        return NULL;
+    }
+
+    if (!PyArg_Parse(bufobj, "w*", &self->user_buffer))
+        return NULL;
+
+#if SIZEOF_SIZE_T > SIZEOF_LONG
+    if (self->user_buffer.len > (Py_ssize_t)ULONG_MAX) {
+        PyBuffer_Release(&self->user_buffer);
+        PyErr_SetString(PyExc_ValueError, "buffer to large");
+        return NULL;
+    }
+#endif
+
+    self->type = TYPE_READ_INTO;
+    self->handle = handle;
+    wsabuf.len = (DWORD)self->user_buffer.len;
+    wsabuf.buf = self->user_buffer.buf;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = WSARecv((SOCKET)handle, &wsabuf, 1, &nread, &flags,
+                  &self->overlapped, NULL);
+    Py_END_ALLOW_THREADS
+
+    self->error = err = (ret < 0 ? WSAGetLastError() : ERROR_SUCCESS);
+    switch (err) {
+        case ERROR_BROKEN_PIPE:
+            mark_as_completed(&self->overlapped);
+            return SetFromWindowsErr(err);
+        case ERROR_SUCCESS:
+        case ERROR_MORE_DATA:
+        case ERROR_IO_PENDING:
+            Py_RETURN_NONE;
+        default:
+            PyBuffer_Release(&self->user_buffer);
+            self->type = TYPE_NOT_STARTED;
+            return SetFromWindowsErr(err);
+    }
+}
+
 PyDoc_STRVAR(
     Overlapped_WriteFile_doc,
     "WriteFile(handle, buf) -> Overlapped[bytes_transferred]\n\n"
@@ -910,6 +1318,100 @@ Overlapped_WSASend(OverlappedObject *self, PyObject *args)
     }
 }
 
+PyDoc_STRVAR(
+    Overlapped_WSASendBuffers_doc,
+    "WSASendBuffers(handle, buffers, flags) -> Overlapped[bytes_transferred]\n\n"
+    "Start overlapped send of a sequence of buffers");
+
+static PyObject *
+Overlapped_WSASendBuffers(OverlappedObject *self, PyObject *args)
+{
+    HANDLE handle;
+    PyObject *bufseq;
+    PyObject *seq;
+    DWORD flags;
+    DWORD written;
+    WSABUF *wsabufs;
+    Py_buffer *view;
+    Py_ssize_t i, count;
+    int ret;
+    DWORD err;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE "O" F_DWORD,
+                          &handle, &bufseq, &flags))
+        return NULL;
+
+    if (self->type != TYPE_NONE) {
+        PyErr_SetString(PyExc_ValueError, "operation already attempted");
+        return NULL;
+    }
+
+    seq = PySequence_Fast(bufseq, "buffers must be a sequence");
+    if (seq == NULL)
+        return NULL;
+
+    count = PySequence_Fast_GET_SIZE(seq);
+#if SIZEOF_SIZE_T > SIZEOF_LONG
+    if (count > (Py_ssize_t)ULONG_MAX) {
+        Py_DECREF(seq);
+        PyErr_SetString(PyExc_ValueError, "too many buffers");
+        return NULL;
+    }
+#endif
+
+    wsabufs = PyMem_New(WSABUF, count);
+    self->write_vector.buffers = PyMem_New(Py_buffer, count);
+    self->write_vector.count = 0;
+    if (wsabufs == NULL || self->write_vector.buffers == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < count; i++) {
+        view = &self->write_vector.buffers[i];
+        if (!PyArg_Parse(PySequence_Fast_GET_ITEM(seq, i), "y*", view))
+            goto error;
+        self->write_vector.count++;
+#if SIZEOF_SIZE_T > SIZEOF_LONG
+        if (view->len > (Py_ssize_t)ULONG_MAX) {
+            PyErr_SetString(PyExc_ValueError, "buffer to large");
+            goto error;
+        }
+#endif
+        wsabufs[i].len = (DWORD)view->len;
+        wsabufs[i].buf = view->buf;
+    }
+    Py_DECREF(seq);
+
+    self->type = TYPE_WRITE_BUFFERS;
+    self->handle = handle;
+
+    /* WSASend() captures the WSABUF array before returning, only the
+       buffers themselves must stay alive until the operation completes */
+    Py_BEGIN_ALLOW_THREADS
+    ret = WSASend((SOCKET)handle, wsabufs, (DWORD)count, &written, flags,
+                  &self->overlapped, NULL);
+    Py_END_ALLOW_THREADS
+    PyMem_Free(wsabufs);
+
+    self->error = err = (ret < 0 ? WSAGetLastError() : ERROR_SUCCESS);
+    switch (err) {
+        case ERROR_SUCCESS:
+        case ERROR_IO_PENDING:
+            Py_RETURN_NONE;
+        default:
+            Overlapped_release_write_vector(self);
+            self->type = TYPE_NOT_STARTED;
+            return SetFromWindowsErr(err);
+    }
+
+error:
+    Overlapped_release_write_vector(self);
+    PyMem_Free(wsabufs);
+    Py_DECREF(seq);
+    return NULL;
+}
+
 PyDoc_STRVAR(
     Overlapped_AcceptEx_doc,
     "AcceptEx(listen_handle, accept_handle) -> Overlapped[address_as_bytes]\n\n"
@@ -1050,7 +1552,8 @@ Overlapped_ConnectEx(OverlappedObject *self, PyObject *args)
 PyDoc_STRVAR(
     Overlapped_DisconnectEx_doc,
     "DisconnectEx(handle, flags) -> Overlapped[None]\n\n"
-    "Start overlapped connect.  client_handle should be unbound.");
+    "Start overlapped disconnect.  With TF_REUSE_SOCKET, the socket can\n"
+    "then be reused by AcceptEx() or ConnectEx().");
 
 static PyObject *
 Overlapped_DisconnectEx(OverlappedObject *self, PyObject *args)
@@ -1086,6 +1589,188 @@ Overlapped_DisconnectEx(OverlappedObject *self, PyObject *args)
     }
 }
 
+PyDoc_STRVAR(
+    Overlapped_TransmitFile_doc,
+    "TransmitFile(socket, file, offset, offset_high, count_to_write,\n"
+    "             count_per_send, flags) -> Overlapped[int]\n\n"
+    "Start overlapped transmission of count_to_write bytes of file, from\n"
+    "the 64-bit position (offset_high << 32) | offset, without copying the\n"
+    "data in user space.  file is a file handle.");
+
+static PyObject *
+Overlapped_TransmitFile(OverlappedObject *self, PyObject *args)
+{
+    SOCKET Socket;
+    HANDLE File;
+    DWORD offset;
+    DWORD offset_high;
+    DWORD count_to_write;
+    DWORD count_per_send;
+    DWORD flags;
+    BOOL ret;
+    DWORD err;
+
+    if (!PyArg_ParseTuple(args,
+                          F_HANDLE F_HANDLE F_DWORD F_DWORD
+                          F_DWORD F_DWORD F_DWORD,
+                          &Socket, &File, &offset, &offset_high,
+                          &count_to_write, &count_per_send, &flags))
+        return NULL;
+
+    if (self->type != TYPE_NONE) {
+        PyErr_SetString(PyExc_ValueError, "operation already attempted");
+        return NULL;
+    }
+
+    self->type = TYPE_TRANSMIT_FILE;
+    self->handle = (HANDLE)Socket;
+    self->overlapped.Offset = offset;
+    self->overlapped.OffsetHigh = offset_high;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = Py_TransmitFile(Socket, File, count_to_write, count_per_send,
+                          &self->overlapped, NULL, flags);
+    Py_END_ALLOW_THREADS
+
+    self->error = err = ret ? ERROR_SUCCESS : WSAGetLastError();
+    switch (err) {
+        case ERROR_SUCCESS:
+        case ERROR_IO_PENDING:
+            Py_RETURN_NONE;
+        default:
+            self->type = TYPE_NOT_STARTED;
+            return SetFromWindowsErr(err);
+    }
+}
+
+PyDoc_STRVAR(
+    Overlapped_WSARecvFrom_doc,
+    "WSARecvFrom(handle, size, flags) -> Overlapped[(message, address)]\n\n"
+    "Start overlapped receive of a datagram");
+
+static PyObject *
+Overlapped_WSARecvFrom(OverlappedObject *self, PyObject *args)
+{
+    HANDLE handle;
+    DWORD size;
+    DWORD flags = 0;
+    DWORD nread;
+    PyObject *buf;
+    WSABUF wsabuf;
+    int ret;
+    DWORD err;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE F_DWORD "|" F_DWORD,
+                          &handle, &size, &flags))
+        return NULL;
+
+    if (self->type != TYPE_NONE) {
+        PyErr_SetString(PyExc_ValueError, "operation already attempted");
+        return NULL;
+    }
+
+#if SIZEOF_SIZE_T <= SIZEOF_LONG
+    size = Py_MIN(size, (DWORD)PY_SSIZE_T_MAX);
+#endif
+    buf = PyBytes_FromStringAndSize(NULL, Py_MAX(size, 1));
+    if (buf == NULL)
+        return NULL;
+
+    self->type = TYPE_READ_FROM;
+    self->handle = handle;
+    self->read_from.buffer = buf;
+    memset(&self->read_from.address, 0, sizeof(self->read_from.address));
+    self->read_from.address_length = sizeof(self->read_from.address);
+    wsabuf.len = size;
+    wsabuf.buf = PyBytes_AS_STRING(buf);
+
+    /* The address is written when the operation completes: it is stored in
+       the overlapped object which outlives the operation */
+    Py_BEGIN_ALLOW_THREADS
+    ret = WSARecvFrom((SOCKET)handle, &wsabuf, 1, &nread, &flags,
+                      (SOCKADDR *)&self->read_from.address,
+                      &self->read_from.address_length,
+                      &self->overlapped, NULL);
+    Py_END_ALLOW_THREADS
+
+    self->error = err = (ret < 0 ? WSAGetLastError() : ERROR_SUCCESS);
+    switch (err) {
+        case ERROR_SUCCESS:
+        case ERROR_MORE_DATA:
+        case ERROR_IO_PENDING:
+            Py_RETURN_NONE;
+        default:
+            self->type = TYPE_NOT_STARTED;
+            return SetFromWindowsErr(err);
+    }
+}
+
+PyDoc_STRVAR(
+    Overlapped_WSASendTo_doc,
+    "WSASendTo(handle, buf, flags, address) -> Overlapped[bytes_transferred]\n\n"
+    "Start overlapped send of a datagram to address");
+
+static PyObject *
+Overlapped_WSASendTo(OverlappedObject *self, PyObject *args)
+{
+    HANDLE handle;
+    PyObject *bufobj;
+    DWORD flags;
+    PyObject *AddressObj;
+    char AddressBuf[sizeof(struct sockaddr_in6)];
+    SOCKADDR *Address = (SOCKADDR*)AddressBuf;
+    int Length;
+    DWORD written;
+    WSABUF wsabuf;
+    int ret;
+    DWORD err;
+
+    if (!PyArg_ParseTuple(args, F_HANDLE "O" F_DWORD "O",
+                          &handle, &bufobj, &flags, &AddressObj))
+        return NULL;
+
+    if (self->type != TYPE_NONE) {
+        PyErr_SetString(PyExc_ValueError, "operation already attempted");
+        return NULL;
+    }
+
+    Length = sizeof(AddressBuf);
+    Length = parse_address(AddressObj, Address, Length);
+    if (Length < 0)
+        return NULL;
+
+    if (!PyArg_Parse(bufobj, "y*", &self->write_buffer))
+        return NULL;
+
+#if SIZEOF_SIZE_T > SIZEOF_LONG
+    if (self->write_buffer.len > (Py_ssize_t)ULONG_MAX) {
+        PyBuffer_Release(&self->write_buffer);
+        PyErr_SetString(PyExc_ValueError, "buffer to large");
+        return NULL;
+    }
+#endif
+
+    self->type = TYPE_WRITE_TO;
+    self->handle = handle;
+    wsabuf.len = (DWORD)self->write_buffer.len;
+    wsabuf.buf = self->write_buffer.buf;
+
+    Py_BEGIN_ALLOW_THREADS
+    ret = WSASendTo((SOCKET)handle, &wsabuf, 1, &written, flags,
+                    Address, Length, &self->overlapped, NULL);
+    Py_END_ALLOW_THREADS
+
+    self->error = err = (ret < 0 ? WSAGetLastError() : ERROR_SUCCESS);
+    switch (err) {
+        case ERROR_SUCCESS:
+        case ERROR_IO_PENDING:
+            Py_RETURN_NONE;
+        default:
+            self->type = TYPE_NOT_STARTED;
+            return SetFromWindowsErr(err);
+    }
+}
+
 PyDoc_STRVAR(
     Overlapped_ConnectNamedPipe_doc,
     "ConnectNamedPipe(handle) -> Overlapped[None]\n\n"
@@ -1177,20 +1862,34 @@ static PyMethodDef Overlapped_methods[] = {
      METH_VARARGS, Overlapped_getresult_doc},
     {"cancel", (PyCFunction) Overlapped_cancel,
      METH_NOARGS, Overlapped_cancel_doc},
+    {"reset", (PyCFunction) Overlapped_reset,
+     METH_NOARGS, Overlapped_reset_doc},
     {"ReadFile", (PyCFunction) Overlapped_ReadFile,
      METH_VARARGS, Overlapped_ReadFile_doc},
     {"WSARecv", (PyCFunction) Overlapped_WSARecv,
      METH_VARARGS, Overlapped_WSARecv_doc},
+    {"ReadFileInto", (PyCFunction) Overlapped_ReadFileInto,
+     METH_VARARGS, Overlapped_ReadFileInto_doc},
+    {"WSARecvInto", (PyCFunction) Overlapped_WSARecvInto,
+     METH_VARARGS, Overlapped_WSARecvInto_doc},
     {"WriteFile", (PyCFunction) Overlapped_WriteFile,
      METH_VARARGS, Overlapped_WriteFile_doc},
     {"WSASend", (PyCFunction) Overlapped_WSASend,
      METH_VARARGS, Overlapped_WSASend_doc},
+    {"WSASendBuffers", (PyCFunction) Overlapped_WSASendBuffers,
+     METH_VARARGS, Overlapped_WSASendBuffers_doc},
     {"AcceptEx", (PyCFunction) Overlapped_AcceptEx,
      METH_VARARGS, Overlapped_AcceptEx_doc},
     {"ConnectEx", (PyCFunction) Overlapped_ConnectEx,
      METH_VARARGS, Overlapped_ConnectEx_doc},
     {"DisconnectEx", (PyCFunction) Overlapped_DisconnectEx,
      METH_VARARGS, Overlapped_DisconnectEx_doc},
+    {"TransmitFile", (PyCFunction) Overlapped_TransmitFile,
+     METH_VARARGS, Overlapped_TransmitFile_doc},
+    {"WSARecvFrom", (PyCFunction) Overlapped_WSARecvFrom,
+     METH_VARARGS, Overlapped_WSARecvFrom_doc},
+    {"WSASendTo", (PyCFunction) Overlapped_WSASendTo,
+     METH_VARARGS, Overlapped_WSASendTo_doc},
     {"ConnectNamedPipe", (PyCFunction) Overlapped_ConnectNamedPipe,
      METH_VARARGS, Overlapped_ConnectNamedPipe_doc},
     {NULL}
@@ -1260,8 +1959,13 @@ static PyMethodDef overlapped_functions[] = {
      METH_VARARGS, CreateIoCompletionPort_doc},
     {"GetQueuedCompletionStatus", overlapped_GetQueuedCompletionStatus,
      METH_VARARGS, GetQueuedCompletionStatus_doc},
+    {"GetQueuedCompletionStatusEx", overlapped_GetQueuedCompletionStatusEx,
+     METH_VARARGS, GetQueuedCompletionStatusEx_doc},
     {"PostQueuedCompletionStatus", overlapped_PostQueuedCompletionStatus,
      METH_VARARGS, PostQueuedCompletionStatus_doc},
+    {"SetFileCompletionNotificationModes",
+     overlapped_SetFileCompletionNotificationModes,
+     METH_VARARGS, SetFileCompletionNotificationModes_doc},
     {"FormatMessage", overlapped_FormatMessage,
      METH_VARARGS, FormatMessage_doc},
     {"BindLocal", overlapped_BindLocal,
@@ -1296,6 +2000,8 @@ static struct PyModuleDef overlapped_module = {
     NULL
 };
 
+#define SIZEOF_WSAPROTOCOL_INFOW ((DWORD)sizeof(WSAPROTOCOL_INFOW))
+
 #define WINAPI_CONSTANT(fmt, con) \
     PyDict_SetItemString(d, #con, Py_BuildValue(fmt, con))
 
@@ -1332,6 +2038,17 @@ PyInit__overlapped(void)
     WINAPI_CONSTANT(F_DWORD,  SO_UPDATE_ACCEPT_CONTEXT);
     WINAPI_CONSTANT(F_DWORD,  SO_UPDATE_CONNECT_CONTEXT);
     WINAPI_CONSTANT(F_DWORD,  TF_REUSE_SOCKET);
+    WINAPI_CONSTANT(F_DWORD,  FILE_SKIP_COMPLETION_PORT_ON_SUCCESS);
+    WINAPI_CONSTANT(F_DWORD,  SO_PROTOCOL_INFOW);
+    WINAPI_CONSTANT(F_DWORD,  XP1_IFS_HANDLES);
+    WINAPI_CONSTANT(F_DWORD,  SIZEOF_WSAPROTOCOL_INFOW);
+
+    /* Without GetQueuedCompletionStatusEx() (Windows XP), the binding
+       dequeues a single event per call */
+    if (PyModule_AddObject(m, "HAVE_GET_QUEUED_COMPLETION_STATUS_EX",
+                           PyBool_FromLong(
+                               Py_GetQueuedCompletionStatusEx != NULL)) < 0)
+        return NULL;
 
     return m;
 }
@@ -0,0 +1,488 @@
+#!/usr/bin/env python3
+"""Run asyncio benchmarks.
+
+Usage:
+  python3 runbenchmarks.py [flags] [pattern] ...
+
+Each scenario runs once per event loop and per repetition.  Patterns are
+regular expressions matched against the scenario names, e.g. 'tcp' runs
+tcp_echo only.  The list of scenarios and loops is printed by --list.
+
+The workload of each scenario is fixed (number of callbacks, requests,
+bytes, etc.), it can be multiplied with --scale.  The random generator
+is seeded, so runs differ only by the timing of the machine.
+
+The results are written as JSON with --output: one entry per loop and
+scenario, with the metrics of each run and their median.  Compare two
+files with --compare to catch regressions between releases.
+"""
+
+import argparse
+import collections
+import gc
+import json
+import os
+import platform
+import random
+import re
+import socket
+import sys
+import time
+
+import asyncio
+from asyncio import selectors
+try:
+    import ssl
+except ImportError:  # pragma: no cover
+    ssl = None
+
+assert sys.version >= '3.3', 'Please use Python 3.3 or higher.'
+
+ARGS = argparse.ArgumentParser(description="Run asyncio benchmarks.")
+ARGS.add_argument(
+    '-l', '--loop', action='append', dest='loops', metavar='LOOP',
+    help='event loop to benchmark, can be repeated '
+         '(default: selector and proactor, when available)')
+ARGS.add_argument(
+    '-n', '--repeat', action='store', dest='repeat', type=int, default=3,
+    help='number of runs of each scenario (default: 3)')
+ARGS.add_argument(
+    '-s', '--scale', action='store', dest='scale', type=float, default=1.0,
+    help='multiply the workload of each scenario (default: 1.0)')
+ARGS.add_argument(
+    '--seed', action='store', dest='seed', type=int, default=0,
+    help='seed of the random generator (default: 0)')
+ARGS.add_argument(
+    '-o', '--output', action='store', dest='output',
+    help='write the results as JSON into this file, "-" for stdout')
+ARGS.add_argument(
+    '--compare', action='store', dest='compare', metavar='FILE',
+    help='compare the results with a previous JSON output')
+ARGS.add_argument(
+    '--list', action='store_true', dest='list',
+    help='list the scenarios and the available loops')
+ARGS.add_argument(
+    '-q', action='store_true', dest='quiet', help='quiet')
+ARGS.add_argument(
+    'pattern', action='store', nargs='*',
+    help='optional regex patterns to match scenario names (default all)')
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CERTFILE = os.path.join(HERE, 'tests', 'ssl_cert.pem')
+KEYFILE = os.path.join(HERE, 'tests', 'ssl_key.pem')
+
+
+class SkipScenario(Exception):
+    """The scenario cannot run with this loop or on this platform."""
+
+
+def _selector_loop(name):
+    def factory():
+        return asyncio.SelectorEventLoop(getattr(selectors, name)())
+    return factory
+
+
+def available_loops():
+    # Return an ordered dictionary: name => event loop factory
+    loops = collections.OrderedDict()
+    loops['selector'] = asyncio.SelectorEventLoop
+    if hasattr(asyncio, 'ProactorEventLoop'):
+        loops['proactor'] = asyncio.ProactorEventLoop
+    for name, cls in (('select', 'SelectSelector'),
+                      ('poll', 'PollSelector'),
+                      ('epoll', 'EpollSelector'),
+                      ('batched_epoll', 'BatchedEpollSelector'),
+                      ('devpoll', 'DevpollSelector'),
+                      ('kqueue', 'KqueueSelector')):
+        if hasattr(selectors, cls):
+            loops[name] = _selector_loop(cls)
+    return loops
+
+
+def percentile(sorted_values, percent):
+    # Nearest-rank percentile of a sorted list
+    index = max(0, int(round(percent / 100.0 * len(sorted_values))) - 1)
+    return sorted_values[index]
+
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    if len(values) % 2:
+        return values[middle]
+    return (values[middle - 1] + values[middle]) / 2.0
+
+
+def ssl_contexts():
+    if ssl is None or not hasattr(ssl, 'SSLContext'):
+        raise SkipScenario('need the ssl module')
+    if not (os.path.exists(CERTFILE) and os.path.exists(KEYFILE)):
+        raise SkipScenario('need %s and %s' % (CERTFILE, KEYFILE))
+    server_context = ssl.SSLContext(ssl.PROTOCOL_SSLv23)
+    try:
+        # the sample key of the tests is too small for the default security
+        # level of OpenSSL 1.1
+        server_context.set_ciphers('DEFAULT@SECLEVEL=1')
+    except ssl.SSLError:
+        # OpenSSL older than 1.1 doesn't know security levels
+        pass
+    try:
+        server_context.load_cert_chain(CERTFILE, KEYFILE)
+    except ssl.SSLError as exc:
+        raise SkipScenario('cannot load %s: %s' % (CERTFILE, exc))
+    client_context = ssl.SSLContext(ssl.PROTOCOL_SSLv23)
+    client_context.verify_mode = ssl.CERT_NONE
+    return server_context, client_context
+
+
+class EchoProtocol(asyncio.Protocol):
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def data_received(self, data):
+        self.transport.write(data)
+
+
+class SinkProtocol(asyncio.Protocol):
+    # Count the received bytes, set done once total bytes are received
+
+    def __init__(self, total, done):
+        self.total = total
+        self.done = done
+        self.received = 0
+
+    def data_received(self, data):
+        self.received += len(data)
+        if self.received >= self.total and not self.done.done():
+            self.done.set_result(self.received)
+
+
+# Scenarios: each scenario takes (loop, scale, rng) and returns a dictionary
+# of metrics.  The higher the better, except for the latencies ('_ms').
+
+def bench_call_soon(loop, scale, rng):
+    """Callbacks scheduled with call_soon(), 10 chains run concurrently."""
+    total = int(200000 * scale)
+    nchain = 10
+    state = {'count': 0}
+    done = asyncio.Future(loop=loop)
+
+    def callback():
+        state['count'] += 1
+        if state['count'] < total:
+            loop.call_soon(callback)
+        elif not done.done():
+            done.set_result(None)
+
+    t0 = time.perf_counter()
+    for i in range(nchain):
+        loop.call_soon(callback)
+    loop.run_until_complete(done)
+    dt = time.perf_counter() - t0
+    return {'calls_per_sec': state['count'] / dt}
+
+
+def bench_timer_churn(loop, scale, rng):
+    """Timers scheduled with call_later(), half of them are cancelled."""
+    total = int(50000 * scale)
+    state = {'fired': 0}
+    done = asyncio.Future(loop=loop)
+    expected = total - total // 2
+
+    def callback():
+        state['fired'] += 1
+        if state['fired'] == expected:
+            done.set_result(None)
+
+    t0 = time.perf_counter()
+    handles = [loop.call_later(rng.random() * 0.05, callback)
+               for i in range(total)]
+    rng.shuffle(handles)
+    for handle in handles[:total // 2]:
+        handle.cancel()
+    del handles
+    loop.run_until_complete(done)
+    dt = time.perf_counter() - t0
+    return {'timers_per_sec': total / dt}
+
+
+def bench_tcp_echo(loop, scale, rng):
+    """Request/response of 100 bytes over 10 concurrent TCP connections."""
+    nclient = 10
+    nrequest = int(2000 * scale)
+    payload = b'x' * 100
+    latencies = []
+
+    server = loop.run_until_complete(
+        loop.create_server(EchoProtocol, '127.0.0.1', 0))
+    port = server.sockets[0].getsockname()[1]
+
+    @asyncio.coroutine
+    def client():
+        reader, writer = yield from asyncio.open_connection(
+            '127.0.0.1', port, loop=loop)
+        sock = writer.get_extra_info('socket')
+        sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        try:
+            for i in range(nrequest):
+                t0 = time.perf_counter()
+                writer.write(payload)
+                yield from reader.readexactly(len(payload))
+                latencies.append(time.perf_counter() - t0)
+        finally:
+            writer.close()
+
+    try:
+        t0 = time.perf_counter()
+        loop.run_until_complete(asyncio.gather(
+            *[client() for i in range(nclient)], loop=loop))
+        dt = time.perf_counter() - t0
+    finally:
+        server.close()
+        loop.run_until_complete(server.wait_closed())
+    latencies.sort()
+    return {'requests_per_sec': len(latencies) / dt,
+            'latency_p50_ms': percentile(latencies, 50) * 1e3,
+            'latency_p90_ms': percentile(latencies, 90) * 1e3,
+            'latency_p99_ms': percentile(latencies, 99) * 1e3}
+
+
+def _stream_bulk(loop, scale, server_context=None, client_context=None):
+    total = int(64 * 1024 * 1024 * scale)
+    chunk = b'x' * (64 * 1024)
+    done = asyncio.Future(loop=loop)
+
+    server = loop.run_until_complete(
+        loop.create_server(lambda: SinkProtocol(total, done),
+                           '127.0.0.1', 0, ssl=server_context))
+    port = server.sockets[0].getsockname()[1]
+
+    @asyncio.coroutine
+    def client():
+        kwds = {}
+        if client_context is not None:
+            kwds['server_hostname'] = ''
+        reader, writer = yield from asyncio.open_connection(
+            '127.0.0.1', port, ssl=client_context, loop=loop, **kwds)
+        try:
+            sent = 0
+            while sent < total:
+                writer.write(chunk)
+                sent += len(chunk)
+                yield from writer.drain()
+            yield from done
+        finally:
+            writer.close()
+
+    try:
+        t0 = time.perf_counter()
+        loop.run_until_complete(client())
+        dt = time.perf_counter() - t0
+    finally:
+        server.close()
+        loop.run_until_complete(server.wait_closed())
+    return {'mb_per_sec': done.result() / dt / (1024 * 1024)}
+
+
+def bench_stream_bulk(loop, scale, rng):
+    """Bulk transfer of 64 MiB with StreamWriter.write() and drain()."""
+    return _stream_bulk(loop, scale)
+
+
+def bench_tls_handshake(loop, scale, rng):
+    """Sequential TLS connections, closed once the handshake completes."""
+    server_context, client_context = ssl_contexts()
+    total = int(100 * scale)
+
+    server = loop.run_until_complete(
+        loop.create_server(asyncio.Protocol, '127.0.0.1', 0,
+                           ssl=server_context))
+    port = server.sockets[0].getsockname()[1]
+
+    @asyncio.coroutine
+    def connect():
+        for i in range(total):
+            transport, protocol = yield from loop.create_connection(
+                asyncio.Protocol, '127.0.0.1', port,
+                ssl=client_context, server_hostname='')
+            transport.close()
+
+    try:
+        t0 = time.perf_counter()
+        loop.run_until_complete(connect())
+        dt = time.perf_counter() - t0
+    finally:
+        server.close()
+        loop.run_until_complete(server.wait_closed())
+    return {'handshakes_per_sec': total / dt}
+
+
+def bench_tls_bulk(loop, scale, rng):
+    """Bulk transfer of 64 MiB over TLS."""
+    server_context, client_context = ssl_contexts()
+    return _stream_bulk(loop, scale, server_context, client_context)
+
+
+def bench_subprocess_spawn(loop, scale, rng):
+    """Sequential child processes running an empty Python program."""
+    total = int(20 * scale)
+
+    @asyncio.coroutine
+    def spawn():
+        for i in range(total):
+            proc = yield from asyncio.create_subprocess_exec(
+                sys.executable, '-S', '-c', 'pass', loop=loop)
+            yield from proc.wait()
+
+    t0 = time.perf_counter()
+    try:
+        loop.run_until_complete(spawn())
+    except NotImplementedError:
+        raise SkipScenario('subprocesses are not supported by the loop')
+    dt = time.perf_counter() - t0
+    return {'spawns_per_sec': total / dt}
+
+
+SCENARIOS = collections.OrderedDict(
+    (func.__name__[len('bench_'):], func)
+    for func in (bench_call_soon, bench_timer_churn, bench_tcp_echo,
+                 bench_stream_bulk, bench_tls_handshake, bench_tls_bulk,
+                 bench_subprocess_spawn))
+
+
+def run_scenario(loop_factory, func, scale, rng):
+    loop = loop_factory()
+    asyncio.set_event_loop(loop)
+    try:
+        gc.collect()
+        return func(loop, scale, rng)
+    finally:
+        asyncio.set_event_loop(None)
+        loop.close()
+
+
+def summarize(runs):
+    # Median of each metric
+    return collections.OrderedDict(
+        (name, median([run[name] for run in runs]))
+        for name in runs[0])
+
+
+def environment():
+    try:
+        from asyncio import _speedups
+    except ImportError:
+        _speedups = None
+    return collections.OrderedDict((
+        ('python', sys.version.split()[0]),
+        ('implementation', platform.python_implementation()),
+        ('platform', platform.platform()),
+        ('cpu_count', os.cpu_count()),
+        ('asyncio', os.path.dirname(asyncio.__file__)),
+        ('speedups', _speedups is not None),
+        ('ssl', getattr(ssl, 'OPENSSL_VERSION', None)),
+    ))
+
+
+def format_metrics(metrics):
+    return ', '.join('%s=%.4g' % item for item in metrics.items())
+
+
+def compare(results, filename):
+    with open(filename) as fp:
+        previous = json.load(fp)
+    old = {(entry['loop'], entry['scenario']): entry['metrics']
+           for entry in previous['results'] if 'metrics' in entry}
+    print('Comparison with %s:' % filename)
+    for entry in results:
+        metrics = entry.get('metrics')
+        key = (entry['loop'], entry['scenario'])
+        if metrics is None or key not in old:
+            continue
+        changes = []
+        for name, value in metrics.items():
+            old_value = old[key].get(name)
+            if not old_value:
+                continue
+            change = (value - old_value) / old_value * 100.0
+            changes.append('%s %+.1f%%' % (name, change))
+        print('  %s/%s: %s' % (entry['loop'], entry['scenario'],
+                               ', '.join(changes)))
+
+
+def runbenchmarks():
+    args = ARGS.parse_args()
+    loops = available_loops()
+
+    if args.list:
+        for name, func in SCENARIOS.items():
+            print('%-18s %s' % (name, func.__doc__))
+        print('Loops: %s' % ', '.join(loops))
+        return 0
+
+    if args.loops:
+        loop_names = args.loops
+        for name in loop_names:
+            if name not in loops:
+                print('Unknown or unavailable loop: %s (available: %s)'
+                      % (name, ', '.join(loops)), file=sys.stderr)
+                return 2
+    else:
+        loop_names = [name for name in ('selector', 'proactor')
+                      if name in loops]
+
+    patterns = [re.compile(pattern) for pattern in args.pattern]
+    scenarios = [name for name in SCENARIOS
+                 if not patterns
+                 or any(pattern.search(name) for pattern in patterns)]
+
+    # keep stdout for the JSON document
+    log = sys.stderr if args.output == '-' else sys.stdout
+    results = []
+    for loop_name in loop_names:
+        for name in scenarios:
+            entry = collections.OrderedDict((('loop', loop_name),
+                                             ('scenario', name)))
+            rng = random.Random(args.seed)
+            runs = []
+            try:
+                for i in range(args.repeat):
+                    runs.append(run_scenario(loops[loop_name],
+                                             SCENARIOS[name],
+                                             args.scale, rng))
+            except SkipScenario as exc:
+                entry['skipped'] = str(exc)
+                if not args.quiet:
+                    print('%s/%s: skipped, %s' % (loop_name, name, exc),
+                          file=log)
+            else:
+                entry['runs'] = runs
+                entry['metrics'] = summarize(runs)
+                if not args.quiet:
+                    print('%s/%s: %s' % (loop_name, name,
+                                         format_metrics(entry['metrics'])),
+                          file=log)
+            results.append(entry)
+
+    if args.output:
+        document = collections.OrderedDict((
+            ('environment', environment()),
+            ('scale', args.scale),
+            ('repeat', args.repeat),
+            ('seed', args.seed),
+            ('results', results),
+        ))
+        if args.output == '-':
+            json.dump(document, sys.stdout, indent=2)
+            print()
+        else:
+            with open(args.output, 'w') as fp:
+                json.dump(document, fp, indent=2)
+    if args.compare:
+        compare(results, args.compare)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(runbenchmarks())
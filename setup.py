@@ -19,6 +19,10 @@
     from distutils.core import setup, Extension
 
 extensions = []
+# The C implementation of Handle and Future is optional: asyncio uses the
+# pure Python implementation if the extension cannot be built.
+ext = Extension('asyncio._speedups', ['speedups.c'], optional=True)
+extensions.append(ext)
 if os.name == 'nt':
     ext = Extension(
         'asyncio._overlapped', ['overlapped.c'], libraries=['ws2_32'],
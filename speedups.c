@@ -0,0 +1,888 @@
+/*
+ * C implementation of the Handle and Future hot paths
+ *
+ * asyncio.events.Handle and asyncio.futures.Future inherit from the types
+ * of this module when it is available, from the pure Python _PyHandle and
+ * _PyFuture classes otherwise. Both implementations must behave the same.
+ */
+
+#include "Python.h"
+#include "structmember.h"
+
+#define SETREF(op, op2)                      \
+    do {                                     \
+        PyObject *_py_tmp = (PyObject *)(op); \
+        (op) = (op2);                        \
+        Py_XDECREF(_py_tmp);                 \
+    } while (0)
+
+/* Future states, same strings as in asyncio/futures.py */
+static PyObject *s_PENDING;
+static PyObject *s_CANCELLED;
+static PyObject *s_FINISHED;
+
+/* Method names */
+static PyObject *str_call_soon;
+static PyObject *str_get_debug;
+static PyObject *str_report_exception;
+static PyObject *str_schedule_callbacks;
+static PyObject *str_set_result;
+
+/* Objects of Python modules, imported on first use: the asyncio package
+   imports this module while it is being initialized */
+static PyObject *get_event_loop;
+static PyObject *extract_stack;
+static PyObject *CancelledError;
+static PyObject *InvalidStateError;
+
+static int
+import_python_objects(void)
+{
+    PyObject *module;
+
+    if (InvalidStateError != NULL)
+        return 0;
+
+    module = PyImport_ImportModule("asyncio.events");
+    if (module == NULL)
+        return -1;
+    get_event_loop = PyObject_GetAttrString(module, "get_event_loop");
+    Py_DECREF(module);
+    if (get_event_loop == NULL)
+        return -1;
+
+    module = PyImport_ImportModule("traceback");
+    if (module == NULL)
+        return -1;
+    extract_stack = PyObject_GetAttrString(module, "extract_stack");
+    Py_DECREF(module);
+    if (extract_stack == NULL)
+        return -1;
+
+    module = PyImport_ImportModule("asyncio.futures");
+    if (module == NULL)
+        return -1;
+    CancelledError = PyObject_GetAttrString(module, "CancelledError");
+    if (CancelledError != NULL)
+        InvalidStateError = PyObject_GetAttrString(module,
+                                                   "InvalidStateError");
+    Py_DECREF(module);
+    if (InvalidStateError == NULL)
+        return -1;
+    return 0;
+}
+
+/* Return the source traceback of an object created by the current frame if
+   the event loop is in debug mode, or NULL without an exception set */
+static PyObject *
+get_source_traceback(PyObject *loop, int *error)
+{
+    PyObject *res;
+    int debug;
+
+    *error = 1;
+    res = PyObject_CallMethodObjArgs(loop, str_get_debug, NULL);
+    if (res == NULL)
+        return NULL;
+    debug = PyObject_IsTrue(res);
+    Py_DECREF(res);
+    if (debug < 0)
+        return NULL;
+    *error = 0;
+    if (!debug)
+        return NULL;
+
+    if (import_python_objects() < 0) {
+        *error = 1;
+        return NULL;
+    }
+    res = PyObject_CallFunctionObjArgs(extract_stack,
+                                       (PyObject *)PyEval_GetFrame(), NULL);
+    if (res == NULL)
+        *error = 1;
+    return res;
+}
+
+/*
+ * Handle
+ */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *callback;
+    PyObject *args;
+    PyObject *loop;
+    PyObject *source_traceback;
+    PyObject *repr;
+    PyObject *weakreflist;
+    char cancelled;
+} HandleObject;
+
+static PyTypeObject HandleType;
+
+static int
+Handle_init(HandleObject *self, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"callback", "args", "loop", NULL};
+    PyObject *callback, *cb_args, *loop, *source_traceback;
+    int error;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOO:Handle", kwlist,
+                                     &callback, &cb_args, &loop))
+        return -1;
+
+    if (PyObject_TypeCheck(callback, &HandleType)) {
+        PyErr_SetString(PyExc_AssertionError, "A Handle is not a callback");
+        return -1;
+    }
+
+    Py_INCREF(loop);
+    SETREF(self->loop, loop);
+    Py_INCREF(callback);
+    SETREF(self->callback, callback);
+    Py_INCREF(cb_args);
+    SETREF(self->args, cb_args);
+    self->cancelled = 0;
+    Py_CLEAR(self->repr);
+
+    source_traceback = get_source_traceback(loop, &error);
+    if (error)
+        return -1;
+    SETREF(self->source_traceback, source_traceback);
+    return 0;
+}
+
+static int
+Handle_traverse(HandleObject *self, visitproc visit, void *arg)
+{
+    Py_VISIT(self->callback);
+    Py_VISIT(self->args);
+    Py_VISIT(self->loop);
+    Py_VISIT(self->source_traceback);
+    Py_VISIT(self->repr);
+    return 0;
+}
+
+static int
+Handle_clear(HandleObject *self)
+{
+    Py_CLEAR(self->callback);
+    Py_CLEAR(self->args);
+    Py_CLEAR(self->loop);
+    Py_CLEAR(self->source_traceback);
+    Py_CLEAR(self->repr);
+    return 0;
+}
+
+static void
+Handle_dealloc(HandleObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    if (self->weakreflist != NULL)
+        PyObject_ClearWeakRefs((PyObject *)self);
+    Handle_clear(self);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+PyDoc_STRVAR(
+    Handle_cancel_doc,
+    "cancel() -> None\n\n"
+    "Cancel the callback.");
+
+static PyObject *
+Handle_cancel(HandleObject *self)
+{
+    PyObject *res;
+    int debug;
+
+    if (self->cancelled)
+        Py_RETURN_NONE;
+
+    self->cancelled = 1;
+    if (self->loop != NULL) {
+        res = PyObject_CallMethodObjArgs(self->loop, str_get_debug, NULL);
+        if (res == NULL)
+            return NULL;
+        debug = PyObject_IsTrue(res);
+        Py_DECREF(res);
+        if (debug < 0)
+            return NULL;
+        if (debug) {
+            /* Keep a representation in debug mode to keep callback and
+               parameters. For example, to log the warning
+               "Executing <Handle...> took 2.5 second" */
+            res = PyObject_Repr((PyObject *)self);
+            if (res == NULL)
+                return NULL;
+            SETREF(self->repr, res);
+        }
+    }
+    Py_CLEAR(self->callback);
+    Py_CLEAR(self->args);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Handle_run_doc,
+    "_run() -> None\n\n"
+    "Call the callback, report its exception to the event loop.");
+
+static PyObject *
+Handle_run(HandleObject *self)
+{
+    PyObject *callback, *args, *res;
+    PyObject *type, *value, *tb;
+
+    /* the callback can cancel its own handle: keep references */
+    callback = self->callback != NULL ? self->callback : Py_None;
+    Py_INCREF(callback);
+    if (self->args != NULL && PyTuple_CheckExact(self->args)) {
+        args = self->args;
+        Py_INCREF(args);
+    }
+    else {
+        args = PySequence_Tuple(self->args != NULL ? self->args : Py_None);
+    }
+
+    if (args != NULL) {
+        res = PyObject_Call(callback, args, NULL);
+        Py_DECREF(args);
+    }
+    else {
+        res = NULL;
+    }
+    Py_DECREF(callback);
+    if (res != NULL) {
+        Py_DECREF(res);
+        Py_RETURN_NONE;
+    }
+
+    if (!PyErr_ExceptionMatches(PyExc_Exception))
+        return NULL;
+
+    PyErr_Fetch(&type, &value, &tb);
+    PyErr_NormalizeException(&type, &value, &tb);
+    if (tb != NULL) {
+        PyException_SetTraceback(value, tb);
+        Py_DECREF(tb);
+    }
+    Py_DECREF(type);
+
+    res = PyObject_CallMethodObjArgs((PyObject *)self, str_report_exception,
+                                     value, NULL);
+    Py_DECREF(value);
+    if (res == NULL)
+        return NULL;
+    Py_DECREF(res);
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef Handle_methods[] = {
+    {"cancel", (PyCFunction) Handle_cancel,
+     METH_NOARGS, Handle_cancel_doc},
+    {"_run", (PyCFunction) Handle_run,
+     METH_NOARGS, Handle_run_doc},
+    {NULL}
+};
+
+static PyMemberDef Handle_members[] = {
+    {"_callback", T_OBJECT, offsetof(HandleObject, callback), 0, NULL},
+    {"_args", T_OBJECT, offsetof(HandleObject, args), 0, NULL},
+    {"_cancelled", T_BOOL, offsetof(HandleObject, cancelled), 0, NULL},
+    {"_loop", T_OBJECT, offsetof(HandleObject, loop), 0, NULL},
+    {"_source_traceback", T_OBJECT,
+     offsetof(HandleObject, source_traceback), 0, NULL},
+    {"_repr", T_OBJECT, offsetof(HandleObject, repr), 0, NULL},
+    {NULL}
+};
+
+static PyTypeObject HandleType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "_speedups.Handle",
+    /* tp_basicsize      */ sizeof(HandleObject),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) Handle_dealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE
+                            | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */ "Base class of asyncio.Handle",
+    /* tp_traverse       */ (traverseproc) Handle_traverse,
+    /* tp_clear          */ (inquiry) Handle_clear,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(HandleObject, weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ Handle_methods,
+    /* tp_members        */ Handle_members,
+    /* tp_getset         */ 0,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ (initproc) Handle_init,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ PyType_GenericNew,
+};
+
+/*
+ * Future
+ */
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *loop;
+    PyObject *callbacks;
+    PyObject *state;
+    PyObject *result;
+    PyObject *exception;
+    PyObject *source_traceback;
+    PyObject *weakreflist;
+    char log_traceback;
+    char blocking;
+} FutureObject;
+
+/* Compare the state of a future, the _state attribute can be set by
+   Python code */
+static int
+future_is(FutureObject *fut, PyObject *state)
+{
+    if (fut->state == state)
+        return 1;
+    if (fut->state == NULL || !PyUnicode_Check(fut->state))
+        return 0;
+    return PyUnicode_Compare(fut->state, state) == 0;
+}
+
+static PyObject *
+Future_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    FutureObject *fut;
+
+    fut = (FutureObject *) type->tp_alloc(type, 0);
+    if (fut == NULL)
+        return NULL;
+    Py_INCREF(s_PENDING);
+    fut->state = s_PENDING;
+    fut->callbacks = PyList_New(0);
+    if (fut->callbacks == NULL) {
+        Py_DECREF(fut);
+        return NULL;
+    }
+    return (PyObject *)fut;
+}
+
+static int
+Future_init(FutureObject *fut, PyObject *args, PyObject *kwds)
+{
+    static char *kwlist[] = {"loop", NULL};
+    PyObject *loop = Py_None, *source_traceback;
+    int error;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, "|$O:Future", kwlist,
+                                     &loop))
+        return -1;
+
+    if (loop == Py_None) {
+        if (import_python_objects() < 0)
+            return -1;
+        loop = PyObject_CallObject(get_event_loop, NULL);
+        if (loop == NULL)
+            return -1;
+    }
+    else {
+        Py_INCREF(loop);
+    }
+    SETREF(fut->loop, loop);
+
+    source_traceback = get_source_traceback(loop, &error);
+    if (error)
+        return -1;
+    if (source_traceback != NULL)
+        SETREF(fut->source_traceback, source_traceback);
+    return 0;
+}
+
+static int
+Future_traverse(FutureObject *fut, visitproc visit, void *arg)
+{
+    Py_VISIT(fut->loop);
+    Py_VISIT(fut->callbacks);
+    Py_VISIT(fut->state);
+    Py_VISIT(fut->result);
+    Py_VISIT(fut->exception);
+    Py_VISIT(fut->source_traceback);
+    return 0;
+}
+
+static int
+Future_clear(FutureObject *fut)
+{
+    Py_CLEAR(fut->loop);
+    Py_CLEAR(fut->callbacks);
+    Py_CLEAR(fut->state);
+    Py_CLEAR(fut->result);
+    Py_CLEAR(fut->exception);
+    Py_CLEAR(fut->source_traceback);
+    return 0;
+}
+
+static void
+Future_dealloc(FutureObject *fut)
+{
+    PyObject_GC_UnTrack(fut);
+    if (fut->weakreflist != NULL)
+        PyObject_ClearWeakRefs((PyObject *)fut);
+    Future_clear(fut);
+    Py_TYPE(fut)->tp_free((PyObject *)fut);
+}
+
+/* Call the _schedule_callbacks() method: subclasses can override it */
+static int
+future_schedule_callbacks(FutureObject *fut)
+{
+    PyObject *res;
+
+    res = PyObject_CallMethodObjArgs((PyObject *)fut, str_schedule_callbacks,
+                                     NULL);
+    if (res == NULL)
+        return -1;
+    Py_DECREF(res);
+    return 0;
+}
+
+static PyObject *
+future_invalid_state(FutureObject *fut)
+{
+    if (import_python_objects() < 0)
+        return NULL;
+    PyErr_Format(InvalidStateError, "%S: %R",
+                 fut->state != NULL ? fut->state : Py_None, fut);
+    return NULL;
+}
+
+PyDoc_STRVAR(
+    Future_cancel_doc,
+    "cancel() -> bool\n\n"
+    "Cancel the future and schedule callbacks.\n\n"
+    "If the future is already done or cancelled, return False.  Otherwise,\n"
+    "change the future's state to cancelled, schedule the callbacks and\n"
+    "return True.");
+
+static PyObject *
+Future_cancel(FutureObject *fut)
+{
+    if (!future_is(fut, s_PENDING))
+        Py_RETURN_FALSE;
+    Py_INCREF(s_CANCELLED);
+    SETREF(fut->state, s_CANCELLED);
+    if (future_schedule_callbacks(fut) < 0)
+        return NULL;
+    Py_RETURN_TRUE;
+}
+
+PyDoc_STRVAR(
+    Future_schedule_callbacks_doc,
+    "_schedule_callbacks() -> None\n\n"
+    "Internal: Ask the event loop to call all callbacks.\n\n"
+    "The callbacks are scheduled to be called as soon as possible. Also\n"
+    "clears the callback list.");
+
+static PyObject *
+Future_schedule_callbacks(FutureObject *fut)
+{
+    PyObject *callbacks, *res;
+    Py_ssize_t i, size;
+
+    if (fut->callbacks == NULL || !PyList_Check(fut->callbacks)) {
+        PyErr_SetString(PyExc_TypeError, "_callbacks must be a list");
+        return NULL;
+    }
+    size = PyList_GET_SIZE(fut->callbacks);
+    if (!size)
+        Py_RETURN_NONE;
+
+    callbacks = PyList_GetSlice(fut->callbacks, 0, size);
+    if (callbacks == NULL)
+        return NULL;
+    if (PyList_SetSlice(fut->callbacks, 0, size, NULL) < 0) {
+        Py_DECREF(callbacks);
+        return NULL;
+    }
+
+    for (i = 0; i < size; i++) {
+        res = PyObject_CallMethodObjArgs(fut->loop, str_call_soon,
+                                         PyList_GET_ITEM(callbacks, i),
+                                         fut, NULL);
+        if (res == NULL) {
+            Py_DECREF(callbacks);
+            return NULL;
+        }
+        Py_DECREF(res);
+    }
+    Py_DECREF(callbacks);
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Future_cancelled_doc,
+    "cancelled() -> bool\n\n"
+    "Return True if the future was cancelled.");
+
+static PyObject *
+Future_cancelled(FutureObject *fut)
+{
+    return PyBool_FromLong(future_is(fut, s_CANCELLED));
+}
+
+PyDoc_STRVAR(
+    Future_done_doc,
+    "done() -> bool\n\n"
+    "Return True if the future is done.\n\n"
+    "Done means either that a result / exception are available, or that the\n"
+    "future was cancelled.");
+
+static PyObject *
+Future_done(FutureObject *fut)
+{
+    return PyBool_FromLong(!future_is(fut, s_PENDING));
+}
+
+/* Common code of result() and exception(): return 0 if the future
+   is finished */
+static int
+future_check_finished(FutureObject *fut, const char *msg)
+{
+    if (import_python_objects() < 0)
+        return -1;
+    if (future_is(fut, s_CANCELLED)) {
+        PyErr_SetNone(CancelledError);
+        return -1;
+    }
+    if (!future_is(fut, s_FINISHED)) {
+        PyErr_SetString(InvalidStateError, msg);
+        return -1;
+    }
+    fut->log_traceback = 0;
+    return 0;
+}
+
+PyDoc_STRVAR(
+    Future_result_doc,
+    "result() -> object\n\n"
+    "Return the result this future represents.\n\n"
+    "If the future has been cancelled, raises CancelledError.  If the\n"
+    "future's result isn't yet available, raises InvalidStateError.  If\n"
+    "the future is done and has an exception set, this exception is raised.");
+
+static PyObject *
+Future_result(FutureObject *fut)
+{
+    if (future_check_finished(fut, "Result is not ready.") < 0)
+        return NULL;
+    if (fut->exception != NULL && fut->exception != Py_None) {
+        PyErr_SetObject((PyObject *)Py_TYPE(fut->exception), fut->exception);
+        return NULL;
+    }
+    if (fut->result == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF(fut->result);
+    return fut->result;
+}
+
+PyDoc_STRVAR(
+    Future_exception_doc,
+    "exception() -> exception or None\n\n"
+    "Return the exception that was set on this future.\n\n"
+    "The exception (or None if no exception was set) is returned only if\n"
+    "the future is done.  If the future has been cancelled, raises\n"
+    "CancelledError.  If the future isn't done yet, raises\n"
+    "InvalidStateError.");
+
+static PyObject *
+Future_exception(FutureObject *fut)
+{
+    if (future_check_finished(fut, "Exception is not set.") < 0)
+        return NULL;
+    if (fut->exception == NULL)
+        Py_RETURN_NONE;
+    Py_INCREF(fut->exception);
+    return fut->exception;
+}
+
+PyDoc_STRVAR(
+    Future_add_done_callback_doc,
+    "add_done_callback(fn) -> None\n\n"
+    "Add a callback to be run when the future becomes done.\n\n"
+    "The callback is called with a single argument - the future object. If\n"
+    "the future is already done when this is called, the callback is\n"
+    "scheduled with call_soon.");
+
+static PyObject *
+Future_add_done_callback(FutureObject *fut, PyObject *fn)
+{
+    if (!future_is(fut, s_PENDING))
+        return PyObject_CallMethodObjArgs(fut->loop, str_call_soon,
+                                          fn, fut, NULL);
+    if (fut->callbacks == NULL || !PyList_Check(fut->callbacks)) {
+        PyErr_SetString(PyExc_TypeError, "_callbacks must be a list");
+        return NULL;
+    }
+    if (PyList_Append(fut->callbacks, fn) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Future_remove_done_callback_doc,
+    "remove_done_callback(fn) -> int\n\n"
+    "Remove all instances of a callback from the \"call when done\" list.\n\n"
+    "Returns the number of callbacks removed.");
+
+static PyObject *
+Future_remove_done_callback(FutureObject *fut, PyObject *fn)
+{
+    PyObject *filtered, *item;
+    Py_ssize_t i, size, removed;
+    int ne;
+
+    if (fut->callbacks == NULL || !PyList_Check(fut->callbacks)) {
+        PyErr_SetString(PyExc_TypeError, "_callbacks must be a list");
+        return NULL;
+    }
+    filtered = PyList_New(0);
+    if (filtered == NULL)
+        return NULL;
+    size = PyList_GET_SIZE(fut->callbacks);
+    for (i = 0; i < PyList_GET_SIZE(fut->callbacks); i++) {
+        item = PyList_GET_ITEM(fut->callbacks, i);
+        Py_INCREF(item);
+        ne = PyObject_RichCompareBool(item, fn, Py_NE);
+        if (ne > 0)
+            ne = PyList_Append(filtered, item) < 0 ? -1 : 1;
+        Py_DECREF(item);
+        if (ne < 0) {
+            Py_DECREF(filtered);
+            return NULL;
+        }
+    }
+    removed = size - PyList_GET_SIZE(filtered);
+    if (removed
+        && PyList_SetSlice(fut->callbacks, 0, PyList_GET_SIZE(fut->callbacks),
+                           filtered) < 0) {
+        Py_DECREF(filtered);
+        return NULL;
+    }
+    Py_DECREF(filtered);
+    return PyLong_FromSsize_t(removed);
+}
+
+PyDoc_STRVAR(
+    Future_set_result_unless_cancelled_doc,
+    "_set_result_unless_cancelled(result) -> None\n\n"
+    "Helper setting the result only if the future was not cancelled.");
+
+static PyObject *
+Future_set_result_unless_cancelled(FutureObject *fut, PyObject *result)
+{
+    if (future_is(fut, s_CANCELLED))
+        Py_RETURN_NONE;
+    return PyObject_CallMethodObjArgs((PyObject *)fut, str_set_result,
+                                      result, NULL);
+}
+
+PyDoc_STRVAR(
+    Future_set_result_doc,
+    "set_result(result) -> None\n\n"
+    "Mark the future done and set its result.\n\n"
+    "If the future is already done when this method is called, raises\n"
+    "InvalidStateError.");
+
+static PyObject *
+Future_set_result(FutureObject *fut, PyObject *result)
+{
+    if (!future_is(fut, s_PENDING))
+        return future_invalid_state(fut);
+    Py_INCREF(result);
+    SETREF(fut->result, result);
+    Py_INCREF(s_FINISHED);
+    SETREF(fut->state, s_FINISHED);
+    if (future_schedule_callbacks(fut) < 0)
+        return NULL;
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+    Future_set_exception_doc,
+    "set_exception(exception) -> None\n\n"
+    "Mark the future done and set an exception.\n\n"
+    "If the future is already done when this method is called, raises\n"
+    "InvalidStateError.");
+
+static PyObject *
+Future_set_exception(FutureObject *fut, PyObject *exception)
+{
+    if (!future_is(fut, s_PENDING))
+        return future_invalid_state(fut);
+    if (PyType_Check(exception)) {
+        exception = PyObject_CallObject(exception, NULL);
+        if (exception == NULL)
+            return NULL;
+    }
+    else {
+        Py_INCREF(exception);
+    }
+    SETREF(fut->exception, exception);
+    Py_INCREF(s_FINISHED);
+    SETREF(fut->state, s_FINISHED);
+    if (future_schedule_callbacks(fut) < 0)
+        return NULL;
+    fut->log_traceback = 1;
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef Future_methods[] = {
+    {"cancel", (PyCFunction) Future_cancel,
+     METH_NOARGS, Future_cancel_doc},
+    {"_schedule_callbacks", (PyCFunction) Future_schedule_callbacks,
+     METH_NOARGS, Future_schedule_callbacks_doc},
+    {"cancelled", (PyCFunction) Future_cancelled,
+     METH_NOARGS, Future_cancelled_doc},
+    {"done", (PyCFunction) Future_done,
+     METH_NOARGS, Future_done_doc},
+    {"result", (PyCFunction) Future_result,
+     METH_NOARGS, Future_result_doc},
+    {"exception", (PyCFunction) Future_exception,
+     METH_NOARGS, Future_exception_doc},
+    {"add_done_callback", (PyCFunction) Future_add_done_callback,
+     METH_O, Future_add_done_callback_doc},
+    {"remove_done_callback", (PyCFunction) Future_remove_done_callback,
+     METH_O, Future_remove_done_callback_doc},
+    {"_set_result_unless_cancelled",
+     (PyCFunction) Future_set_result_unless_cancelled,
+     METH_O, Future_set_result_unless_cancelled_doc},
+    {"set_result", (PyCFunction) Future_set_result,
+     METH_O, Future_set_result_doc},
+    {"set_exception", (PyCFunction) Future_set_exception,
+     METH_O, Future_set_exception_doc},
+    {NULL}
+};
+
+static PyMemberDef Future_members[] = {
+    {"_loop", T_OBJECT, offsetof(FutureObject, loop), 0, NULL},
+    {"_callbacks", T_OBJECT, offsetof(FutureObject, callbacks), 0, NULL},
+    {"_state", T_OBJECT, offsetof(FutureObject, state), 0, NULL},
+    {"_result", T_OBJECT, offsetof(FutureObject, result), 0, NULL},
+    {"_exception", T_OBJECT, offsetof(FutureObject, exception), 0, NULL},
+    {"_source_traceback", T_OBJECT,
+     offsetof(FutureObject, source_traceback), 0, NULL},
+    {"_log_traceback", T_BOOL,
+     offsetof(FutureObject, log_traceback), 0, NULL},
+    {"_blocking", T_BOOL, offsetof(FutureObject, blocking), 0, NULL},
+    {NULL}
+};
+
+static PyTypeObject FutureType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name           */ "_speedups.Future",
+    /* tp_basicsize      */ sizeof(FutureObject),
+    /* tp_itemsize       */ 0,
+    /* tp_dealloc        */ (destructor) Future_dealloc,
+    /* tp_print          */ 0,
+    /* tp_getattr        */ 0,
+    /* tp_setattr        */ 0,
+    /* tp_reserved       */ 0,
+    /* tp_repr           */ 0,
+    /* tp_as_number      */ 0,
+    /* tp_as_sequence    */ 0,
+    /* tp_as_mapping     */ 0,
+    /* tp_hash           */ 0,
+    /* tp_call           */ 0,
+    /* tp_str            */ 0,
+    /* tp_getattro       */ 0,
+    /* tp_setattro       */ 0,
+    /* tp_as_buffer      */ 0,
+    /* tp_flags          */ Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE
+                            | Py_TPFLAGS_HAVE_GC,
+    /* tp_doc            */ "Base class of asyncio.Future",
+    /* tp_traverse       */ (traverseproc) Future_traverse,
+    /* tp_clear          */ (inquiry) Future_clear,
+    /* tp_richcompare    */ 0,
+    /* tp_weaklistoffset */ offsetof(FutureObject, weakreflist),
+    /* tp_iter           */ 0,
+    /* tp_iternext       */ 0,
+    /* tp_methods        */ Future_methods,
+    /* tp_members        */ Future_members,
+    /* tp_getset         */ 0,
+    /* tp_base           */ 0,
+    /* tp_dict           */ 0,
+    /* tp_descr_get      */ 0,
+    /* tp_descr_set      */ 0,
+    /* tp_dictoffset     */ 0,
+    /* tp_init           */ (initproc) Future_init,
+    /* tp_alloc          */ 0,
+    /* tp_new            */ Future_new,
+};
+
+static struct PyModuleDef speedups_module = {
+    PyModuleDef_HEAD_INIT,
+    "_speedups",
+    NULL,
+    -1,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    NULL
+};
+
+#define INTERN_STRING(var, str) \
+    do { \
+        var = PyUnicode_InternFromString(str); \
+        if (var == NULL) \
+            return NULL; \
+    } while (0)
+
+PyMODINIT_FUNC
+PyInit__speedups(void)
+{
+    PyObject *m;
+
+    INTERN_STRING(s_PENDING, "PENDING");
+    INTERN_STRING(s_CANCELLED, "CANCELLED");
+    INTERN_STRING(s_FINISHED, "FINISHED");
+    INTERN_STRING(str_call_soon, "call_soon");
+    INTERN_STRING(str_get_debug, "get_debug");
+    INTERN_STRING(str_report_exception, "_report_exception");
+    INTERN_STRING(str_schedule_callbacks, "_schedule_callbacks");
+    INTERN_STRING(str_set_result, "set_result");
+
+    if (PyType_Ready(&HandleType) < 0)
+        return NULL;
+    if (PyType_Ready(&FutureType) < 0)
+        return NULL;
+
+    m = PyModule_Create(&speedups_module);
+    if (m == NULL)
+        return NULL;
+    Py_INCREF(&HandleType);
+    if (PyModule_AddObject(m, "Handle", (PyObject *)&HandleType) < 0)
+        return NULL;
+    Py_INCREF(&FutureType);
+    if (PyModule_AddObject(m, "Future", (PyObject *)&FutureType) < 0)
+        return NULL;
+    return m;
+}
@@ -115,6 +115,70 @@ def cb():
         self.assertIsInstance(h, asyncio.Handle)
         self.assertIn(h, self.loop._ready)
 
+    def test_call_soon_threadsafe_coalesce_wakeups(self):
+        def cb():
+            pass
+
+        self.loop._write_to_self = mock.Mock()
+        # the event loop is running callbacks: it will see the new callbacks
+        # before polling
+        self.loop.call_soon_threadsafe(cb)
+        self.assertFalse(self.loop._write_to_self.called)
+
+        # the event loop may block in select(): wake it up once
+        self.loop._selecting = True
+        self.loop.call_soon_threadsafe(cb)
+        self.loop.call_soon_threadsafe(cb)
+        self.assertEqual(self.loop._write_to_self.call_count, 1)
+        self.assertEqual(len(self.loop._ready), 3)
+
+        def select(timeout):
+            self.assertTrue(self.loop._selecting)
+            self.assertFalse(self.loop._wakeup_pending)
+            self.assertEqual(timeout, 0)
+            return ()
+        self.loop._selector.select.side_effect = select
+        self.loop._process_events = mock.Mock()
+        self.loop._run_once()
+        self.assertFalse(self.loop._selecting)
+
+        # the next wakeup is written
+        self.loop._selecting = True
+        self.loop.call_soon_threadsafe(cb)
+        self.assertEqual(self.loop._write_to_self.call_count, 2)
+
+    def test_call_soon_threadsafe_many(self):
+        calls = []
+
+        def cb(*args):
+            calls.append(args)
+
+        self.loop._write_to_self = mock.Mock()
+        self.loop._selecting = True
+        handles = self.loop.call_soon_threadsafe_many(
+            [(cb,), (cb, 1), (cb, 2, 3)])
+        self.assertEqual(len(handles), 3)
+        self.assertEqual(list(self.loop._ready), handles)
+        self.assertEqual(self.loop._write_to_self.call_count, 1)
+
+        self.loop._process_events = mock.Mock()
+        self.loop._run_once()
+        self.assertEqual(calls, [(), (1,), (2, 3)])
+
+        # nothing to schedule: no wakeup
+        self.loop._selecting = True
+        self.assertEqual(self.loop.call_soon_threadsafe_many([]), [])
+        self.assertEqual(self.loop._write_to_self.call_count, 1)
+
+        # the callbacks scheduled before an error are woken up
+        @asyncio.coroutine
+        def coro():
+            pass
+        with self.assertRaises(TypeError):
+            self.loop.call_soon_threadsafe_many([(cb, 4), (coro,)])
+        self.assertEqual(len(self.loop._ready), 1)
+        self.assertEqual(self.loop._write_to_self.call_count, 2)
+
     def test_call_later(self):
         def cb():
             pass
@@ -408,6 +472,105 @@ def cb():
         # Ensure only uncancelled events remain scheduled
         self.assertTrue(all([not x._cancelled for x in self.loop._scheduled]))
 
+    def test_timer_wheel(self):
+        self.loop.time = mock.Mock(return_value=100.0)
+        self.loop.set_timer_wheel(1.0)
+        wheel = self.loop._timer_wheel
+
+        # calls far in the future are stored in the wheel
+        h1 = self.loop.call_later(10.5, lambda: None)
+        h2 = self.loop.call_later(10.7, lambda: None)
+        near = self.loop.call_later(1.5, lambda: None)
+        self.assertEqual(self.loop._scheduled, [near])
+        self.assertEqual(len(wheel), 2)
+        self.assertTrue(h1._scheduled)
+
+        # cancelling a call removes it from the wheel
+        h2.cancel()
+        self.assertEqual(len(wheel), 1)
+        self.assertFalse(h2._scheduled)
+        self.assertEqual(self.loop._timer_cancelled_count, 0)
+
+        # the bucket is moved to the heap one tick before it expires
+        near.cancel()
+        self.loop._process_events = mock.Mock()
+        self.loop._run_once()
+        timeout = self.loop._selector.select.call_args[0][0]
+        self.assertAlmostEqual(timeout, 9.0)
+
+        self.loop.time.return_value = 109.0
+        self.loop._run_once()
+        self.assertEqual(self.loop._scheduled, [h1])
+        self.assertEqual(len(wheel), 0)
+        timeout = self.loop._selector.select.call_args[0][0]
+        self.assertAlmostEqual(timeout, 1.5)
+
+        # disabling the wheel moves its calls to the heap
+        h3 = self.loop.call_later(20, lambda: None)
+        self.assertNotIn(h3, self.loop._scheduled)
+        self.loop.set_timer_wheel(None)
+        self.assertIsNone(self.loop._timer_wheel)
+        self.assertIn(h3, self.loop._scheduled)
+
+        self.assertRaises(ValueError, self.loop.set_timer_wheel, 0)
+
+    def test_timer_wheel_order(self):
+        self.loop.set_timer_wheel(0.05)
+        calls = []
+        loop = self.loop
+
+        def cb(arg):
+            calls.append(arg)
+            if arg == 'stop':
+                loop.stop()
+
+        now = self.loop.time()
+        self.loop.call_at(now + 0.2, cb, 'c')
+        self.loop.call_at(now + 0.12, cb, 'b')
+        self.loop.call_at(now + 0.01, cb, 'a')
+        self.loop.call_at(now + 0.3, cb, 'x').cancel()
+        self.loop.call_at(now + 0.25, cb, 'stop')
+        self.loop._process_events = mock.Mock()
+        self.loop._selector.select.side_effect = time.sleep
+        self.loop.run_forever()
+        self.assertEqual(calls, ['a', 'b', 'c', 'stop'])
+        self.assertGreaterEqual(self.loop.time(), now + 0.25)
+
+    def test_stats(self):
+        self.assertIsNone(self.loop.get_stats())
+        self.loop.set_stats_enabled(True)
+        self.loop._process_events = mock.Mock()
+        self.loop._selector.select.return_value = ['event']
+        self.loop.slow_callback_duration = 0.5
+        now = 0.0
+        self.loop.time = lambda: now
+
+        def slow():
+            nonlocal now
+            now += 1.0
+
+        self.loop.call_soon(slow)
+        self.loop.call_soon(lambda: None)
+        self.loop.call_later(10, lambda: None)
+        self.loop._run_once()
+
+        stats = self.loop.get_stats()
+        self.assertEqual(stats['iterations'], 1)
+        self.assertEqual(stats['events'], 1)
+        self.assertEqual(stats['callbacks'], 2)
+        self.assertEqual(stats['callback_time'], 1.0)
+        self.assertEqual(stats['slow_callbacks'], 1)
+        self.assertEqual(stats['callback_durations'],
+                         [(1e-5, 1), (1e-4, 0), (1e-3, 0), (1e-2, 0),
+                          (1e-1, 0), (1.0, 1), (None, 0)])
+        self.assertEqual(stats['max_ready'], 2)
+        self.assertEqual(stats['max_scheduled'], 1)
+        self.assertEqual(stats['ready'], 0)
+        self.assertEqual(stats['scheduled'], 1)
+
+        self.loop.set_stats_enabled(False)
+        self.assertIsNone(self.loop.get_stats())
+
     def test_run_until_complete_type_error(self):
         self.assertRaises(TypeError,
             self.loop.run_until_complete, 'blah')
@@ -875,6 +1038,105 @@ def getaddrinfo(*args, **kw):
                 self.loop.run_until_complete(coro)
             self.assertTrue(sock.close.called)
 
+    def happy_eyeballs_connect(self, m_socket, infos, connect, **kw):
+        # Return the socket connected by create_connection() and the list
+        # of the created sockets
+        sockets = []
+
+        def new_socket(family, type, proto):
+            sock = mock.Mock()
+            sock.family = family
+            sockets.append(sock)
+            return sock
+        m_socket.socket.side_effect = new_socket
+
+        def getaddrinfo(*args, **kw):
+            fut = asyncio.Future(loop=self.loop)
+            fut.set_result(infos)
+            return fut
+        self.loop.getaddrinfo = getaddrinfo
+
+        def sock_connect(sock, address):
+            fut = asyncio.Future(loop=self.loop)
+            result = connect(address)
+            if result is None:
+                fut.set_result(None)
+            elif isinstance(result, Exception):
+                fut.set_exception(result)
+            # else the connection attempt never completes
+            return fut
+
+        @asyncio.coroutine
+        def create_transport(sock, *args):
+            return sock, None
+
+        with mock.patch.object(self.loop, 'sock_connect',
+                               side_effect=sock_connect), \
+             mock.patch.object(self.loop, '_create_connection_transport',
+                               side_effect=create_transport):
+            coro = self.loop.create_connection(MyProto, 'example.com', 80,
+                                               **kw)
+            sock, protocol = self.loop.run_until_complete(coro)
+        return sock, sockets
+
+    @mock.patch('asyncio.base_events.socket')
+    def test_create_connection_happy_eyeballs(self, m_socket):
+        infos = [(socket.AF_INET6, 1, 6, '', ('2001:db8::1', 80, 0, 0)),
+                 (socket.AF_INET6, 1, 6, '', ('2001:db8::2', 80, 0, 0)),
+                 (socket.AF_INET, 1, 6, '', ('192.0.2.1', 80))]
+
+        def connect(address):
+            if address[0] == '192.0.2.1':
+                return None
+            # the IPv6 route is dead
+            return 'hang'
+
+        sock, sockets = self.happy_eyeballs_connect(
+            m_socket, infos, connect, happy_eyeballs_delay=0.01)
+        # the addresses are interleaved: the IPv4 address is tried second
+        self.assertEqual(sock.family, socket.AF_INET)
+        self.assertEqual(len(sockets), 2)
+        # the pending attempt was cancelled
+        self.assertTrue(sockets[0].close.called)
+        self.assertFalse(sock.close.called)
+
+    @mock.patch('asyncio.base_events.socket')
+    def test_create_connection_happy_eyeballs_error(self, m_socket):
+        infos = [(socket.AF_INET, 1, 6, '', ('192.0.2.1', 80)),
+                 (socket.AF_INET, 1, 6, '', ('192.0.2.2', 80))]
+
+        def connect(address):
+            if address[0] == '192.0.2.1':
+                return OSError('refused')
+            return None
+
+        # the next attempt starts as soon as the previous one failed
+        t0 = self.loop.time()
+        sock, sockets = self.happy_eyeballs_connect(
+            m_socket, infos, connect, happy_eyeballs_delay=60.0)
+        self.assertLess(self.loop.time() - t0, 30.0)
+        self.assertIs(sock, sockets[1])
+        self.assertTrue(sockets[0].close.called)
+
+        with self.assertRaises(OSError) as cm:
+            self.happy_eyeballs_connect(m_socket, infos,
+                                        lambda address: OSError('refused'),
+                                        happy_eyeballs_delay=60.0)
+        self.assertEqual(str(cm.exception), 'refused')
+
+    def test_interleave_addrinfos(self):
+        infos = [(socket.AF_INET6, 1, 6, '', ('::1', 80, 0, 0)),
+                 (socket.AF_INET6, 1, 6, '', ('::2', 80, 0, 0)),
+                 (socket.AF_INET6, 1, 6, '', ('::3', 80, 0, 0)),
+                 (socket.AF_INET, 1, 6, '', ('127.0.0.1', 80)),
+                 (socket.AF_INET, 1, 6, '', ('127.0.0.2', 80))]
+        reordered = base_events._interleave_addrinfos(infos)
+        self.assertEqual([info[4][0] for info in reordered],
+                         ['::1', '127.0.0.1', '::2', '127.0.0.2', '::3'])
+        reordered = base_events._interleave_addrinfos(infos, 2)
+        self.assertEqual([info[4][0] for info in reordered],
+                         ['::1', '::2', '127.0.0.1', '::3', '127.0.0.2'])
+
     def test_create_connection_host_port_sock(self):
         coro = self.loop.create_connection(
             MyProto, 'example.com', 80, sock=object())
@@ -884,6 +1146,13 @@ def test_create_connection_no_host_port_sock(self):
         coro = self.loop.create_connection(MyProto)
         self.assertRaises(ValueError, self.loop.run_until_complete, coro)
 
+    def test_create_connection_bad_read_size(self):
+        for limits in ({'min_read_size': 0}, {'max_read_size': -1},
+                       {'min_read_size': 2, 'max_read_size': 1}):
+            coro = self.loop.create_connection(MyProto, 'example.com', 80,
+                                               **limits)
+            self.assertRaises(ValueError, self.loop.run_until_complete, coro)
+
     def test_create_connection_no_getaddrinfo(self):
         @asyncio.coroutine
         def getaddrinfo(*args, **kw):
@@ -1023,7 +1292,8 @@ def mock_make_ssl_transport(sock, protocol, sslcontext, waiter,
         self.loop._make_ssl_transport.assert_called_with(
             ANY, ANY, ANY, ANY,
             server_side=False,
-            server_hostname='python.org')
+            server_hostname='python.org',
+            read_size_limits=None)
         # Next try an explicit server_hostname.
         self.loop._make_ssl_transport.reset_mock()
         coro = self.loop.create_connection(MyProto, 'python.org', 80, ssl=True,
@@ -1033,7 +1303,8 @@ def mock_make_ssl_transport(sock, protocol, sslcontext, waiter,
         self.loop._make_ssl_transport.assert_called_with(
             ANY, ANY, ANY, ANY,
             server_side=False,
-            server_hostname='perl.com')
+            server_hostname='perl.com',
+            read_size_limits=None)
         # Finally try an explicit empty server_hostname.
         self.loop._make_ssl_transport.reset_mock()
         coro = self.loop.create_connection(MyProto, 'python.org', 80, ssl=True,
@@ -1042,7 +1313,8 @@ def mock_make_ssl_transport(sock, protocol, sslcontext, waiter,
         transport.close()
         self.loop._make_ssl_transport.assert_called_with(ANY, ANY, ANY, ANY,
                                                          server_side=False,
-                                                         server_hostname='')
+                                                         server_hostname='',
+                                                         read_size_limits=None)
 
     def test_create_connection_no_ssl_server_hostname_errors(self):
         # When not using ssl, server_hostname must be None.
@@ -1092,6 +1364,19 @@ def test_create_server_no_host_port_sock(self):
         fut = self.loop.create_server(MyProto)
         self.assertRaises(ValueError, self.loop.run_until_complete, fut)
 
+    def test_create_server_bad_read_size(self):
+        fut = self.loop.create_server(MyProto, '0.0.0.0', 0,
+                                      min_read_size=2, max_read_size=1)
+        self.assertRaises(ValueError, self.loop.run_until_complete, fut)
+
+    @mock.patch('asyncio.base_events.socket')
+    def test_create_server_reuse_port_unsupported(self, m_socket):
+        del m_socket.SO_REUSEPORT
+        fut = self.loop.create_server(MyProto, '0.0.0.0', 0,
+                                      reuse_port=True)
+        self.assertRaises(ValueError, self.loop.run_until_complete, fut)
+        self.assertFalse(m_socket.socket.called)
+
     def test_create_server_no_getaddrinfo(self):
         getaddrinfo = self.loop.getaddrinfo = mock.Mock()
         getaddrinfo.return_value = []
@@ -1221,7 +1506,8 @@ def test_accept_connection_exception(self, m_log):
         self.loop.call_later.assert_called_with(constants.ACCEPT_RETRY_DELAY,
                                                 # self.loop._start_serving
                                                 mock.ANY,
-                                                MyProto, sock, None, None)
+                                                MyProto, sock, None, None,
+                                                None)
 
     def test_call_coroutine(self):
         @asyncio.coroutine
@@ -23,6 +23,7 @@
 
 
 import asyncio
+from asyncio import events
 from asyncio import proactor_events
 from asyncio import selector_events
 from asyncio import sslproto
@@ -316,6 +317,32 @@ def run_in_thread():
         t.join()
         self.assertEqual(results, ['hello', 'world'])
 
+    def test_call_soon_threadsafe_many_threads(self):
+        results = []
+        ncall = 500
+
+        def callback(arg):
+            results.append(arg)
+            if len(results) == ncall * 3:
+                self.loop.stop()
+
+        def run_in_thread(value):
+            for i in range(ncall // 5):
+                self.loop.call_soon_threadsafe(callback, value)
+            calls = [(callback, value)] * 4
+            for i in range(ncall // 5):
+                self.loop.call_soon_threadsafe_many(calls)
+
+        threads = [threading.Thread(target=run_in_thread, args=(value,))
+                   for value in range(3)]
+        for thread in threads:
+            thread.start()
+        self.loop.run_forever()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(sorted(results),
+                         sorted(list(range(3)) * ncall))
+
     def test_call_soon_threadsafe_same_thread(self):
         results = []
 
@@ -418,6 +445,20 @@ def _basetest_sock_client_ops(self, httpd, sock):
         sock.close()
         self.assertTrue(data.startswith(b'HTTP/1.0 200 OK'))
 
+    def test_sock_recv_into(self):
+        rsock, wsock = test_utils.socketpair()
+        self.addCleanup(rsock.close)
+        self.addCleanup(wsock.close)
+        rsock.setblocking(False)
+        wsock.setblocking(False)
+
+        buf = bytearray(10)
+        fut = self.loop.sock_recv_into(rsock, buf)
+        wsock.send(b'data')
+        nbytes = self.loop.run_until_complete(fut)
+        self.assertEqual(nbytes, 4)
+        self.assertEqual(buf[:nbytes], b'data')
+
     def test_sock_client_ops(self):
         with test_utils.run_test_server() as httpd:
             sock = socket.socket()
@@ -732,6 +773,29 @@ def test_create_server(self):
         # close server
         server.close()
 
+    def test_create_server_read_size_limits(self):
+        proto = MyProto(self.loop)
+        f = self.loop.create_server(lambda: proto, '127.0.0.1', 0,
+                                    min_read_size=16, max_read_size=64)
+        server = self.loop.run_until_complete(f)
+        port = server.sockets[0].getsockname()[1]
+
+        client = socket.socket()
+        client.connect(('127.0.0.1', port))
+        self.loop.run_until_complete(proto.connected)
+        transport = proto.transport
+        self.assertEqual((transport._min_read_size, transport._max_read_size),
+                         (16, 64))
+
+        client.sendall(b'x' * 1000)
+        test_utils.run_until(self.loop, lambda: proto.nbytes >= 1000)
+        self.assertEqual(1000, proto.nbytes)
+
+        transport.close()
+        self.loop.run_until_complete(proto.done)
+        client.close()
+        server.close()
+
     def _make_unix_server(self, factory, **kwargs):
         path = test_utils.gen_unix_socket_path()
         self.addCleanup(lambda: os.path.exists(path) and os.unlink(path))
@@ -1075,6 +1139,31 @@ def test_create_server_addr_in_use(self):
 
         server.close()
 
+    @unittest.skipUnless(hasattr(socket, 'SO_REUSEPORT'),
+                         'need socket.SO_REUSEPORT')
+    def test_create_server_reuse_port(self):
+        f = self.loop.create_server(MyProto, '127.0.0.1', 0)
+        server = self.loop.run_until_complete(f)
+        sock = server.sockets[0]
+        self.assertFalse(sock.getsockopt(socket.SOL_SOCKET,
+                                         socket.SO_REUSEPORT))
+        server.close()
+
+        f = self.loop.create_server(MyProto, '127.0.0.1', 0,
+                                    reuse_port=True)
+        server = self.loop.run_until_complete(f)
+        sock = server.sockets[0]
+        self.assertTrue(sock.getsockopt(socket.SOL_SOCKET,
+                                        socket.SO_REUSEPORT))
+        host, port = sock.getsockname()[:2]
+
+        # a second server can listen on the same port
+        f = self.loop.create_server(MyProto, host, port, reuse_port=True)
+        server2 = self.loop.run_until_complete(f)
+        self.assertEqual(server2.sockets[0].getsockname()[:2], (host, port))
+        server2.close()
+        server.close()
+
     @unittest.skipUnless(support.IPV6_ENABLED, 'IPv6 not supported or enabled')
     def test_create_server_dual_stack(self):
         f_proto = asyncio.Future(loop=self.loop)
@@ -1180,6 +1269,36 @@ def datagram_received(self, data, addr):
         self.assertEqual('CLOSED', client.state)
         server.transport.close()
 
+    def test_create_datagram_endpoint_batch(self):
+        class BatchProto(MyDatagramProto):
+            def __init__(inner_self):
+                super().__init__(loop=self.loop)
+                inner_self.batches = []
+
+            def datagrams_received(inner_self, datagrams):
+                inner_self.batches.append(datagrams)
+                super().datagrams_received(datagrams)
+
+        coro = self.loop.create_datagram_endpoint(
+            BatchProto, local_addr=('127.0.0.1', 0))
+        s_transport, server = self.loop.run_until_complete(coro)
+        address = s_transport.get_extra_info('sockname')
+
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+            sock.bind(('127.0.0.1', 0))
+            for i in range(10):
+                sock.sendto(('data%d' % i).encode(), address)
+            local_address = sock.getsockname()
+            test_utils.run_until(self.loop, lambda: server.nbytes == 50)
+
+        datagrams = [datagram for batch in server.batches
+                     for datagram in batch]
+        self.assertEqual(datagrams,
+                         [(('data%d' % i).encode(), local_address)
+                          for i in range(10)])
+        s_transport.close()
+        self.loop.run_until_complete(server.done)
+
     def test_internal_fds(self):
         loop = self.create_event_loop()
         if not isinstance(loop, selector_events.BaseSelectorEventLoop):
@@ -1849,10 +1968,6 @@ def test_writer_callback(self):
         def test_writer_callback_cancel(self):
             raise unittest.SkipTest("IocpEventLoop does not have add_writer()")
 
-        def test_create_datagram_endpoint(self):
-            raise unittest.SkipTest(
-                "IocpEventLoop does not have create_datagram_endpoint()")
-
         def test_remove_fds_after_closing(self):
             raise unittest.SkipTest("IocpEventLoop does not have add_reader()")
 else:
@@ -1902,6 +2017,14 @@ class EPollEventLoopTests(UnixEventLoopTestsMixin,
             def create_event_loop(self):
                 return asyncio.SelectorEventLoop(selectors.EpollSelector())
 
+        class BatchedEPollEventLoopTests(UnixEventLoopTestsMixin,
+                                         SubprocessTestsMixin,
+                                         test_utils.TestCase):
+
+            def create_event_loop(self):
+                return asyncio.SelectorEventLoop(
+                    selectors.BatchedEpollSelector())
+
     if hasattr(selectors, 'PollSelector'):
         class PollEventLoopTests(UnixEventLoopTestsMixin,
                                  SubprocessTestsMixin,
@@ -2069,6 +2192,94 @@ def check_source_traceback(h):
         check_source_traceback(h)
 
 
+class BaseHandleTestsMixin:
+    """Tests of the hot paths implemented by _PyHandle and _speedups."""
+
+    def setUp(self):
+        self.loop = mock.Mock()
+        self.loop.get_debug.return_value = False
+        self.reported = reported = []
+
+        class MyHandle(self.handle_base):
+            __slots__ = ()
+
+            def __repr__(self):
+                return '<MyHandle>'
+
+            def _report_exception(self, exc):
+                reported.append(exc)
+
+        self.handle_class = MyHandle
+
+    def test_run(self):
+        calls = []
+        h = self.handle_class(calls.append, (1,), self.loop)
+        self.assertIs(h._loop, self.loop)
+        self.assertIsNone(h._source_traceback)
+        self.assertIsNone(h._repr)
+        h._run()
+        h._run()
+        self.assertEqual(calls, [1, 1])
+
+        # any iterable is accepted as arguments
+        h = self.handle_class(calls.append, [2], self.loop)
+        h._run()
+        self.assertEqual(calls, [1, 1, 2])
+
+    def test_run_exception(self):
+        def callback():
+            raise ValueError('err')
+
+        h = self.handle_class(callback, (), self.loop)
+        h._run()
+        exc, = self.reported
+        self.assertIsInstance(exc, ValueError)
+        self.assertIsNotNone(exc.__traceback__)
+
+        # BaseException is not reported
+        h = self.handle_class(sys.exit, (), self.loop)
+        self.assertRaises(SystemExit, h._run)
+        self.assertEqual(len(self.reported), 1)
+
+    def test_cancel(self):
+        h = self.handle_class(noop, (), self.loop)
+        h.cancel()
+        self.assertTrue(h._cancelled)
+        self.assertIsNone(h._callback)
+        self.assertIsNone(h._args)
+        self.assertIsNone(h._repr)
+
+        self.loop.get_debug.return_value = True
+        h = self.handle_class(noop, (), self.loop)
+        self.assertIsInstance(h._source_traceback, list)
+        h.cancel()
+        self.assertEqual(h._repr, '<MyHandle>')
+
+    def test_cancel_from_callback(self):
+        def callback():
+            h.cancel()
+
+        h = self.handle_class(callback, (), self.loop)
+        h._run()
+        self.assertTrue(h._cancelled)
+        self.assertEqual(self.reported, [])
+
+    def test_handle_from_handle(self):
+        h = asyncio.Handle(noop, (), self.loop)
+        self.assertRaises(AssertionError,
+                          self.handle_class, h, (), self.loop)
+
+
+class PyHandleTests(BaseHandleTestsMixin, test_utils.TestCase):
+    handle_base = events._PyHandle
+
+
+@unittest.skipIf(events._speedups is None, 'need the _speedups extension')
+class CHandleTests(BaseHandleTestsMixin, test_utils.TestCase):
+    if events._speedups is not None:
+        handle_base = events._speedups.Handle
+
+
 class TimerTests(unittest.TestCase):
 
     def setUp(self):
@@ -2231,6 +2442,8 @@ def test_not_implemented(self):
             NotImplementedError, loop.remove_writer, 1)
         self.assertRaises(
             NotImplementedError, loop.sock_recv, f, 10)
+        self.assertRaises(
+            NotImplementedError, loop.sock_recv_into, f, f)
         self.assertRaises(
             NotImplementedError, loop.sock_sendall, f, 10)
         self.assertRaises(
@@ -2281,6 +2494,7 @@ def test_empty(self):
         self.assertIsNone(dp.connection_lost(f))
         self.assertIsNone(dp.error_received(f))
         self.assertIsNone(dp.datagram_received(f, f))
+        self.assertIsNone(dp.datagrams_received([(f, f)]))
 
         sp = asyncio.SubprocessProtocol()
         self.assertIsNone(sp.connection_made(f))
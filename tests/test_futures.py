@@ -8,6 +8,7 @@
 from unittest import mock
 
 import asyncio
+from asyncio import futures
 from asyncio import test_utils
 try:
     from test import support
@@ -25,6 +26,17 @@ def last_cb():
     pass
 
 
+class PyFuture(futures._PyFuture):
+    pass
+
+
+if futures._speedups is not None:
+    class CFuture(futures._speedups.Future):
+        pass
+else:
+    CFuture = None
+
+
 class FutureTests(test_utils.TestCase):
 
     def setUp(self):
@@ -469,5 +481,118 @@ def test_remove_done_callback(self):
         self.assertEqual(f.result(), 'foo')
 
 
+class BaseFutureTestsMixin:
+    """Tests of the hot paths implemented by _PyFuture and _speedups."""
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+
+    def test_initial_state(self):
+        f = self.future_class(loop=self.loop)
+        self.assertIs(f._loop, self.loop)
+        self.assertEqual(f._state, futures._PENDING)
+        self.assertEqual(f._callbacks, [])
+        self.assertFalse(f.done())
+        self.assertFalse(f.cancelled())
+        self.assertRaises(asyncio.InvalidStateError, f.result)
+        self.assertRaises(asyncio.InvalidStateError, f.exception)
+
+    def test_default_loop(self):
+        asyncio.set_event_loop(self.loop)
+        f = self.future_class()
+        self.assertIs(f._loop, self.loop)
+        self.assertRaises(TypeError, self.future_class, self.loop)
+
+    def test_set_result(self):
+        f = self.future_class(loop=self.loop)
+        f.set_result(42)
+        self.assertEqual(f._state, futures._FINISHED)
+        self.assertTrue(f.done())
+        self.assertEqual(f.result(), 42)
+        self.assertIsNone(f.exception())
+        self.assertRaises(asyncio.InvalidStateError, f.set_result, 1)
+        self.assertRaises(asyncio.InvalidStateError,
+                          f.set_exception, ValueError)
+        self.assertFalse(f.cancel())
+
+    def test_set_exception(self):
+        f = self.future_class(loop=self.loop)
+        f.set_exception(ValueError)
+        self.assertIsInstance(f.exception(), ValueError)
+        self.assertRaises(ValueError, f.result)
+
+        f = self.future_class(loop=self.loop)
+        exc = RuntimeError('err')
+        f.set_exception(exc)
+        self.assertTrue(f._log_traceback)
+        self.assertIs(f.exception(), exc)
+        self.assertFalse(f._log_traceback)
+
+    def test_cancel(self):
+        f = self.future_class(loop=self.loop)
+        self.assertTrue(f.cancel())
+        self.assertTrue(f.cancelled())
+        self.assertTrue(f.done())
+        self.assertFalse(f.cancel())
+        self.assertRaises(asyncio.CancelledError, f.result)
+        self.assertRaises(asyncio.CancelledError, f.exception)
+        self.assertRaises(asyncio.InvalidStateError, f.set_result, 1)
+
+        f._set_result_unless_cancelled(2)
+        self.assertTrue(f.cancelled())
+
+    def test_callbacks(self):
+        bag = []
+        f = self.future_class(loop=self.loop)
+        f.add_done_callback(bag.append)
+        f.add_done_callback(bag.append)
+        self.assertEqual(f.remove_done_callback(bag.append), 2)
+        f.add_done_callback(bag.append)
+        f._set_result_unless_cancelled('foo')
+        self.assertEqual(f._callbacks, [])
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(bag, [f])
+
+        # the future is done: the callback is scheduled immediately
+        f.add_done_callback(bag.append)
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(bag, [f, f])
+
+    def test_overridden_methods(self):
+        calls = []
+
+        class MyFuture(self.future_class):
+            def _schedule_callbacks(self):
+                calls.append('schedule')
+                super()._schedule_callbacks()
+
+            def set_result(self, result):
+                calls.append('set_result')
+                super().set_result(result)
+
+        f = MyFuture(loop=self.loop)
+        f._set_result_unless_cancelled(1)
+        self.assertEqual(calls, ['set_result', 'schedule'])
+        f = MyFuture(loop=self.loop)
+        f.cancel()
+        self.assertEqual(calls, ['set_result', 'schedule', 'schedule'])
+
+    def test_source_traceback(self):
+        self.loop.set_debug(True)
+        f = self.future_class(loop=self.loop)
+        lineno = sys._getframe().f_lineno - 1
+        self.assertEqual(f._source_traceback[-1][:3],
+                         (__file__, lineno, 'test_source_traceback'))
+
+
+class PyFutureBaseTests(BaseFutureTestsMixin, test_utils.TestCase):
+    future_class = PyFuture
+
+
+@unittest.skipIf(CFuture is None, 'need the _speedups extension')
+class CFutureBaseTests(BaseFutureTestsMixin, test_utils.TestCase):
+    future_class = CFuture
+
+
 if __name__ == '__main__':
     unittest.main()
@@ -0,0 +1,221 @@
+"""Tests for pools.py"""
+
+import unittest
+from unittest import mock
+
+import asyncio
+from asyncio import test_utils
+
+
+def make_connection():
+    transport = mock.Mock(asyncio.Transport)
+    transport.is_closing.return_value = False
+    protocol = mock.Mock(asyncio.Protocol)
+    return transport, protocol
+
+
+class ConnectionPoolTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+        self.pool = asyncio.ConnectionPool(max_idle=2, idle_timeout=60.0,
+                                           loop=self.loop)
+
+    def register(self, key='key'):
+        transport, protocol = make_connection()
+        self.pool._register(key, transport, protocol)
+        return transport, protocol
+
+    def test_ctor(self):
+        self.assertRaises(ValueError, asyncio.ConnectionPool,
+                          max_idle=-1, loop=self.loop)
+        self.assertEqual(len(self.pool), 0)
+        self.assertIn('idle=0', repr(self.pool))
+
+    def test_release(self):
+        conn1 = self.register()
+        conn2 = self.register()
+        conn3 = self.register('other')
+        self.assertIsNone(self.pool._acquire('key'))
+
+        self.pool.release(conn1[0])
+        self.pool.release(conn2[0])
+        self.pool.release(conn3[0])
+        self.assertEqual(len(self.pool), 3)
+
+        # the most recently released connection is reused first
+        self.assertEqual(self.pool._acquire('key'), conn2)
+        self.assertEqual(self.pool._acquire('key'), conn1)
+        self.assertIsNone(self.pool._acquire('key'))
+        self.assertEqual(self.pool._acquire('other'), conn3)
+        self.assertEqual(len(self.pool), 0)
+        self.assertFalse(conn1[0].close.called)
+
+        # unknown transport
+        transport, protocol = make_connection()
+        self.assertRaises(ValueError, self.pool.release, transport)
+
+    def test_release_full(self):
+        conns = [self.register() for i in range(3)]
+        for transport, protocol in conns:
+            self.pool.release(transport)
+        self.assertEqual(len(self.pool), 2)
+        self.assertFalse(conns[1][0].close.called)
+        self.assertTrue(conns[2][0].close.called)
+
+    def test_closing_transport(self):
+        transport, protocol = self.register()
+        transport.is_closing.return_value = True
+        self.pool.release(transport)
+        self.assertEqual(len(self.pool), 0)
+
+        # a connection closed while idle is not reused
+        transport, protocol = self.register()
+        self.pool.release(transport)
+        transport.is_closing.return_value = True
+        self.assertIsNone(self.pool._acquire('key'))
+
+    def test_idle_timeout(self):
+        conn1 = self.register()
+        conn2 = self.register()
+        self.pool.release(conn1[0])
+        self.loop.advance_time(30)
+        self.pool.release(conn2[0])
+
+        self.assertIsNotNone(self.pool._expire_handle)
+        self.loop.advance_time(31)
+        self.pool._expire()
+        self.assertTrue(conn1[0].close.called)
+        self.assertFalse(conn2[0].close.called)
+        self.assertEqual(len(self.pool), 1)
+        # the next expiration is scheduled
+        self.assertEqual(self.pool._expire_handle._when, 90)
+
+        self.loop.advance_time(30)
+        self.pool._expire()
+        self.assertTrue(conn2[0].close.called)
+        self.assertEqual(len(self.pool), 0)
+        self.assertIsNone(self.pool._expire_handle)
+
+    def test_close(self):
+        conn1 = self.register()
+        conn2 = self.register()
+        self.pool.release(conn1[0])
+        self.pool.close()
+        self.assertTrue(conn1[0].close.called)
+        self.assertEqual(len(self.pool), 0)
+        self.assertIn('closed', repr(self.pool))
+
+        # connections released after close() are closed
+        self.pool.release(conn2[0])
+        self.assertTrue(conn2[0].close.called)
+        self.assertIsNone(self.pool._acquire('key'))
+
+
+class ConnectionPoolStreamTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = asyncio.new_event_loop()
+        self.set_event_loop(self.loop)
+        self.clients = 0
+
+    @asyncio.coroutine
+    def handle_client(self, reader, writer):
+        self.clients += 1
+        try:
+            while True:
+                line = yield from reader.readline()
+                if not line or line == b'close\n':
+                    break
+                writer.write(line.upper())
+            writer.close()
+        finally:
+            self.clients -= 1
+
+    def test_open_connection(self):
+        server = self.loop.run_until_complete(
+            asyncio.start_server(self.handle_client, '127.0.0.1', 0,
+                                 loop=self.loop))
+        self.addCleanup(server.close)
+        address = server.sockets[0].getsockname()
+        pool = asyncio.ConnectionPool(loop=self.loop)
+        self.addCleanup(pool.close)
+
+        @asyncio.coroutine
+        def request(data):
+            reader, writer = yield from asyncio.open_connection(
+                *address, loop=self.loop, pool=pool)
+            writer.write(data)
+            response = yield from reader.readline()
+            return writer.transport, response
+
+        transport1, response = self.loop.run_until_complete(
+            request(b'hello\n'))
+        self.assertEqual(response, b'HELLO\n')
+        pool.release(transport1)
+
+        # the connection is reused
+        transport2, response = self.loop.run_until_complete(
+            request(b'world\n'))
+        self.assertEqual(response, b'WORLD\n')
+        self.assertIs(transport2, transport1)
+        self.assertEqual(len(pool), 0)
+
+        # the server closed the idle connection: a new one is created
+        transport2.write(b'close\n')
+        pool.release(transport2)
+        test_utils.run_until(self.loop,
+                             lambda: transport2._protocol._stream_reader._eof)
+        transport3, response = self.loop.run_until_complete(
+            request(b'again\n'))
+        self.assertEqual(response, b'AGAIN\n')
+        self.assertIsNot(transport3, transport1)
+        self.assertTrue(transport1.is_closing())
+        transport3.close()
+        test_utils.run_until(self.loop, lambda: not self.clients)
+
+    def test_open_connection_other_protocol(self):
+        server = self.loop.run_until_complete(
+            asyncio.start_server(self.handle_client, '127.0.0.1', 0,
+                                 loop=self.loop))
+        self.addCleanup(server.close)
+        address = server.sockets[0].getsockname()
+        pool = asyncio.ConnectionPool(loop=self.loop)
+        self.addCleanup(pool.close)
+
+        # idle connection created with a protocol which is not a
+        # StreamReaderProtocol
+        transport1, protocol1 = self.loop.run_until_complete(
+            self.loop.create_connection(asyncio.Protocol, *address,
+                                        pool=pool))
+        pool.release(transport1)
+
+        # open_connection() doesn't reuse it, but leaves it in the pool
+        reader, writer = self.loop.run_until_complete(
+            asyncio.open_connection(*address, loop=self.loop, pool=pool))
+        self.assertIsNot(writer.transport, transport1)
+        self.assertFalse(transport1.is_closing())
+        self.assertEqual(len(pool), 1)
+        writer.write(b'hello\n')
+        self.assertEqual(self.loop.run_until_complete(reader.readline()),
+                         b'HELLO\n')
+        writer.close()
+
+        # create_connection() still reuses it
+        transport2, protocol2 = self.loop.run_until_complete(
+            self.loop.create_connection(asyncio.Protocol, *address,
+                                        pool=pool))
+        self.assertIs(transport2, transport1)
+        self.assertIs(protocol2, protocol1)
+        transport2.close()
+        test_utils.run_until(self.loop, lambda: not self.clients)
+
+    def test_pool_with_sock(self):
+        pool = asyncio.ConnectionPool(loop=self.loop)
+        coro = self.loop.create_connection(asyncio.Protocol, sock=object(),
+                                           pool=pool)
+        self.assertRaises(ValueError, self.loop.run_until_complete, coro)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -3,12 +3,19 @@
 import socket
 import unittest
 from unittest import mock
+try:
+    import ssl
+except ImportError:
+    ssl = None
 
 import asyncio
+from asyncio import sslproto
 from asyncio.proactor_events import BaseProactorEventLoop
 from asyncio.proactor_events import _ProactorSocketTransport
+from asyncio.proactor_events import _ProactorSSLTransport
 from asyncio.proactor_events import _ProactorWritePipeTransport
 from asyncio.proactor_events import _ProactorDuplexPipeTransport
+from asyncio.proactor_events import _ProactorDatagramTransport
 from asyncio import test_utils
 
 
@@ -43,28 +50,91 @@ def test_ctor(self):
         test_utils.run_briefly(self.loop)
         self.assertIsNone(fut.result())
         self.protocol.connection_made(tr)
-        self.proactor.recv.assert_called_with(self.sock, 4096)
+        self.proactor.recv_into.assert_called_with(self.sock, tr._read_buffer)
 
     def test_loop_reading(self):
         tr = self.socket_transport()
         tr._loop_reading()
-        self.loop._proactor.recv.assert_called_with(self.sock, 4096)
+        self.loop._proactor.recv_into.assert_called_with(self.sock,
+                                                         tr._read_buffer)
         self.assertFalse(self.protocol.data_received.called)
         self.assertFalse(self.protocol.eof_received.called)
 
     def test_loop_reading_data(self):
         res = asyncio.Future(loop=self.loop)
-        res.set_result(b'data')
+        res.set_result(4)
 
         tr = self.socket_transport()
+        tr._read_buffer[:4] = b'data'
         tr._read_fut = res
         tr._loop_reading(res)
-        self.loop._proactor.recv.assert_called_with(self.sock, 4096)
+        self.loop._proactor.recv_into.assert_called_with(self.sock,
+                                                         tr._read_buffer)
         self.protocol.data_received.assert_called_with(b'data')
 
+    def test_loop_reading_reuse_buffer(self):
+        tr = self.socket_transport()
+        buf = tr._read_buffer
+        for data in (b'data1', b'data2'):
+            res = asyncio.Future(loop=self.loop)
+            res.set_result(len(data))
+            buf[:len(data)] = data
+            tr._read_fut = res
+            tr._loop_reading(res)
+            self.protocol.data_received.assert_called_with(data)
+            # the data passed to the protocol is a copy
+            self.assertIsInstance(self.protocol.data_received.call_args[0][0],
+                                  bytes)
+        self.assertIs(tr._read_buffer, buf)
+        self.assertEqual(self.loop._proactor.recv_into.call_count, 2)
+
+    def test_stats(self):
+        tr = self.socket_transport()
+        for nbytes in (4, 3):
+            res = asyncio.Future(loop=self.loop)
+            res.set_result(nbytes)
+            tr._read_fut = res
+            tr._loop_reading(res)
+
+        tr._buffer = [b'head', b'body']
+        tr._loop_writing()
+        tr.pause_reading()
+
+        stats = tr.get_extra_info('stats')
+        self.assertEqual(stats['bytes_received'], 7)
+        self.assertEqual(stats['reads'], 2)
+        # the write is counted when the operation is submitted
+        self.assertEqual(stats['bytes_sent'], 8)
+        self.assertEqual(stats['writes'], 1)
+        self.assertEqual(stats['reading_pauses'], 1)
+        self.assertEqual(stats['reading_resumes'], 0)
+
+    def test_loop_reading_adaptive_size(self):
+        tr = _ProactorSocketTransport(self.loop, self.sock, self.protocol,
+                                      read_size_limits=(1024, 4096))
+        self.addCleanup(close_transport, tr)
+        self.assertEqual(len(tr._read_buffer), 1024)
+
+        # a read filling the buffer grows it
+        res = asyncio.Future(loop=self.loop)
+        res.set_result(1024)
+        tr._read_fut = res
+        tr._loop_reading(res)
+        self.assertEqual(len(tr._read_buffer), 2048)
+        self.loop._proactor.recv_into.assert_called_with(self.sock,
+                                                         tr._read_buffer)
+
+        # a small read shrinks it
+        res = asyncio.Future(loop=self.loop)
+        res.set_result(10)
+        tr._read_fut = res
+        tr._loop_reading(res)
+        self.assertEqual(len(tr._read_buffer), 1024)
+        self.protocol.data_received.assert_called_with(bytes(10))
+
     def test_loop_reading_no_data(self):
         res = asyncio.Future(loop=self.loop)
-        res.set_result(b'')
+        res.set_result(0)
 
         tr = self.socket_transport()
         self.assertRaises(AssertionError, tr._loop_reading, res)
@@ -72,12 +142,13 @@ def test_loop_reading_no_data(self):
         tr.close = mock.Mock()
         tr._read_fut = res
         tr._loop_reading(res)
-        self.assertFalse(self.loop._proactor.recv.called)
+        self.assertFalse(self.loop._proactor.recv_into.called)
         self.assertTrue(self.protocol.eof_received.called)
         self.assertTrue(tr.close.called)
 
     def test_loop_reading_aborted(self):
-        err = self.loop._proactor.recv.side_effect = ConnectionAbortedError()
+        err = ConnectionAbortedError()
+        self.loop._proactor.recv_into.side_effect = err
 
         tr = self.socket_transport()
         tr._fatal_error = mock.Mock()
@@ -87,7 +158,7 @@ def test_loop_reading_aborted(self):
                             'Fatal read error on pipe transport')
 
     def test_loop_reading_aborted_closing(self):
-        self.loop._proactor.recv.side_effect = ConnectionAbortedError()
+        self.loop._proactor.recv_into.side_effect = ConnectionAbortedError()
 
         tr = self.socket_transport()
         tr._closing = True
@@ -96,7 +167,7 @@ def test_loop_reading_aborted_closing(self):
         self.assertFalse(tr._fatal_error.called)
 
     def test_loop_reading_aborted_is_fatal(self):
-        self.loop._proactor.recv.side_effect = ConnectionAbortedError()
+        self.loop._proactor.recv_into.side_effect = ConnectionAbortedError()
         tr = self.socket_transport()
         tr._closing = False
         tr._fatal_error = mock.Mock()
@@ -104,7 +175,8 @@ def test_loop_reading_aborted_is_fatal(self):
         self.assertTrue(tr._fatal_error.called)
 
     def test_loop_reading_conn_reset_lost(self):
-        err = self.loop._proactor.recv.side_effect = ConnectionResetError()
+        err = ConnectionResetError()
+        self.loop._proactor.recv_into.side_effect = err
 
         tr = self.socket_transport()
         tr._closing = False
@@ -115,7 +187,7 @@ def test_loop_reading_conn_reset_lost(self):
         tr._force_close.assert_called_with(err)
 
     def test_loop_reading_exception(self):
-        err = self.loop._proactor.recv.side_effect = (OSError())
+        err = self.loop._proactor.recv_into.side_effect = (OSError())
 
         tr = self.socket_transport()
         tr._fatal_error = mock.Mock()
@@ -141,9 +213,113 @@ def test_write_more(self):
         tr._write_fut = mock.Mock()
         tr._loop_writing = mock.Mock()
         tr.write(b'data')
-        self.assertEqual(tr._buffer, b'data')
+        self.assertEqual(tr._buffer, [b'data'])
+        self.assertFalse(tr._loop_writing.called)
+
+        # small writes are appended to the same buffer
+        tr.write(b'more')
+        self.assertEqual(tr._buffer, [b'datamore'])
+
+    def test_writelines(self):
+        tr = self.socket_transport()
+        tr._loop_writing = mock.Mock()
+        tr.writelines([b'head', b'', bytearray(b'body')])
+        self.assertEqual(tr._buffer, None)
+        tr._loop_writing.assert_called_with(data=[b'head', b'body'])
+
+    def test_writelines_more(self):
+        tr = self.socket_transport()
+        tr._write_fut = mock.Mock()
+        tr._loop_writing = mock.Mock()
+        header = b'head'
+        tr.writelines([header, b'body'])
+        tr.write(b'da')
+        tr.write(b'ta')
+        self.assertEqual(tr._buffer, [b'head', b'body', b'data'])
+        # immutable buffers are not copied
+        self.assertIs(tr._buffer[0], header)
+        self.assertEqual(tr.get_write_buffer_size(), 12)
         self.assertFalse(tr._loop_writing.called)
 
+    def test_writelines_str(self):
+        tr = self.socket_transport()
+        self.assertRaises(TypeError, tr.writelines, [b'data', 'str'])
+
+    def test_write_corked(self):
+        tr = self.socket_transport()
+        tr.set_corked(True)
+        header = b'head'
+        tr.write(header)
+        tr.writelines([b'bo', bytearray(b'dy')])
+        tr.write(bytearray(b'tail'))
+        self.assertFalse(self.proactor.send.called)
+        self.assertFalse(self.proactor.send_buffers.called)
+        self.assertEqual(tr.get_write_buffer_size(), 12)
+        self.assertIs(tr._buffer[0], header)
+
+        # the data written during the iteration is sent at once
+        self.proactor.send_buffers.return_value.done.return_value = False
+        test_utils.run_briefly(self.loop)
+        self.proactor.send_buffers.assert_called_once_with(
+            self.sock, [b'head', b'bo', b'dy', b'tail'])
+        self.assertIsNone(tr._buffer)
+        self.assertIsNone(tr._cork_handle)
+
+        # writes during the send are queued as usual
+        tr.write(b'more')
+        self.assertEqual(tr._buffer, [b'more'])
+        self.assertIsNone(tr._cork_handle)
+
+    def test_flush(self):
+        tr = self.socket_transport()
+        tr.set_corked(True)
+        tr.write(b'data')
+        handle = tr._cork_handle
+        tr.flush()
+        self.assertTrue(handle._cancelled)
+        self.assertIsNone(tr._cork_handle)
+        self.proactor.send.assert_called_once_with(self.sock, b'data')
+
+    def test_set_corked_false_flushes(self):
+        tr = self.socket_transport()
+        tr.set_corked(True)
+        tr.write(b'data')
+        tr.set_corked(False)
+        self.proactor.send.assert_called_once_with(self.sock, b'data')
+
+    def test_write_corked_close(self):
+        self.proactor.send.return_value.done.return_value = False
+        tr = self.socket_transport()
+        tr.set_corked(True)
+        tr.write(b'data')
+        tr.close()
+        test_utils.run_briefly(self.loop)
+        self.proactor.send.assert_called_once_with(self.sock, b'data')
+        self.assertFalse(self.protocol.connection_lost.called)
+
+    def test_write_corked_write_eof(self):
+        tr = self.socket_transport()
+        tr.set_corked(True)
+        tr.write(b'data')
+        tr.write_eof()
+        # the socket is shut down once the corked buffer is sent
+        self.assertFalse(self.sock.shutdown.called)
+        test_utils.run_briefly(self.loop)
+        self.proactor.send.assert_called_once_with(self.sock, b'data')
+        self.assertFalse(self.sock.shutdown.called)
+        tr._loop_writing(self.proactor.send.return_value)
+        self.sock.shutdown.assert_called_with(socket.SHUT_WR)
+
+    def test_write_corked_abort(self):
+        tr = self.socket_transport()
+        tr.set_corked(True)
+        tr.write(b'data')
+        handle = tr._cork_handle
+        tr.abort()
+        self.assertTrue(handle._cancelled)
+        test_utils.run_briefly(self.loop)
+        self.assertFalse(self.proactor.send.called)
+
     def test_loop_writing(self):
         tr = self.socket_transport()
         tr._buffer = bytearray(b'data')
@@ -152,9 +328,19 @@ def test_loop_writing(self):
         self.loop._proactor.send.return_value.add_done_callback.\
             assert_called_with(tr._loop_writing)
 
+    def test_loop_writing_buffers(self):
+        tr = self.socket_transport()
+        tr._buffer = [b'head', b'body']
+        tr._loop_writing()
+        self.loop._proactor.send_buffers.assert_called_with(
+            self.sock, [b'head', b'body'])
+        self.assertFalse(self.loop._proactor.send.called)
+        self.loop._proactor.send_buffers.return_value.add_done_callback.\
+            assert_called_with(tr._loop_writing)
+
     @mock.patch('asyncio.proactor_events.logger')
     def test_loop_writing_err(self, m_log):
-        err = self.loop._proactor.send.side_effect = OSError()
+        err = self.loop._proactor.send_buffers.side_effect = OSError()
         tr = self.socket_transport()
         tr._fatal_error = mock.Mock()
         tr._buffer = [b'da', b'ta']
@@ -201,10 +387,12 @@ def test_abort(self):
 
     def test_close(self):
         tr = self.socket_transport()
+        self.assertFalse(tr.is_closing())
         tr.close()
         test_utils.run_briefly(self.loop)
         self.protocol.connection_lost.assert_called_with(None)
         self.assertTrue(tr._closing)
+        self.assertTrue(tr.is_closing())
         self.assertEqual(tr._conn_lost, 1)
 
         self.protocol.connection_lost.reset_mock()
@@ -270,6 +458,25 @@ def test_call_connection_lost(self):
         self.assertTrue(self.protocol.connection_lost.called)
         self.assertTrue(self.sock.close.called)
 
+    def test_call_connection_lost_recycle(self):
+        server = mock.Mock()
+        tr = _ProactorSocketTransport(self.loop, self.sock, self.protocol,
+                                      server=server)
+        self.proactor.recycle_accept_socket.return_value = True
+        tr._call_connection_lost(None)
+        self.proactor.recycle_accept_socket.assert_called_with(self.sock)
+        self.assertFalse(self.sock.shutdown.called)
+        self.assertFalse(self.sock.close.called)
+        self.assertTrue(server._detach.called)
+
+        # the proactor doesn't reuse the socket: close it
+        tr = _ProactorSocketTransport(self.loop, self.sock, self.protocol,
+                                      server=server)
+        self.proactor.recycle_accept_socket.return_value = False
+        tr._call_connection_lost(None)
+        self.assertTrue(self.sock.shutdown.called)
+        self.assertTrue(self.sock.close.called)
+
     def test_write_eof(self):
         tr = self.socket_transport()
         self.assertTrue(tr.can_write_eof())
@@ -327,13 +534,17 @@ def test_write_eof_duplex_pipe(self):
         close_transport(tr)
 
     def test_pause_resume_reading(self):
-        tr = self.socket_transport()
-        futures = []
-        for msg in [b'data1', b'data2', b'data3', b'data4', b'']:
+        msgs = [b'data1', b'data2', b'data3', b'data4', b'']
+
+        def recv_into(sock, buf):
+            msg = msgs.pop(0)
+            buf[:len(msg)] = msg
             f = asyncio.Future(loop=self.loop)
-            f.set_result(msg)
-            futures.append(f)
-        self.loop._proactor.recv.side_effect = futures
+            f.set_result(len(msg))
+            return f
+
+        tr = self.socket_transport()
+        self.loop._proactor.recv_into.side_effect = recv_into
         self.loop._run_once()
         self.assertFalse(tr._paused)
         self.loop._run_once()
@@ -433,6 +644,332 @@ def test_dont_pause_writing(self):
         self.assertFalse(self.protocol.pause_writing.called)
 
 
+@unittest.skipIf(ssl is None, 'No ssl module')
+@unittest.skipUnless(sslproto._is_sslproto_available(), 'need ssl.MemoryBIO')
+class ProactorSSLTransportTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+        self.addCleanup(self.loop.close)
+        self.proactor = mock.Mock()
+        self.proactor.send.side_effect = self.send
+        self.proactor.recv_into.side_effect = self.recv_into
+        self.loop._proactor = self.proactor
+        self.protocol = test_utils.make_test_protocol(asyncio.Protocol)
+        self.sock = mock.Mock(socket.socket)
+        self.sent = []
+        self.read_fut = None
+        self.server = sslproto._SSLPipe(test_utils.server_ssl_context(), True)
+
+    def send(self, sock, data):
+        self.sent.append(bytes(data))
+        fut = asyncio.Future(loop=self.loop)
+        fut.set_result(len(data))
+        return fut
+
+    def recv_into(self, sock, buf):
+        self.read_fut = asyncio.Future(loop=self.loop)
+        self.read_buffer = buf
+        return self.read_fut
+
+    def feed(self, data):
+        # Complete the pending reads of the transport with data
+        while True:
+            fut = self.read_fut
+            self.read_fut = None
+            nbytes = min(len(data), len(self.read_buffer))
+            self.read_buffer[:nbytes] = data[:nbytes]
+            fut.set_result(nbytes)
+            test_utils.run_briefly(self.loop)
+            data = data[nbytes:]
+            if not data:
+                break
+
+    def exchange(self):
+        # Pass the records between the transport and the server until
+        # both sides are idle, return the plaintext received by the server
+        appdata = []
+        while True:
+            test_utils.run_briefly(self.loop)
+            records = self.sent
+            self.sent = []
+            ssldata = []
+            for data in records:
+                out, app = self.server.feed_ssldata(data)
+                ssldata.extend(out)
+                appdata.extend(app)
+            if ssldata:
+                self.feed(b''.join(ssldata))
+            elif not records:
+                return b''.join(appdata)
+
+    def ssl_transport(self, waiter=None, sslcontext=None):
+        if sslcontext is None:
+            sslcontext = test_utils.dummy_ssl_context()
+        transport = _ProactorSSLTransport(self.loop, self.sock, self.protocol,
+                                          sslcontext, waiter=waiter)
+        self.addCleanup(close_transport, transport)
+        return transport
+
+    def connect(self):
+        waiter = asyncio.Future(loop=self.loop)
+        tr = self.ssl_transport(waiter=waiter)
+        self.server.do_handshake()
+        self.exchange()
+        self.assertTrue(waiter.done())
+        self.assertIsNone(waiter.result())
+        return tr
+
+    def test_handshake(self):
+        waiter = asyncio.Future(loop=self.loop)
+        tr = self.ssl_transport(waiter=waiter)
+        test_utils.run_briefly(self.loop)
+        # the client hello has been sent
+        self.assertEqual(len(self.sent), 1)
+        self.assertFalse(self.protocol.connection_made.called)
+        self.assertFalse(waiter.done())
+
+        self.server.do_handshake()
+        self.exchange()
+        self.assertIsNone(waiter.result())
+        self.protocol.connection_made.assert_called_with(tr)
+        self.assertTrue(self.server.wrapped)
+        self.assertIsNotNone(tr.get_extra_info('cipher'))
+        self.assertIsInstance(tr.get_extra_info('sslcontext'), ssl.SSLContext)
+        self.assertIs(tr.get_extra_info('socket'), self.sock)
+        self.assertFalse(tr.can_write_eof())
+
+    def test_handshake_failure(self):
+        sslcontext = ssl.create_default_context()
+        sslcontext.check_hostname = False
+        waiter = asyncio.Future(loop=self.loop)
+        tr = self.ssl_transport(waiter=waiter, sslcontext=sslcontext)
+        self.server.do_handshake()
+        # the certificate of the server cannot be verified
+        with self.assertRaises(ssl.SSLError):
+            self.exchange()
+        test_utils.run_briefly(self.loop)
+        self.assertRaises(ssl.SSLError, waiter.result)
+        self.assertFalse(self.protocol.connection_made.called)
+        self.assertFalse(self.protocol.connection_lost.called)
+        self.assertIsNone(tr._sock)
+
+    def test_eof_during_handshake(self):
+        waiter = asyncio.Future(loop=self.loop)
+        tr = self.ssl_transport(waiter=waiter)
+        test_utils.run_briefly(self.loop)
+        self.feed(b'')
+        test_utils.run_briefly(self.loop)
+        self.assertRaises(ConnectionResetError, waiter.result)
+        self.assertFalse(self.protocol.eof_received.called)
+        self.assertFalse(self.protocol.connection_lost.called)
+        self.assertIsNone(tr._sock)
+
+    def test_write(self):
+        tr = self.connect()
+        tr.write(b'data1')
+        tr.write(bytearray(b'data2'))
+        tr.write(b'')
+        self.assertEqual(self.exchange(), b'data1data2')
+
+        # the records of all buffers are sent with a single write
+        tr.writelines([b'data3', memoryview(b'data4')])
+        self.assertEqual(len(self.sent), 1)
+        self.assertEqual(self.exchange(), b'data3data4')
+        self.assertRaises(TypeError, tr.write, 'str')
+        self.assertRaises(TypeError, tr.writelines, [b'data', 'str'])
+
+    def test_data_received(self):
+        tr = self.connect()
+        records, offset = self.server.feed_appdata(b'data')
+        self.feed(b''.join(records))
+        self.protocol.data_received.assert_called_with(b'data')
+
+        # several records are delivered with a single call
+        records = []
+        for data in (b'data1', b'data2'):
+            records.extend(self.server.feed_appdata(data)[0])
+        self.feed(b''.join(records))
+        self.protocol.data_received.assert_called_with(b'data1data2')
+
+    def test_close_notify(self):
+        tr = self.connect()
+        records = self.server.feed_appdata(b'data')[0]
+        records.extend(self.server.shutdown())
+        self.feed(b''.join(records))
+        self.protocol.data_received.assert_called_with(b'data')
+        self.protocol.eof_received.assert_called_with()
+        self.assertTrue(tr._closing)
+
+        # the close_notify alert of the transport completes the shutdown
+        self.exchange()
+        self.assertFalse(self.server.wrapped)
+        test_utils.run_briefly(self.loop)
+        self.protocol.connection_lost.assert_called_with(None)
+
+    def test_close(self):
+        tr = self.connect()
+        tr.close()
+        appdata = []
+        for data in self.sent:
+            appdata.extend(self.server.feed_ssldata(data)[1])
+        # the server received the close_notify alert
+        self.assertEqual(appdata, [b''])
+        test_utils.run_briefly(self.loop)
+        self.protocol.connection_lost.assert_called_with(None)
+
+    def test_write_after_close(self):
+        tr = self.connect()
+        tr.close()
+        self.exchange()
+        tr.write(b'data')
+        self.assertEqual(self.sent, [])
+
+
+class ProactorDatagramTransportTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+        self.addCleanup(self.loop.close)
+        self.proactor = mock.Mock()
+        self.loop._proactor = self.proactor
+        self.protocol = test_utils.make_test_protocol(asyncio.DatagramProtocol)
+        self.sock = mock.Mock(socket.socket)
+        self.sock.getsockname.return_value = ('127.0.0.1', 1234)
+
+    def datagram_transport(self, address=None):
+        transport = _ProactorDatagramTransport(self.loop, self.sock,
+                                               self.protocol, address=address)
+        self.addCleanup(close_transport, transport)
+        return transport
+
+    def test_ctor(self):
+        tr = self.datagram_transport()
+        test_utils.run_briefly(self.loop)
+        self.protocol.connection_made.assert_called_with(tr)
+        self.proactor.recvfrom.assert_called_with(self.sock, tr.max_size)
+        self.assertEqual(tr.get_extra_info('sockname'), ('127.0.0.1', 1234))
+        self.assertIsNone(tr.get_extra_info('peername'))
+        self.assertIsInstance(tr, asyncio.DatagramTransport)
+
+    def test_ctor_connected(self):
+        tr = self.datagram_transport(address=('127.0.0.1', 80))
+        test_utils.run_briefly(self.loop)
+        self.proactor.recv.assert_called_with(self.sock, tr.max_size)
+        self.assertEqual(tr.get_extra_info('peername'), ('127.0.0.1', 80))
+
+    def test_loop_reading_data(self):
+        res = asyncio.Future(loop=self.loop)
+        res.set_result((b'data', ('127.0.0.1', 80)))
+
+        tr = self.datagram_transport()
+        tr._read_fut = res
+        tr._loop_reading(res)
+        self.protocol.datagrams_received.assert_called_with(
+            [(b'data', ('127.0.0.1', 80))])
+        self.proactor.recvfrom.assert_called_with(self.sock, tr.max_size)
+
+    def test_loop_reading_connected(self):
+        res = asyncio.Future(loop=self.loop)
+        res.set_result(b'data')
+
+        tr = self.datagram_transport(address=('127.0.0.1', 80))
+        tr._read_fut = res
+        tr._loop_reading(res)
+        self.protocol.datagrams_received.assert_called_with(
+            [(b'data', ('127.0.0.1', 80))])
+
+    def test_loop_reading_oserror(self):
+        err = ConnectionResetError()
+        res = asyncio.Future(loop=self.loop)
+        res.set_exception(err)
+
+        tr = self.datagram_transport()
+        tr._read_fut = res
+        tr._loop_reading(res)
+        self.protocol.error_received.assert_called_with(err)
+        self.assertFalse(self.protocol.datagrams_received.called)
+        # the transport continues reading
+        self.proactor.recvfrom.assert_called_with(self.sock, tr.max_size)
+        self.assertFalse(tr.is_closing())
+
+    def test_loop_reading_closed(self):
+        tr = self.datagram_transport()
+        test_utils.run_briefly(self.loop)
+        read_fut = tr._read_fut
+        self.proactor.recvfrom.reset_mock()
+        tr.close()
+        self.assertTrue(read_fut.cancel.called)
+        tr._loop_reading(read_fut)
+        self.assertFalse(self.proactor.recvfrom.called)
+
+    def test_sendto(self):
+        tr = self.datagram_transport()
+        tr.sendto(b'data', ('127.0.0.1', 80))
+        self.proactor.sendto.assert_called_with(self.sock, b'data',
+                                                addr=('127.0.0.1', 80))
+        self.assertIs(tr._write_fut, self.proactor.sendto.return_value)
+
+        # the next datagram is queued until the first one is sent
+        tr.sendto(bytearray(b'more'), ('127.0.0.1', 81))
+        self.assertEqual(list(tr._buffer), [(b'more', ('127.0.0.1', 81))])
+        self.assertEqual(tr.get_write_buffer_size(), 4)
+
+        fut = tr._write_fut
+        tr._write_fut = fut = asyncio.Future(loop=self.loop)
+        fut.set_result(4)
+        tr._loop_writing(fut)
+        self.proactor.sendto.assert_called_with(self.sock, b'more',
+                                                addr=('127.0.0.1', 81))
+        self.assertFalse(tr._buffer)
+
+    def test_sendto_connected(self):
+        tr = self.datagram_transport(address=('127.0.0.1', 80))
+        tr.sendto(b'data')
+        self.proactor.send.assert_called_with(self.sock, b'data')
+        with self.assertRaises(ValueError):
+            tr.sendto(b'data', ('127.0.0.1', 81))
+
+    def test_sendto_invalid_data(self):
+        tr = self.datagram_transport()
+        with self.assertRaises(TypeError):
+            tr.sendto('str', ('127.0.0.1', 80))
+        tr.sendto(b'', ('127.0.0.1', 80))
+        self.assertFalse(self.proactor.sendto.called)
+
+    def test_sendto_error(self):
+        err = OSError()
+        tr = self.datagram_transport()
+        tr._buffer.append((b'next', ('127.0.0.1', 80)))
+        tr._write_fut = fut = asyncio.Future(loop=self.loop)
+        fut.set_exception(err)
+        tr._loop_writing(fut)
+        self.protocol.error_received.assert_called_with(err)
+        # the next datagram is sent
+        self.proactor.sendto.assert_called_with(self.sock, b'next',
+                                                addr=('127.0.0.1', 80))
+
+    def test_close_flushes_buffer(self):
+        tr = self.datagram_transport()
+        test_utils.run_briefly(self.loop)
+        tr.sendto(b'data', ('127.0.0.1', 80))
+        tr.sendto(b'more', ('127.0.0.1', 80))
+        tr.close()
+        test_utils.run_briefly(self.loop)
+        self.assertFalse(self.protocol.connection_lost.called)
+
+        # datagrams passed to sendto() after close() are dropped
+        tr.sendto(b'dropped', ('127.0.0.1', 80))
+        self.assertEqual(len(tr._buffer), 1)
+
+        for i in range(2):
+            tr._write_fut = fut = asyncio.Future(loop=self.loop)
+            fut.set_result(4)
+            tr._loop_writing(fut)
+        test_utils.run_briefly(self.loop)
+        self.protocol.connection_lost.assert_called_with(None)
+
+
 class BaseProactorEventLoopTests(test_utils.TestCase):
 
     def setUp(self):
@@ -460,6 +997,14 @@ def test_ctor(self, socketpair, call_soon):
         call_soon.assert_called_with(loop._loop_self_reading)
         loop.close()
 
+    def test_stats(self):
+        self.assertIsNone(self.loop.get_stats())
+        self.loop.set_stats_enabled(True)
+        self.proactor._cache = {1: None, 2: None}
+        stats = self.loop.get_stats()
+        self.assertEqual(stats['pending_operations'], 2)
+        self.assertEqual(stats['iterations'], 0)
+
     def test_close_self_pipe(self):
         self.loop._close_self_pipe()
         self.assertEqual(self.loop._internal_fds, 0)
@@ -486,6 +1031,11 @@ def test_sock_recv(self):
         self.loop.sock_recv(self.sock, 1024)
         self.proactor.recv.assert_called_with(self.sock, 1024)
 
+    def test_sock_recv_into(self):
+        buf = bytearray(1024)
+        self.loop.sock_recv_into(self.sock, buf)
+        self.proactor.recv_into.assert_called_with(self.sock, buf)
+
     def test_sock_sendall(self):
         self.loop.sock_sendall(self.sock, b'data')
         self.proactor.send.assert_called_with(self.sock, b'data')
@@ -511,6 +1061,12 @@ def test_make_socket_transport(self):
         self.assertIsInstance(tr, _ProactorSocketTransport)
         close_transport(tr)
 
+    def test_make_datagram_transport(self):
+        tr = self.loop._make_datagram_transport(self.sock,
+                                                asyncio.DatagramProtocol())
+        self.assertIsInstance(tr, _ProactorDatagramTransport)
+        close_transport(tr)
+
     def test_loop_self_reading(self):
         self.loop._loop_self_reading()
         self.proactor.recv.assert_called_with(self.ssock, 4096)
@@ -567,6 +1123,25 @@ def test_create_server(self, m_log):
         self.assertTrue(self.sock.close.called)
         self.assertTrue(m_log.error.called)
 
+    def test_create_server_accept_concurrency(self):
+        pf = mock.Mock()
+        call_soon = self.loop.call_soon = mock.Mock()
+        self.loop.accept_concurrency = 3
+        futs = [mock.Mock() for i in range(3)]
+        self.proactor.accept.side_effect = futs
+
+        self.loop._start_serving(pf, self.sock)
+        self.assertEqual(call_soon.call_count, 3)
+        for call in call_soon.call_args_list:
+            call[0][0]()
+        self.assertEqual(self.proactor.accept.call_count, 3)
+        self.assertEqual(self.loop._accept_futures, set(futs))
+
+        self.loop._stop_accept_futures()
+        for fut in futs:
+            self.assertTrue(fut.cancel.called)
+        self.assertEqual(self.loop._accept_futures, set())
+
     def test_create_server_cancel(self):
         pf = mock.Mock()
         call_soon = self.loop.call_soon = mock.Mock()
@@ -1,5 +1,6 @@
 """Tests for queues.py"""
 
+import threading
 import unittest
 from unittest import mock
 
@@ -480,6 +481,124 @@ def test_put_with_waiting_getters(self):
         self.assertEqual(self.loop.run_until_complete(t), 'a')
 
 
+class QueueBulkTests(_QueueTestBase):
+
+    def test_get_many_nowait(self):
+        q = asyncio.Queue(loop=self.loop)
+        self.assertRaises(asyncio.QueueEmpty, q.get_many_nowait)
+        for i in range(5):
+            q.put_nowait(i)
+        self.assertEqual(q.get_many_nowait(2), [0, 1])
+        self.assertEqual(q.get_many_nowait(), [2, 3, 4])
+        self.assertTrue(q.empty())
+        self.assertRaises(ValueError, q.get_many_nowait, 0)
+
+    def test_get_many(self):
+        q = asyncio.Queue(loop=self.loop)
+        q.put_many_nowait([1, 2, 3])
+        self.assertEqual(self.loop.run_until_complete(q.get_many(2)), [1, 2])
+        self.assertEqual(self.loop.run_until_complete(q.get_many()), [3])
+
+    def test_get_many_wait(self):
+        q = asyncio.Queue(loop=self.loop)
+        t = asyncio.Task(q.get_many(3), loop=self.loop)
+        test_utils.run_briefly(self.loop)
+        self.assertFalse(t.done())
+        q.put_many_nowait([1, 2, 3, 4])
+        # the waiting getter gets the first item, then up to max items
+        self.assertEqual(self.loop.run_until_complete(t), [1, 2, 3])
+        self.assertEqual(q.get_many_nowait(), [4])
+
+    def test_get_many_wakes_putters(self):
+        q = asyncio.Queue(maxsize=2, loop=self.loop)
+        q.put_many_nowait([1, 2])
+        t = asyncio.Task(q.put_many([3, 4, 5]), loop=self.loop)
+        test_utils.run_briefly(self.loop)
+        self.assertFalse(t.done())
+        self.assertEqual(len(q._putters), 1)
+
+        self.assertEqual(q.get_many_nowait(), [1, 2])
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(q.get_many_nowait(), [3, 4])
+        self.loop.run_until_complete(t)
+        self.assertEqual(q.get_many_nowait(), [5])
+        self.assertEqual(q._unfinished_tasks, 5)
+
+    def test_put_many_nowait(self):
+        q = asyncio.Queue(maxsize=3, loop=self.loop)
+        q.put_many_nowait([1, 2])
+        # the items which fit are put
+        self.assertRaises(asyncio.QueueFull, q.put_many_nowait, [3, 4])
+        self.assertEqual(q.get_many_nowait(), [1, 2, 3])
+        self.assertEqual(q._unfinished_tasks, 3)
+
+    def test_put_many_waiting_getters(self):
+        q = asyncio.Queue(loop=self.loop)
+        t1 = asyncio.Task(q.get(), loop=self.loop)
+        t2 = asyncio.Task(q.get(), loop=self.loop)
+        t3 = asyncio.Task(q.get(), loop=self.loop)
+        test_utils.run_briefly(self.loop)
+        t2.cancel()
+        test_utils.run_briefly(self.loop)
+
+        self.loop.run_until_complete(q.put_many(['a', 'b', 'c']))
+        self.assertEqual(self.loop.run_until_complete(t1), 'a')
+        self.assertEqual(self.loop.run_until_complete(t3), 'b')
+        self.assertEqual(q.get_many_nowait(), ['c'])
+
+    def test_put_many_priority(self):
+        q = asyncio.PriorityQueue(loop=self.loop)
+        q.put_many_nowait([3, 1, 2])
+        self.assertEqual(q.get_many_nowait(), [1, 2, 3])
+
+
+class QueueThreadsafeTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = asyncio.new_event_loop()
+        self.set_event_loop(self.loop)
+
+    def test_put_many_threadsafe(self):
+        q = asyncio.Queue(loop=self.loop)
+        q._loop.call_soon_threadsafe = mock.Mock(
+            wraps=self.loop.call_soon_threadsafe)
+
+        def feed():
+            for i in range(10):
+                q.put_many_threadsafe([i * 3, i * 3 + 1])
+                q.put_threadsafe(i * 3 + 2)
+
+        thread = threading.Thread(target=feed)
+        thread.start()
+        thread.join()
+        # a single callback for all the calls
+        self.assertEqual(q._loop.call_soon_threadsafe.call_count, 1)
+
+        items = self.loop.run_until_complete(q.get_many())
+        self.assertEqual(items, list(range(30)))
+
+    def test_put_many_threadsafe_full(self):
+        q = asyncio.Queue(maxsize=3, loop=self.loop)
+        items = []
+
+        @asyncio.coroutine
+        def consume():
+            while len(items) < 100:
+                items.extend((yield from q.get_many()))
+                self.assertLessEqual(q.qsize(), 3)
+
+        def feed():
+            for i in range(0, 100, 10):
+                q.put_many_threadsafe(range(i, i + 10))
+
+        thread = threading.Thread(target=feed)
+        thread.start()
+        self.loop.run_until_complete(consume())
+        thread.join()
+        self.assertEqual(items, list(range(100)))
+        self.assertIsNone(q._threadsafe_feeder)
+
+
 class LifoQueueTests(_QueueTestBase):
 
     def test_order(self):
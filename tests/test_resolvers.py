@@ -0,0 +1,408 @@
+"""Tests for resolvers.py"""
+
+import os
+import socket
+import struct
+import tempfile
+import unittest
+from unittest import mock
+
+import asyncio
+from asyncio import resolvers
+from asyncio import test_utils
+
+
+def build_response(query, answers=(), rcode=0, authority=()):
+    # Build the response to a query: answers and authority are lists of
+    # (name, type, ttl, rdata) tuples, a None name is the queried name
+    query_id = struct.unpack_from('!H', query)[0]
+    header = struct.pack('!6H', query_id, 0x8180 | rcode, 1,
+                         len(answers), len(authority), 0)
+    records = []
+    for name, rtype, ttl, rdata in list(answers) + list(authority):
+        if name is None:
+            # compression pointer to the name of the question
+            name = b'\xc0\x0c'
+        else:
+            name = resolvers._encode_name(name)
+        records.append(name + struct.pack('!HHIH', rtype, 1, ttl, len(rdata))
+                       + rdata)
+    return header + query[12:] + b''.join(records)
+
+
+def parse_query(query):
+    name, offset = resolvers._read_name(query, 12)
+    qtype = struct.unpack_from('!H', query, offset)[0]
+    return name, qtype
+
+
+class DNSServer(asyncio.DatagramProtocol):
+
+    def __init__(self):
+        # name => ttl, list of IPv4 addresses, list of IPv6 addresses
+        self.records = {}
+        self.queries = []
+        self.reply = True
+
+    def connection_made(self, transport):
+        self.transport = transport
+
+    def datagram_received(self, data, addr):
+        name, qtype = parse_query(data)
+        self.queries.append((name, qtype))
+        if not self.reply:
+            return
+        if name not in self.records:
+            soa = b'\0' * 20 + struct.pack('!I', 30)
+            response = build_response(data, rcode=3,
+                                      authority=[(None, 6, 60, soa)])
+        else:
+            ttl, ipv4, ipv6 = self.records[name]
+            if qtype == 1:
+                answers = [(None, 1, ttl, socket.inet_pton(socket.AF_INET,
+                                                           addr))
+                           for addr in ipv4]
+            else:
+                answers = [(None, 28, ttl, socket.inet_pton(socket.AF_INET6,
+                                                            addr))
+                           for addr in ipv6]
+            response = build_response(data, answers)
+        self.transport.sendto(response, addr)
+
+
+class DNSMessageTests(unittest.TestCase):
+
+    def test_build_query(self):
+        query = resolvers._build_query(0x1234, 'www.example.com', 28)
+        self.assertEqual(query[:12],
+                         b'\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00')
+        self.assertEqual(query[12:],
+                         b'\x03www\x07example\x03com\x00\x00\x1c\x00\x01')
+        self.assertEqual(parse_query(query), ('www.example.com', 28))
+
+        self.assertRaises(ValueError,
+                          resolvers._build_query, 1, 'a..com', 1)
+        self.assertRaises(ValueError,
+                          resolvers._build_query, 1, 'x' * 64 + '.com', 1)
+
+    def test_parse_response(self):
+        query = resolvers._build_query(1, 'www.example.com', 1)
+        answers = [(None, 5, 300, b'\x03web\xc0\x10'),
+                   ('web.example.com', 1, 60, b'\x7f\x00\x00\x01'),
+                   ('other.example.com', 1, 60, b'\x7f\x00\x00\x02')]
+        response = build_response(query, answers)
+        rcode, answers, authority = resolvers._parse_response(
+            response, 1, 'www.example.com', 1)
+        self.assertEqual(rcode, 0)
+        self.assertEqual(answers[0], ('www.example.com', 5, 300,
+                                      'web.example.com'))
+        self.assertEqual(authority, [])
+
+        # the CNAME chain is followed, the smallest TTL is used
+        self.assertEqual(
+            resolvers._extract_addresses('www.example.com', 1,
+                                         answers, authority),
+            (['127.0.0.1'], 60))
+
+        # not a response to the query
+        self.assertIsNone(resolvers._parse_response(
+            response, 2, 'www.example.com', 1))
+        self.assertIsNone(resolvers._parse_response(
+            response, 1, 'www.example.org', 1))
+        self.assertIsNone(resolvers._parse_response(
+            response, 1, 'www.example.com', 28))
+
+        self.assertRaises(resolvers._DNSError, resolvers._parse_response,
+                          response[:-3], 1, 'www.example.com', 1)
+        truncated = response[:2] + b'\x83\x80' + response[4:]
+        self.assertRaises(resolvers._DNSError, resolvers._parse_response,
+                          truncated, 1, 'www.example.com', 1)
+
+    def test_compression_loop(self):
+        data = b'\0' * 12 + b'\xc0\x0c'
+        self.assertRaises(resolvers._DNSError, resolvers._read_name, data, 12)
+
+    def test_negative_ttl(self):
+        soa = b'\0' * 20 + struct.pack('!I', 30)
+        self.assertEqual(
+            resolvers._extract_addresses('www.example.com', 1, [],
+                                         [('example.com', 6, 60, soa)]),
+            ([], 30))
+
+    def test_read_resolv_conf(self):
+        with tempfile.NamedTemporaryFile('w', delete=False) as fp:
+            fp.write('# comment\n'
+                     'nameserver 192.0.2.53\n'
+                     'domain example.org\n'
+                     'search example.com. Example.net\n'
+                     'nameserver 2001:db8::53\n'
+                     'options rotate ndots:2\n')
+        self.addCleanup(os.unlink, fp.name)
+        self.assertEqual(resolvers._read_resolv_conf(fp.name),
+                         (['192.0.2.53', '2001:db8::53'],
+                          ['example.com.', 'Example.net'], 2))
+        self.assertEqual(resolvers._read_resolv_conf(fp.name + '.missing'),
+                         ([], [], 1))
+
+
+class DNSResolverTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = asyncio.new_event_loop()
+        self.set_event_loop(self.loop)
+
+        self.server = DNSServer()
+        transport, protocol = self.loop.run_until_complete(
+            self.loop.create_datagram_endpoint(lambda: self.server,
+                                               local_addr=('127.0.0.1', 0)))
+        self.server_transport = transport
+        self.server.records['www.example.com'] = (
+            60, ['192.0.2.1', '192.0.2.2'], ['2001:db8::1'])
+        self.server.records['ipv4.example.com'] = (60, ['192.0.2.3'], [])
+        self.nameserver = transport.get_extra_info('sockname')
+
+        self.fallback = mock.Mock(resolvers.AbstractResolver)
+        self.resolver = resolvers.DNSResolver([self.nameserver], timeout=0.1,
+                                              fallback=self.fallback,
+                                              loop=self.loop)
+
+    def tearDown(self):
+        self.server_transport.close()
+        # run the connection_lost() callbacks of the closed transports
+        test_utils.run_briefly(self.loop)
+        super().tearDown()
+
+    def getaddrinfo(self, host, port=80, **kw):
+        return self.loop.run_until_complete(
+            self.resolver.getaddrinfo(host, port, **kw))
+
+    def test_getaddrinfo(self):
+        infos = self.getaddrinfo('www.example.com', 80,
+                                 type=socket.SOCK_STREAM)
+        tcp = socket.IPPROTO_TCP
+        self.assertEqual(infos, [
+            (socket.AF_INET, socket.SOCK_STREAM, tcp, '', ('192.0.2.1', 80)),
+            (socket.AF_INET, socket.SOCK_STREAM, tcp, '', ('192.0.2.2', 80)),
+            (socket.AF_INET6, socket.SOCK_STREAM, tcp, '',
+             ('2001:db8::1', 80, 0, 0)),
+        ])
+        self.assertEqual(sorted(self.server.queries),
+                         [('www.example.com', 1), ('www.example.com', 28)])
+
+        infos = self.getaddrinfo('WWW.Example.com.', '8080',
+                                 family=socket.AF_INET6,
+                                 type=socket.SOCK_DGRAM)
+        self.assertEqual(infos, [
+            (socket.AF_INET6, socket.SOCK_DGRAM, socket.IPPROTO_UDP, '',
+             ('2001:db8::1', 8080, 0, 0)),
+        ])
+
+        # one entry per socket type
+        infos = self.getaddrinfo('ipv4.example.com', family=socket.AF_INET)
+        self.assertEqual([info[1] for info in infos],
+                         [socket.SOCK_STREAM, socket.SOCK_DGRAM,
+                          socket.SOCK_RAW])
+        self.assertFalse(self.fallback.getaddrinfo.called)
+
+    def test_cache(self):
+        self.getaddrinfo('www.example.com', family=socket.AF_INET)
+        self.assertEqual(len(self.server.queries), 1)
+        expires = self.resolver._cache['www.example.com', 1][0]
+        self.assertAlmostEqual(expires, self.loop.time() + 60, delta=1.0)
+
+        # the cached addresses are used
+        infos = self.getaddrinfo('www.example.com', family=socket.AF_INET)
+        self.assertEqual(len(infos), 6)
+        self.assertEqual(len(self.server.queries), 1)
+
+        # the cached addresses expired
+        self.resolver._cache['www.example.com', 1] = (self.loop.time() - 1,
+                                                      [])
+        infos = self.getaddrinfo('www.example.com', family=socket.AF_INET)
+        self.assertEqual(len(infos), 6)
+        self.assertEqual(len(self.server.queries), 2)
+
+        self.resolver.clear_cache()
+        self.getaddrinfo('www.example.com', family=socket.AF_INET)
+        self.assertEqual(len(self.server.queries), 3)
+
+    def test_cache_size(self):
+        self.resolver._cache_size = 1
+        self.getaddrinfo('www.example.com', family=socket.AF_INET)
+        self.getaddrinfo('ipv4.example.com', family=socket.AF_INET)
+        self.assertEqual(list(self.resolver._cache),
+                         [('ipv4.example.com', 1)])
+
+    def test_concurrent_lookups(self):
+        coros = [self.resolver.getaddrinfo('ipv4.example.com', 80,
+                                           family=socket.AF_INET)
+                 for i in range(3)]
+        results = self.loop.run_until_complete(
+            asyncio.gather(*coros, loop=self.loop))
+        self.assertEqual(results[0], results[1])
+        self.assertEqual(results[0], results[2])
+        self.assertEqual(self.server.queries, [('ipv4.example.com', 1)])
+
+    def test_unknown_host(self):
+        with self.assertRaises(socket.gaierror):
+            self.getaddrinfo('unknown.example.com')
+        # the negative answer is cached
+        with self.assertRaises(socket.gaierror):
+            self.getaddrinfo('unknown.example.com')
+        self.assertEqual(len(self.server.queries), 2)
+        self.assertFalse(self.fallback.getaddrinfo.called)
+
+    def test_ip_address(self):
+        infos = self.getaddrinfo('127.0.0.1', type=socket.SOCK_STREAM)
+        self.assertEqual(infos, socket.getaddrinfo('127.0.0.1', 80, 0,
+                                                   socket.SOCK_STREAM))
+        infos = self.getaddrinfo('::1', family=socket.AF_INET6,
+                                 type=socket.SOCK_STREAM)
+        self.assertEqual(infos[0][4][:2], ('::1', 80))
+        self.assertEqual(self.server.queries, [])
+        self.assertFalse(self.fallback.getaddrinfo.called)
+
+    def test_fallback(self):
+        result = [(socket.AF_INET, socket.SOCK_STREAM, 6, '',
+                   ('192.0.2.9', 80))]
+
+        @asyncio.coroutine
+        def getaddrinfo(*args, **kw):
+            return result
+        self.fallback.getaddrinfo.side_effect = getaddrinfo
+
+        for host, port, kw in (
+            ('localhost', 80, {}),
+            (None, 80, {}),
+            ('www.example.com', 'http', {}),
+            ('www.example.com', 80, {'flags': socket.AI_CANONNAME}),
+            ('www.example.com', 80, {'family': socket.AF_UNIX}),
+        ):
+            self.fallback.getaddrinfo.reset_mock()
+            self.assertIs(self.getaddrinfo(host, port, **kw), result)
+            self.assertEqual(self.fallback.getaddrinfo.call_count, 1)
+        self.assertEqual(self.server.queries, [])
+
+        # the name server doesn't answer
+        self.server.reply = False
+        self.fallback.getaddrinfo.reset_mock()
+        self.assertIs(self.getaddrinfo('www.example.com'), result)
+        self.fallback.getaddrinfo.assert_called_with(
+            'www.example.com', 80, family=0, type=0, proto=0, flags=0)
+        # each name server is tried twice for each record type
+        self.assertEqual(len(self.server.queries), 4)
+
+    def test_search(self):
+        self.server.records['host.lan.example.com'] = (60, ['192.0.2.4'], [])
+        resolver = resolvers.DNSResolver([self.nameserver],
+                                         search=['example.org.',
+                                                 'Example.com'],
+                                         timeout=0.1, fallback=self.fallback,
+                                         loop=self.loop)
+
+        # a name with ndots dots is tried as is first
+        infos = self.loop.run_until_complete(
+            resolver.getaddrinfo('host.lan', 80, family=socket.AF_INET,
+                                 type=socket.SOCK_STREAM))
+        self.assertEqual([info[4] for info in infos], [('192.0.2.4', 80)])
+        self.assertEqual(self.server.queries,
+                         [('host.lan', 1), ('host.lan.example.org', 1),
+                          ('host.lan.example.com', 1)])
+
+        # other names are tried as is last
+        del self.server.queries[:]
+        resolver._ndots = 2
+        resolver.clear_cache()
+        infos = self.loop.run_until_complete(
+            resolver.getaddrinfo('host.lan', 80, family=socket.AF_INET,
+                                 type=socket.SOCK_STREAM))
+        self.assertEqual([info[4] for info in infos], [('192.0.2.4', 80)])
+        self.assertEqual(self.server.queries,
+                         [('host.lan.example.org', 1),
+                          ('host.lan.example.com', 1)])
+
+        # an absolute name is not qualified
+        del self.server.queries[:]
+        with self.assertRaises(socket.gaierror):
+            self.loop.run_until_complete(
+                resolver.getaddrinfo('host.lan.', 80, family=socket.AF_INET))
+        self.assertEqual(self.server.queries, [('host.lan', 1)])
+        self.assertFalse(self.fallback.getaddrinfo.called)
+
+    def test_hosts_reload(self):
+        result = []
+        fut = asyncio.Future(loop=self.loop)
+        fut.set_result(result)
+        self.fallback.getaddrinfo.return_value = fut
+
+        with tempfile.NamedTemporaryFile('w', delete=False) as fp:
+            fp.write('127.0.0.1 localhost\n')
+        self.addCleanup(os.unlink, fp.name)
+        self.resolver._hosts_path = fp.name
+        self.resolver._update_hosts()
+        self.assertEqual(self.resolver._hosts, {'localhost'})
+        self.getaddrinfo('www.example.com')
+        self.assertFalse(self.fallback.getaddrinfo.called)
+
+        # the modified hosts file is read again after the check interval
+        with open(fp.name, 'a') as hosts:
+            hosts.write('192.0.2.8 www.example.com\n')
+        mtime = os.stat(fp.name).st_mtime
+        os.utime(fp.name, (mtime + 10, mtime + 10))
+        self.resolver._update_hosts()
+        self.assertEqual(self.resolver._hosts, {'localhost'})
+        self.resolver._hosts_check = self.loop.time()
+        self.assertIs(self.getaddrinfo('www.example.com'), result)
+        self.assertEqual(self.resolver._hosts,
+                         {'localhost', 'www.example.com'})
+
+    def test_no_nameserver(self):
+        resolver = resolvers.DNSResolver([], fallback=self.fallback,
+                                         loop=self.loop)
+        result = []
+        fut = asyncio.Future(loop=self.loop)
+        fut.set_result(result)
+        self.fallback.getaddrinfo.return_value = fut
+        infos = self.loop.run_until_complete(
+            resolver.getaddrinfo('www.example.com', 80))
+        self.assertIs(infos, result)
+
+
+class LoopResolverTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+
+    def test_set_resolver(self):
+        self.assertIsNone(self.loop.get_resolver())
+        self.assertRaises(TypeError, self.loop.set_resolver, object())
+
+        resolver = mock.Mock(resolvers.AbstractResolver)
+        fut = asyncio.Future(loop=self.loop)
+        fut.set_result([])
+        resolver.getaddrinfo.return_value = fut
+        self.loop.set_resolver(resolver)
+        self.assertIs(self.loop.get_resolver(), resolver)
+
+        result = self.loop.run_until_complete(
+            self.loop.getaddrinfo('www.example.com', 80,
+                                  type=socket.SOCK_STREAM))
+        self.assertEqual(result, [])
+        resolver.getaddrinfo.assert_called_with(
+            'www.example.com', 80, family=0, type=socket.SOCK_STREAM,
+            proto=0, flags=0)
+
+        self.loop.set_resolver(None)
+        self.assertIsNone(self.loop.get_resolver())
+
+    def test_executor_resolver(self):
+        executor = mock.Mock()
+        resolver = resolvers.ExecutorResolver(executor, loop=self.loop)
+        with mock.patch.object(self.loop, 'run_in_executor') as run:
+            resolver.getaddrinfo('www.example.com', 80, flags=1)
+        run.assert_called_with(executor, socket.getaddrinfo,
+                               'www.example.com', 80, 0, 0, 0, 1)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,6 +1,7 @@
 """Tests for selector_events.py"""
 
 import errno
+import io
 import socket
 import unittest
 from unittest import mock
@@ -11,6 +12,7 @@
 
 import asyncio
 from asyncio import selectors
+from asyncio import sslproto
 from asyncio import test_utils
 from asyncio.selector_events import BaseSelectorEventLoop
 from asyncio.selector_events import _SelectorTransport
@@ -39,6 +41,11 @@ def list_to_buffer(l=()):
     return bytearray().join(l)
 
 
+def buffered(transport):
+    # Return the data of the write buffer of a transport
+    return list_to_buffer(transport._buffer)
+
+
 def close_transport(transport):
     # Don't call transport.close() because the event loop and the selector
     # are mocked
@@ -94,6 +101,28 @@ def test_make_ssl_transport(self):
         # execute pending callbacks to close the socket transport
         test_utils.run_briefly(self.loop)
 
+    @unittest.skipIf(ssl is None, 'No ssl module')
+    @unittest.skipUnless(sslproto._is_sslproto_available(),
+                         'need ssl.MemoryBIO')
+    def test_make_ssl_transport_buffered(self):
+        m = mock.Mock()
+        self.loop.add_reader = mock.Mock()
+        self.loop.add_reader._is_coroutine = False
+        self.loop.add_writer = mock.Mock()
+        self.loop.remove_reader = mock.Mock()
+        self.loop.remove_writer = mock.Mock()
+        self.loop.ssl_buffered = True
+        waiter = asyncio.Future(loop=self.loop)
+        with test_utils.disable_logger():
+            transport = self.loop._make_ssl_transport(
+                m, asyncio.Protocol(), m, waiter)
+            test_utils.run_briefly(self.loop)
+        self.assertTrue(transport._ssl_protocol.buffered)
+        self.assertTrue(transport._ssl_protocol._sslpipe.buffered)
+
+        transport.close()
+        test_utils.run_briefly(self.loop)
+
     @mock.patch('asyncio.selector_events.ssl', None)
     @mock.patch('asyncio.sslproto.ssl', None)
     def test_make_ssl_transport_without_ssl_error(self):
@@ -225,6 +254,38 @@ def test__sock_recv_exception(self):
         self.loop._sock_recv(f, False, sock, 1024)
         self.assertIs(err, f.exception())
 
+    def test_sock_recv_into(self):
+        sock = test_utils.mock_nonblocking_socket()
+        self.loop._sock_recv_into = mock.Mock()
+        buf = bytearray(1024)
+
+        f = self.loop.sock_recv_into(sock, buf)
+        self.assertIsInstance(f, asyncio.Future)
+        self.loop._sock_recv_into.assert_called_with(f, False, sock, buf)
+
+    def test__sock_recv_into(self):
+        f = asyncio.Future(loop=self.loop)
+        sock = mock.Mock()
+        sock.fileno.return_value = 10
+        sock.recv_into.return_value = 4
+        buf = bytearray(1024)
+
+        self.loop._sock_recv_into(f, False, sock, buf)
+        sock.recv_into.assert_called_with(buf)
+        self.assertEqual(f.result(), 4)
+
+    def test__sock_recv_into_tryagain(self):
+        f = asyncio.Future(loop=self.loop)
+        sock = mock.Mock()
+        sock.fileno.return_value = 10
+        sock.recv_into.side_effect = BlockingIOError
+        buf = bytearray(1024)
+
+        self.loop.add_reader = mock.Mock()
+        self.loop._sock_recv_into(f, False, sock, buf)
+        self.assertEqual((10, self.loop._sock_recv_into, f, True, sock, buf),
+                         self.loop.add_reader.call_args[0])
+
     def test_sock_sendall(self):
         sock = test_utils.mock_nonblocking_socket()
         self.loop._sock_sendall = mock.Mock()
@@ -630,8 +691,22 @@ def test_process_events_read(self):
             [(selectors.SelectorKey(
                 1, 1, selectors.EVENT_READ, (reader, None)),
               selectors.EVENT_READ)])
-        self.assertTrue(self.loop._add_callback.called)
+        self.assertFalse(self.loop._add_callback.called)
+        self.assertEqual(self.loop._io_handles, [reader])
+
+    def test_process_events_read_debug(self):
+        # in debug mode, I/O callbacks go through _ready to be timed
+        self.loop.set_debug(True)
+        reader = mock.Mock()
+        reader._cancelled = False
+
+        self.loop._add_callback = mock.Mock()
+        self.loop._process_events(
+            [(selectors.SelectorKey(
+                1, 1, selectors.EVENT_READ, (reader, None)),
+              selectors.EVENT_READ)])
         self.loop._add_callback.assert_called_with(reader)
+        self.assertEqual(self.loop._io_handles, [])
 
     def test_process_events_read_cancelled(self):
         reader = mock.Mock()
@@ -648,12 +723,11 @@ def test_process_events_write(self):
         writer = mock.Mock()
         writer._cancelled = False
 
-        self.loop._add_callback = mock.Mock()
         self.loop._process_events(
             [(selectors.SelectorKey(1, 1, selectors.EVENT_WRITE,
                                     (None, writer)),
               selectors.EVENT_WRITE)])
-        self.loop._add_callback.assert_called_with(writer)
+        self.assertEqual(self.loop._io_handles, [writer])
 
     def test_process_events_write_cancelled(self):
         writer = mock.Mock()
@@ -666,6 +740,92 @@ def test_process_events_write_cancelled(self):
               selectors.EVENT_WRITE)])
         self.loop.remove_writer.assert_called_with(1)
 
+    def test_io_callbacks_order(self):
+        loop = asyncio.SelectorEventLoop()
+        self.addCleanup(loop.close)
+        rsock, wsock = test_utils.socketpair()
+        self.addCleanup(rsock.close)
+        self.addCleanup(wsock.close)
+        wsock.send(b'x')
+        order = []
+
+        def reader(name):
+            order.append(name)
+            loop.call_soon(order.append, 'soon')
+
+        loop.add_reader(rsock.fileno(), reader, 'reader1')
+        loop.add_writer(wsock.fileno(), reader, 'writer')
+        loop.call_soon(order.append, 'ready')
+        loop.call_later(0, order.append, 'later')
+        loop._run_once()
+        self.assertEqual(order[0], 'ready')
+        self.assertEqual(order[-1], 'later')
+        self.assertEqual(sorted(order[1:-1]), ['reader1', 'writer'])
+
+        # a cancelled I/O callback is not called, callbacks scheduled by
+        # the I/O callbacks run at the next iteration
+        del order[:]
+
+        def cancel_writer(name):
+            order.append(name)
+            loop.remove_writer(wsock.fileno())
+            loop.remove_reader(rsock.fileno())
+
+        loop.add_reader(rsock.fileno(), cancel_writer, 'reader2')
+        loop.add_writer(wsock.fileno(), cancel_writer, 'writer2')
+        loop._run_once()
+        self.assertEqual(order[:2], ['soon', 'soon'])
+        self.assertEqual(len(order), 3)
+        self.assertIn(order[2], ('reader2', 'writer2'))
+
+    def test_io_callbacks_stop(self):
+        loop = asyncio.SelectorEventLoop()
+        self.addCleanup(loop.close)
+        rsock, wsock = test_utils.socketpair()
+        self.addCleanup(rsock.close)
+        self.addCleanup(wsock.close)
+        calls = []
+        loop.add_reader(rsock.fileno(), calls.append, 'reader')
+        wsock.send(b'x')
+
+        # stop() was called before the poll: the loop stops before calling
+        # the I/O callback
+        loop.stop()
+        loop.run_forever()
+        self.assertEqual(calls, [])
+
+        # the socket is no more readable, but the I/O callback is called
+        # when the loop runs again
+        self.assertEqual(rsock.recv(1), b'x')
+        loop.stop()
+        loop.run_forever()
+        self.assertEqual(calls, ['reader'])
+
+    def test_io_callbacks_stop_order(self):
+        loop = asyncio.SelectorEventLoop()
+        self.addCleanup(loop.close)
+        rsock, wsock = test_utils.socketpair()
+        self.addCleanup(rsock.close)
+        self.addCleanup(wsock.close)
+        order = []
+        loop.add_reader(rsock.fileno(), order.append, 'reader')
+        wsock.send(b'x')
+
+        # stop() is called in the middle of the callbacks ready before the
+        # poll
+        loop.call_soon(order.append, 'ready1')
+        loop.stop()
+        loop.call_soon(order.append, 'ready2')
+        loop.call_later(0, order.append, 'later')
+        loop.run_forever()
+        self.assertEqual(order, ['ready1'])
+
+        # the order of the callbacks is kept when the loop runs again
+        self.assertEqual(rsock.recv(1), b'x')
+        loop.stop()
+        loop.run_forever()
+        self.assertEqual(order, ['ready1', 'ready2', 'reader', 'later'])
+
 
 class SelectorTransportTests(test_utils.TestCase):
 
@@ -696,9 +856,11 @@ def test_abort(self):
 
     def test_close(self):
         tr = self.create_transport()
+        self.assertFalse(tr.is_closing())
         tr.close()
 
         self.assertTrue(tr._closing)
+        self.assertTrue(tr.is_closing())
         self.assertEqual(1, self.loop.remove_reader_count[7])
         self.protocol.connection_lost(None)
         self.assertEqual(tr._conn_lost, 1)
@@ -814,6 +976,45 @@ def test_read_ready(self):
 
         self.protocol.data_received.assert_called_with(b'data')
 
+    def test_stats(self):
+        transport = self.socket_transport()
+        test_utils.run_briefly(self.loop)
+
+        self.sock.recv.side_effect = [b'data', b'data', BlockingIOError]
+        for i in range(3):
+            transport._read_ready()
+
+        self.sock.send.return_value = 2
+        transport.write(b'xyz')
+        self.sock.send.return_value = 1
+        transport._write_ready()
+
+        transport.pause_reading()
+        transport.resume_reading()
+
+        stats = transport.get_extra_info('stats')
+        self.assertEqual(stats['bytes_received'], 8)
+        self.assertEqual(stats['reads'], 2)
+        self.assertEqual(stats['bytes_sent'], 3)
+        self.assertEqual(stats['writes'], 2)
+        self.assertEqual(stats['reading_pauses'], 1)
+        self.assertEqual(stats['reading_resumes'], 1)
+        self.assertEqual(stats['writing_pauses'], 0)
+        self.assertFalse(stats['writing_paused'])
+
+    def test_read_ready_adaptive_size(self):
+        transport = _SelectorSocketTransport(
+            self.loop, self.sock, self.protocol,
+            read_size_limits=(1024, 4096))
+        self.addCleanup(close_transport, transport)
+
+        # full reads grow the read size, small reads shrink it
+        self.sock.recv.side_effect = [b'x' * 1024, b'x' * 2048, b'x', b'x']
+        for size in (1024, 2048, 4096, 2048):
+            transport._read_ready()
+            self.sock.recv.assert_called_with(size)
+        self.assertEqual(transport._read_size, 1024)
+
     def test_read_ready_eof(self):
         transport = self.socket_transport()
         transport.close = mock.Mock()
@@ -904,18 +1105,18 @@ def test_write_memoryview(self):
 
     def test_write_no_data(self):
         transport = self.socket_transport()
-        transport._buffer.extend(b'data')
+        transport._buffer_append(b'data')
         transport.write(b'')
         self.assertFalse(self.sock.send.called)
-        self.assertEqual(list_to_buffer([b'data']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'data']), buffered(transport))
 
     def test_write_buffer(self):
         transport = self.socket_transport()
-        transport._buffer.extend(b'data1')
+        transport._buffer_append(b'data1')
         transport.write(b'data2')
         self.assertFalse(self.sock.send.called)
         self.assertEqual(list_to_buffer([b'data1', b'data2']),
-                         transport._buffer)
+                         buffered(transport))
 
     def test_write_partial(self):
         data = b'data'
@@ -925,7 +1126,7 @@ def test_write_partial(self):
         transport.write(data)
 
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'ta']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'ta']), buffered(transport))
 
     def test_write_partial_bytearray(self):
         data = bytearray(b'data')
@@ -935,7 +1136,7 @@ def test_write_partial_bytearray(self):
         transport.write(data)
 
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'ta']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'ta']), buffered(transport))
         self.assertEqual(data, bytearray(b'data'))  # Hasn't been mutated.
 
     def test_write_partial_memoryview(self):
@@ -946,7 +1147,20 @@ def test_write_partial_memoryview(self):
         transport.write(data)
 
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'ta']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'ta']), buffered(transport))
+
+    def test_write_partial_bytes_not_copied(self):
+        data = b'data'
+        self.sock.send.return_value = 1
+
+        transport = self.socket_transport()
+        transport.write(data)
+        transport.write(bytearray(b'more'))
+
+        self.assertEqual(len(transport._buffer), 2)
+        self.assertIs(transport._buffer[0].obj, data)
+        self.assertEqual(transport.get_write_buffer_size(), 7)
+        self.assertEqual(list_to_buffer([b'atamore']), buffered(transport))
 
     def test_write_partial_none(self):
         data = b'data'
@@ -957,7 +1171,7 @@ def test_write_partial_none(self):
         transport.write(data)
 
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'data']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'data']), buffered(transport))
 
     def test_write_tryagain(self):
         self.sock.send.side_effect = BlockingIOError
@@ -967,7 +1181,7 @@ def test_write_tryagain(self):
         transport.write(data)
 
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'data']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'data']), buffered(transport))
 
     @mock.patch('asyncio.selector_events.logger')
     def test_write_exception(self, m_log):
@@ -1003,12 +1217,140 @@ def test_write_closing(self):
         transport.write(b'data')
         self.assertEqual(transport._conn_lost, 2)
 
+    def test_writelines(self):
+        self.sock.sendmsg.return_value = 9
+
+        transport = self.socket_transport()
+        transport.writelines([b'head', b'', bytearray(b'body'), b'!'])
+        self.sock.sendmsg.assert_called_with(
+            [b'head', bytearray(b'body'), b'!'])
+        self.assertFalse(self.sock.send.called)
+        self.assertFalse(self.loop.writers)
+        self.assertEqual(list_to_buffer(), buffered(transport))
+
+    def test_writelines_partial(self):
+        self.sock.sendmsg.return_value = 6
+
+        transport = self.socket_transport()
+        transport.writelines([b'head', b'body', b'tail'])
+        self.loop.assert_writer(7, transport._write_ready)
+        self.assertEqual(list_to_buffer([b'dy', b'tail']), buffered(transport))
+
+    def test_writelines_tryagain(self):
+        self.sock.sendmsg.side_effect = BlockingIOError
+
+        transport = self.socket_transport()
+        transport.writelines([b'head', b'body'])
+        self.loop.assert_writer(7, transport._write_ready)
+        self.assertEqual(list_to_buffer([b'head', b'body']),
+                         buffered(transport))
+
+    def test_writelines_buffer(self):
+        transport = self.socket_transport()
+        transport._buffer_append(b'data')
+        transport.writelines([b'head', b'body'])
+        self.assertFalse(self.sock.sendmsg.called)
+        self.assertFalse(self.sock.send.called)
+        self.assertEqual(list_to_buffer([b'data', b'head', b'body']),
+                         buffered(transport))
+
+    def test_writelines_exception(self):
+        err = self.sock.sendmsg.side_effect = OSError()
+
+        transport = self.socket_transport()
+        transport._fatal_error = mock.Mock()
+        transport.writelines([b'head', b'body'])
+        transport._fatal_error.assert_called_with(
+                                   err,
+                                   'Fatal write error on socket transport')
+
+    def test_writelines_str(self):
+        transport = self.socket_transport()
+        self.assertRaises(TypeError, transport.writelines, [b'data', 'str'])
+        self.assertFalse(self.sock.sendmsg.called)
+
+    def test_write_corked(self):
+        self.sock.sendmsg.return_value = 12
+
+        transport = self.socket_transport()
+        transport.set_corked(True)
+        transport.write(b'head')
+        transport.writelines([b'bo', b'dy'])
+        transport.write(b'tail')
+        self.assertFalse(self.sock.send.called)
+        self.assertFalse(self.sock.sendmsg.called)
+        self.assertEqual(transport.get_write_buffer_size(), 12)
+
+        # the data written during the iteration is sent at once
+        test_utils.run_briefly(self.loop)
+        self.sock.sendmsg.assert_called_once_with(
+            [b'head', b'bo', b'dy', b'tail'])
+        self.assertFalse(self.loop.writers)
+        self.assertEqual(transport.get_write_buffer_size(), 0)
+        self.assertIsNone(transport._cork_handle)
+
+    def test_flush(self):
+        self.sock.send.return_value = 2
+
+        transport = self.socket_transport()
+        transport.set_corked(True)
+        transport.write(b'data')
+        handle = transport._cork_handle
+        transport.flush()
+        self.assertTrue(handle._cancelled)
+        self.sock.send.assert_called_once_with(b'data')
+        # not all was written: register the write handler
+        self.loop.assert_writer(7, transport._write_ready)
+        self.assertEqual(list_to_buffer([b'ta']), buffered(transport))
+
+        # the writer sends the data written while it's registered
+        transport.write(b'more')
+        self.assertIsNone(transport._cork_handle)
+
+    def test_set_corked_false_flushes(self):
+        self.sock.send.return_value = 4
+
+        transport = self.socket_transport()
+        transport.set_corked(True)
+        transport.write(b'data')
+        transport.set_corked(False)
+        self.sock.send.assert_called_once_with(b'data')
+        self.assertIsNone(transport._cork_handle)
+        self.assertEqual(transport.get_write_buffer_size(), 0)
+
+        transport.write(b'more')
+        self.sock.send.assert_called_with(b'more')
+
+    def test_write_corked_abort(self):
+        transport = self.socket_transport()
+        transport.set_corked(True)
+        transport.write(b'data')
+        handle = transport._cork_handle
+        transport.abort()
+        self.assertTrue(handle._cancelled)
+        self.assertIsNone(transport._cork_handle)
+        test_utils.run_briefly(self.loop)
+        self.assertFalse(self.sock.send.called)
+
+    def test_write_corked_close(self):
+        self.sock.send.return_value = 4
+
+        transport = self.socket_transport()
+        transport.set_corked(True)
+        transport.write(b'data')
+        transport.close()
+        self.assertFalse(self.protocol.connection_lost.called)
+        test_utils.run_briefly(self.loop)
+        self.sock.send.assert_called_once_with(b'data')
+        test_utils.run_briefly(self.loop)
+        self.protocol.connection_lost.assert_called_with(None)
+
     def test_write_ready(self):
         data = b'data'
         self.sock.send.return_value = len(data)
 
         transport = self.socket_transport()
-        transport._buffer.extend(data)
+        transport._buffer_append(data)
         self.loop.add_writer(7, transport._write_ready)
         transport._write_ready()
         self.assertTrue(self.sock.send.called)
@@ -1020,7 +1362,7 @@ def test_write_ready_closing(self):
 
         transport = self.socket_transport()
         transport._closing = True
-        transport._buffer.extend(data)
+        transport._buffer_append(data)
         self.loop.add_writer(7, transport._write_ready)
         transport._write_ready()
         self.assertTrue(self.sock.send.called)
@@ -1038,40 +1380,77 @@ def test_write_ready_partial(self):
         self.sock.send.return_value = 2
 
         transport = self.socket_transport()
-        transport._buffer.extend(data)
+        transport._buffer_append(data)
         self.loop.add_writer(7, transport._write_ready)
         transport._write_ready()
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'ta']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'ta']), buffered(transport))
 
     def test_write_ready_partial_none(self):
         data = b'data'
         self.sock.send.return_value = 0
 
         transport = self.socket_transport()
-        transport._buffer.extend(data)
+        transport._buffer_append(data)
         self.loop.add_writer(7, transport._write_ready)
         transport._write_ready()
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'data']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'data']), buffered(transport))
 
     def test_write_ready_tryagain(self):
         self.sock.send.side_effect = BlockingIOError
+        self.sock.sendmsg.side_effect = BlockingIOError
 
         transport = self.socket_transport()
-        transport._buffer = list_to_buffer([b'data1', b'data2'])
+        transport._buffer_append(b'data1')
+        transport._buffer_append(b'data2')
         self.loop.add_writer(7, transport._write_ready)
         transport._write_ready()
 
         self.loop.assert_writer(7, transport._write_ready)
-        self.assertEqual(list_to_buffer([b'data1data2']), transport._buffer)
+        self.assertEqual(list_to_buffer([b'data1data2']), buffered(transport))
+
+    def test_write_ready_sendmsg(self):
+        self.sock.sendmsg.return_value = 6
+        data = b'body'
+
+        transport = self.socket_transport()
+        transport._buffer_append(b'head')
+        transport._buffer_append(data)
+        transport._buffer_append(b'tail')
+        self.loop.add_writer(7, transport._write_ready)
+        transport._write_ready()
+
+        self.sock.sendmsg.assert_called_with([b'head', b'body', b'tail'])
+        self.assertFalse(self.sock.send.called)
+        self.loop.assert_writer(7, transport._write_ready)
+        # the partially sent buffer is sliced, not copied
+        self.assertIs(transport._buffer[0].obj, data)
+        self.assertEqual(transport.get_write_buffer_size(), 6)
+        self.assertEqual(list_to_buffer([b'dytail']), buffered(transport))
+
+    def test_write_ready_without_sendmsg(self):
+        del self.sock.sendmsg
+        self.sock.send.side_effect = [4, 2]
+
+        transport = self.socket_transport()
+        transport._buffer_append(b'head')
+        transport._buffer_append(b'body')
+        transport._buffer_append(b'tail')
+        self.loop.add_writer(7, transport._write_ready)
+        transport._write_ready()
+
+        # the buffers are sent one by one until the socket is full
+        self.assertEqual(self.sock.send.call_count, 2)
+        self.loop.assert_writer(7, transport._write_ready)
+        self.assertEqual(list_to_buffer([b'dytail']), buffered(transport))
 
     def test_write_ready_exception(self):
         err = self.sock.send.side_effect = OSError()
 
         transport = self.socket_transport()
         transport._fatal_error = mock.Mock()
-        transport._buffer.extend(b'data')
+        transport._buffer_append(b'data')
         transport._write_ready()
         transport._fatal_error.assert_called_with(
                                    err,
@@ -1084,7 +1463,7 @@ def test_write_ready_exception_and_close(self, m_log):
 
         transport = self.socket_transport()
         transport.close()
-        transport._buffer.extend(b'data')
+        transport._buffer_append(b'data')
         transport._write_ready()
         remove_writer.assert_called_with(self.sock_fd)
 
@@ -1102,7 +1481,7 @@ def test_write_eof_buffer(self):
         self.sock.send.side_effect = BlockingIOError
         tr.write(b'data')
         tr.write_eof()
-        self.assertEqual(tr._buffer, list_to_buffer([b'data']))
+        self.assertEqual(buffered(tr), list_to_buffer([b'data']))
         self.assertTrue(tr._eof)
         self.assertFalse(self.sock.shutdown.called)
         self.sock.send.side_effect = lambda _: 4
@@ -1337,6 +1716,33 @@ def test_write_ready_send(self):
         self.assertEqual(list_to_buffer(), transport._buffer)
         self.assertTrue(self.sslsock.send.called)
 
+    def test_empty_waiter(self):
+        transport = self._make_one()
+        transport._buffer = list_to_buffer([b'data'])
+        waiter = transport._make_empty_waiter()
+        self.assertFalse(waiter.done())
+        with self.assertRaises(RuntimeError):
+            transport._make_empty_waiter()
+
+        # the waiter is set when the buffer is flushed
+        self.sslsock.send.return_value = 4
+        transport._write_ready()
+        self.assertIsNone(waiter.result())
+        transport._reset_empty_waiter()
+
+        # the waiter fails when the transport is closed
+        transport._buffer = list_to_buffer([b'data'])
+        waiter = transport._make_empty_waiter()
+        transport._force_close(None)
+        self.assertIsInstance(waiter.exception(), ConnectionError)
+
+    def test_sendfile_fallback(self):
+        transport = self._make_one()
+        ret = self.loop.run_until_complete(
+            self.loop.sendfile(transport, io.BytesIO(b'header:data'), 7))
+        self.assertEqual(ret, 4)
+        self.assertEqual(list_to_buffer([b'data']), transport._buffer)
+
     def test_write_ready_send_none(self):
         self.sslsock.send.return_value = 0
         transport = self._make_one()
@@ -1492,11 +1898,93 @@ def datagram_transport(self, address=None):
     def test_read_ready(self):
         transport = self.datagram_transport()
 
-        self.sock.recvfrom.return_value = (b'data', ('0.0.0.0', 1234))
+        self.sock.recvfrom.side_effect = [(b'data', ('0.0.0.0', 1234)),
+                                          BlockingIOError]
+        transport._read_ready()
+
+        self.protocol.datagrams_received.assert_called_with(
+            [(b'data', ('0.0.0.0', 1234))])
+
+    def test_read_ready_batch(self):
+        transport = self.datagram_transport()
+        transport.max_batch_size = 3
+
+        datagrams = [(('data%d' % i).encode(), ('0.0.0.0', 1234))
+                     for i in range(5)]
+        self.sock.recvfrom.side_effect = datagrams + [BlockingIOError]
+        transport._read_ready()
+        self.protocol.datagrams_received.assert_called_with(datagrams[:3])
+
         transport._read_ready()
+        self.protocol.datagrams_received.assert_called_with(datagrams[3:])
+        self.assertEqual(self.protocol.datagrams_received.call_count, 2)
 
-        self.protocol.datagram_received.assert_called_with(
-            b'data', ('0.0.0.0', 1234))
+    def test_read_ready_datagram_received(self):
+        # A protocol without datagrams_received() gets datagrams one by one
+        class Proto:
+            def __init__(self):
+                self.datagrams = []
+
+            def connection_made(self, transport):
+                pass
+
+            def datagram_received(self, data, addr):
+                self.datagrams.append((data, addr))
+
+        self.protocol = Proto()
+        transport = self.datagram_transport()
+
+        self.sock.recvfrom.side_effect = [(b'data1', ('0.0.0.0', 1234)),
+                                          (b'data2', ('0.0.0.0', 1234)),
+                                          BlockingIOError]
+        transport._read_ready()
+
+        self.assertEqual(self.protocol.datagrams,
+                         [(b'data1', ('0.0.0.0', 1234)),
+                          (b'data2', ('0.0.0.0', 1234))])
+
+    def test_read_ready_datagram_received_close(self):
+        # The protocol closes the transport in the middle of a batch: the
+        # following datagrams and the error are not delivered
+        class Proto:
+            def __init__(self):
+                self.datagrams = []
+                self.error_received = mock.Mock()
+
+            def connection_made(self, transport):
+                pass
+
+            def datagram_received(self, data, addr):
+                self.datagrams.append((data, addr))
+                self.transport.close()
+
+        self.protocol = Proto()
+        transport = self.datagram_transport()
+        self.protocol.transport = transport
+        transport._fatal_error = mock.Mock()
+
+        for err in (OSError(), RuntimeError()):
+            transport._closing = False
+            del self.protocol.datagrams[:]
+            self.sock.recvfrom.side_effect = [(b'data1', ('0.0.0.0', 1234)),
+                                              (b'data2', ('0.0.0.0', 1234)),
+                                              err]
+            transport._read_ready()
+            self.assertEqual(self.protocol.datagrams,
+                             [(b'data1', ('0.0.0.0', 1234))])
+        self.assertFalse(self.protocol.error_received.called)
+        self.assertFalse(transport._fatal_error.called)
+
+    def test_read_ready_oserr_after_data(self):
+        transport = self.datagram_transport()
+
+        err = OSError()
+        self.sock.recvfrom.side_effect = [(b'data', ('0.0.0.0', 1234)), err]
+        transport._read_ready()
+
+        self.protocol.datagrams_received.assert_called_with(
+            [(b'data', ('0.0.0.0', 1234))])
+        self.protocol.error_received.assert_called_with(err)
 
     def test_read_ready_tryagain(self):
         transport = self.datagram_transport()
@@ -426,6 +426,77 @@ class EpollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn):
 
     SELECTOR = getattr(selectors, 'EpollSelector', None)
 
+    def test_modify_single_syscall(self):
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+        rd, wr = self.make_socketpair()
+        s.register(rd, selectors.EVENT_READ)
+
+        s.unregister = unittest.mock.Mock()
+        key = s.modify(rd, selectors.EVENT_READ | selectors.EVENT_WRITE)
+        self.assertFalse(s.unregister.called)
+        self.assertEqual(key, s.get_key(rd))
+        self.assertEqual(key.events,
+                         selectors.EVENT_READ | selectors.EVENT_WRITE)
+        self.assertEqual(s.select(0),
+                         [(key, selectors.EVENT_WRITE)])
+
+        self.assertRaises(ValueError, s.modify, rd, 0)
+        self.assertEqual(key, s.get_key(rd))
+
+
+@unittest.skipUnless(hasattr(selectors, 'BatchedEpollSelector'),
+                     "Test needs selectors.BatchedEpollSelector")
+class BatchedEpollSelectorTestCase(BaseSelectorTestCase,
+                                   ScalableSelectorMixIn):
+
+    SELECTOR = getattr(selectors, 'BatchedEpollSelector', None)
+
+    def test_modify_applied_in_select(self):
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+        rd, wr = self.make_socketpair()
+        s.register(wr, selectors.EVENT_READ)
+
+        epoll = unittest.mock.Mock(wraps=s._epoll)
+        s._epoll = epoll
+        key = s.modify(wr, selectors.EVENT_WRITE)
+        self.assertEqual(key, s.get_key(wr))
+        self.assertFalse(epoll.modify.called)
+
+        self.assertEqual(s.select(0), [(key, selectors.EVENT_WRITE)])
+        self.assertEqual(epoll.modify.call_count, 1)
+
+        # changing back and forth between two select() calls doesn't call
+        # epoll_ctl()
+        s.modify(wr, selectors.EVENT_READ)
+        key = s.modify(wr, selectors.EVENT_WRITE)
+        self.assertEqual(s.select(0), [(key, selectors.EVENT_WRITE)])
+        self.assertEqual(epoll.modify.call_count, 1)
+
+    def test_unregister_pending(self):
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+        rd, wr = self.make_socketpair()
+        s.register(wr, selectors.EVENT_READ)
+        s.modify(wr, selectors.EVENT_WRITE)
+        s.unregister(wr)
+        wr.close()
+        self.assertEqual(s.select(0), [])
+        self.assertEqual(s._pending, {})
+
+    def test_modify_after_fd_close(self):
+        s = self.SELECTOR()
+        self.addCleanup(s.close)
+        rd, wr = self.make_socketpair()
+        s.register(rd, selectors.EVENT_READ)
+        s.register(wr, selectors.EVENT_READ)
+        s.modify(rd, selectors.EVENT_WRITE)
+        key = s.modify(wr, selectors.EVENT_WRITE)
+        rd.close()
+        # the error of the closed FD is ignored
+        self.assertEqual(s.select(0), [(key, selectors.EVENT_WRITE)])
+
 
 @unittest.skipUnless(hasattr(selectors, 'KqueueSelector'),
                      "Test needs selectors.KqueueSelector)")
@@ -445,6 +516,7 @@ class DevpollSelectorTestCase(BaseSelectorTestCase, ScalableSelectorMixIn):
 def test_main():
     tests = [DefaultSelectorTestCase, SelectSelectorTestCase,
              PollSelectorTestCase, EpollSelectorTestCase,
+             BatchedEpollSelectorTestCase,
              KqueueSelectorTestCase, DevpollSelectorTestCase]
     support.run_unittest(*tests)
     support.reap_children()
@@ -0,0 +1,302 @@
+"""Tests for sendfile() and sock_sendfile() of event loops."""
+
+import io
+import os
+import socket
+import sys
+import tempfile
+import unittest
+
+import asyncio
+from asyncio import events
+from asyncio import test_utils
+
+
+DATA = b"12345abcde" * 16 * 1024  # 160 KiB
+
+
+class MyProto(asyncio.Protocol):
+
+    def __init__(self, loop):
+        self.transport = None
+        self.data = bytearray()
+        self.connected = asyncio.Future(loop=loop)
+        self.done = asyncio.Future(loop=loop)
+
+    def connection_made(self, transport):
+        self.transport = transport
+        self.connected.set_result(None)
+
+    def data_received(self, data):
+        self.data.extend(data)
+
+    def eof_received(self):
+        pass
+
+    def connection_lost(self, exc):
+        self.done.set_result(None)
+
+
+class SendfileTestsMixin:
+
+    def setUp(self):
+        super().setUp()
+        self.loop = self.create_event_loop()
+        self.set_event_loop(self.loop)
+        self.server = None
+        self.cli_transport = None
+        fd, filename = tempfile.mkstemp()
+        self.addCleanup(os.unlink, filename)
+        with open(fd, 'wb') as f:
+            f.write(DATA)
+        self.file = open(filename, 'rb')
+        self.addCleanup(self.file.close)
+
+    def tearDown(self):
+        if self.cli_transport is not None:
+            self.cli_transport.close()
+        if self.server is not None:
+            self.server.close()
+        # just in case if we have transport close callbacks
+        test_utils.run_briefly(self.loop)
+        self.loop.close()
+        super().tearDown()
+
+    def make_socketpair(self):
+        sock, peer = test_utils.socketpair()
+        self.addCleanup(sock.close)
+        self.addCleanup(peer.close)
+        sock.setblocking(False)
+        peer.setblocking(False)
+        return sock, peer
+
+    def run_sock_sendfile(self, sock, peer, *args, **kwds):
+        # Return (result of sock_sendfile(), data received by peer)
+        data = bytearray()
+
+        @asyncio.coroutine
+        def send():
+            try:
+                return (yield from self.loop.sock_sendfile(sock, self.file,
+                                                           *args, **kwds))
+            finally:
+                sock.shutdown(socket.SHUT_WR)
+
+        @asyncio.coroutine
+        def recv():
+            while True:
+                chunk = yield from self.loop.sock_recv(peer, 64 * 1024)
+                if not chunk:
+                    return
+                data.extend(chunk)
+
+        ret, _ = self.loop.run_until_complete(
+            asyncio.gather(send(), recv(), loop=self.loop))
+        return ret, bytes(data)
+
+    def test_sock_sendfile(self):
+        sock, peer = self.make_socketpair()
+        ret, data = self.run_sock_sendfile(sock, peer)
+        self.assertEqual(ret, len(DATA))
+        self.assertEqual(data, DATA)
+        self.assertEqual(self.file.tell(), len(DATA))
+
+    def test_sock_sendfile_offset_count(self):
+        sock, peer = self.make_socketpair()
+        ret, data = self.run_sock_sendfile(sock, peer, 1000, 2000)
+        self.assertEqual(ret, 2000)
+        self.assertEqual(data, DATA[1000:3000])
+        self.assertEqual(self.file.tell(), 3000)
+
+    def test_sock_sendfile_offset_past_end(self):
+        sock, peer = self.make_socketpair()
+        ret, data = self.run_sock_sendfile(sock, peer, len(DATA) + 10)
+        self.assertEqual(ret, 0)
+        self.assertEqual(data, b'')
+
+    def test_sock_sendfile_not_available(self):
+        sock, peer = self.make_socketpair()
+        # a file object without file descriptor
+        self.file = io.BytesIO(DATA)
+        with self.assertRaises(events.SendfileNotAvailableError):
+            self.loop.run_until_complete(
+                self.loop.sock_sendfile(sock, self.file, fallback=False))
+        self.assertEqual(self.file.tell(), 0)
+
+        ret, data = self.run_sock_sendfile(sock, peer, 10)
+        self.assertEqual(ret, len(DATA) - 10)
+        self.assertEqual(data, DATA[10:])
+        self.assertEqual(self.file.tell(), len(DATA))
+
+    def test_sock_sendfile_invalid_parameters(self):
+        sock, peer = self.make_socketpair()
+        with open(self.file.name, 'r') as text_file:
+            with self.assertRaises(ValueError):
+                self.loop.run_until_complete(
+                    self.loop.sock_sendfile(sock, text_file))
+        with self.assertRaises(TypeError):
+            self.loop.run_until_complete(
+                self.loop.sock_sendfile(sock, self.file, '1'))
+        with self.assertRaises(ValueError):
+            self.loop.run_until_complete(
+                self.loop.sock_sendfile(sock, self.file, -1))
+        with self.assertRaises(TypeError):
+            self.loop.run_until_complete(
+                self.loop.sock_sendfile(sock, self.file, 0, 1.0))
+        with self.assertRaises(ValueError):
+            self.loop.run_until_complete(
+                self.loop.sock_sendfile(sock, self.file, 0, 0))
+
+    def prepare(self):
+        # Return (server protocol, client transport) of a new connection
+        srv_proto = MyProto(self.loop)
+        self.server = self.loop.run_until_complete(
+            self.loop.create_server(lambda: srv_proto, '127.0.0.1', 0))
+        port = self.server.sockets[0].getsockname()[1]
+        cli_transport, cli_proto = self.loop.run_until_complete(
+            self.loop.create_connection(lambda: MyProto(self.loop),
+                                        '127.0.0.1', port))
+        self.cli_transport = cli_transport
+        self.loop.run_until_complete(srv_proto.connected)
+        return srv_proto, cli_transport
+
+    def close_and_wait(self, srv_proto, cli_transport):
+        cli_transport.close()
+        self.loop.run_until_complete(srv_proto.done)
+
+    def test_sendfile(self):
+        srv_proto, cli_transport = self.prepare()
+        cli_transport.write(b'header:')
+        ret = self.loop.run_until_complete(
+            self.loop.sendfile(cli_transport, self.file))
+        cli_transport.write(b':trailer')
+        self.close_and_wait(srv_proto, cli_transport)
+
+        self.assertEqual(ret, len(DATA))
+        self.assertEqual(srv_proto.data, b'header:' + DATA + b':trailer')
+        self.assertEqual(self.file.tell(), len(DATA))
+
+    def test_sendfile_offset_count(self):
+        srv_proto, cli_transport = self.prepare()
+        ret = self.loop.run_until_complete(
+            self.loop.sendfile(cli_transport, self.file, 1000, 2000))
+        self.close_and_wait(srv_proto, cli_transport)
+
+        self.assertEqual(ret, 2000)
+        self.assertEqual(srv_proto.data, DATA[1000:3000])
+        self.assertEqual(self.file.tell(), 3000)
+
+    def test_sendfile_fallback(self):
+        srv_proto, cli_transport = self.prepare()
+        self.file = io.BytesIO(DATA)
+        ret = self.loop.run_until_complete(
+            self.loop.sendfile(cli_transport, self.file, 10))
+        self.close_and_wait(srv_proto, cli_transport)
+
+        self.assertEqual(ret, len(DATA) - 10)
+        self.assertEqual(srv_proto.data, DATA[10:])
+        self.assertEqual(self.file.tell(), len(DATA))
+
+    def test_sendfile_no_fallback(self):
+        srv_proto, cli_transport = self.prepare()
+        self.file = io.BytesIO(DATA)
+        with self.assertRaises(events.SendfileNotAvailableError):
+            self.loop.run_until_complete(
+                self.loop.sendfile(cli_transport, self.file, fallback=False))
+        self.assertFalse(cli_transport._sendfile_active)
+        self.close_and_wait(srv_proto, cli_transport)
+        self.assertEqual(srv_proto.data, b'')
+
+    def fill_write_buffer(self, srv_proto, cli_transport):
+        # Write until the kernel buffers are full, return the written data
+        srv_proto.transport.pause_reading()
+        data = b'x' * (256 * 1024)
+        written = b''
+        while not cli_transport.get_write_buffer_size():
+            cli_transport.write(data)
+            written += data
+        return written
+
+    def test_sendfile_write_in_progress(self):
+        srv_proto, cli_transport = self.prepare()
+        # the file is sent once the write buffer is flushed
+        written = self.fill_write_buffer(srv_proto, cli_transport)
+        fut = asyncio.ensure_future(
+            self.loop.sendfile(cli_transport, self.file), loop=self.loop)
+        test_utils.run_briefly(self.loop)
+        self.assertTrue(cli_transport._sendfile_active)
+        with self.assertRaisesRegex(RuntimeError, 'sendfile is in progress'):
+            cli_transport.write(b'data')
+        with self.assertRaisesRegex(RuntimeError, 'sendfile is in progress'):
+            cli_transport.writelines([b'data'])
+        srv_proto.transport.resume_reading()
+        self.loop.run_until_complete(fut)
+        self.close_and_wait(srv_proto, cli_transport)
+        self.assertEqual(srv_proto.data, written + DATA)
+
+    def test_sendfile_closing_transport(self):
+        srv_proto, cli_transport = self.prepare()
+        cli_transport.close()
+        with self.assertRaisesRegex(RuntimeError, 'is closing'):
+            self.loop.run_until_complete(
+                self.loop.sendfile(cli_transport, self.file))
+        self.loop.run_until_complete(srv_proto.done)
+
+    def test_sendfile_peer_closed(self):
+        srv_proto, cli_transport = self.prepare()
+        # the client transport is closed while its buffer is not flushed
+        self.fill_write_buffer(srv_proto, cli_transport)
+        fut = asyncio.ensure_future(
+            self.loop.sendfile(cli_transport, io.BytesIO(DATA)),
+            loop=self.loop)
+        test_utils.run_briefly(self.loop)
+        cli_transport.abort()
+        with self.assertRaises(ConnectionError):
+            self.loop.run_until_complete(fut)
+        srv_proto.transport.resume_reading()
+        self.loop.run_until_complete(srv_proto.done)
+
+
+if sys.platform == 'win32':
+
+    class SelectEventLoopTests(SendfileTestsMixin, test_utils.TestCase):
+
+        def create_event_loop(self):
+            return asyncio.SelectorEventLoop()
+
+    class ProactorEventLoopTests(SendfileTestsMixin, test_utils.TestCase):
+
+        def create_event_loop(self):
+            return asyncio.ProactorEventLoop()
+
+else:
+    from asyncio import selectors
+
+    if hasattr(selectors, 'KqueueSelector'):
+        class KqueueEventLoopTests(SendfileTestsMixin, test_utils.TestCase):
+
+            def create_event_loop(self):
+                return asyncio.SelectorEventLoop(
+                    selectors.KqueueSelector())
+
+    if hasattr(selectors, 'EpollSelector'):
+        class EPollEventLoopTests(SendfileTestsMixin, test_utils.TestCase):
+
+            def create_event_loop(self):
+                return asyncio.SelectorEventLoop(selectors.EpollSelector())
+
+    if hasattr(selectors, 'PollSelector'):
+        class PollEventLoopTests(SendfileTestsMixin, test_utils.TestCase):
+
+            def create_event_loop(self):
+                return asyncio.SelectorEventLoop(selectors.PollSelector())
+
+    # Should always exist.
+    class SelectEventLoopTests(SendfileTestsMixin, test_utils.TestCase):
+
+        def create_event_loop(self):
+            return asyncio.SelectorEventLoop(selectors.SelectSelector())
+
+
+if __name__ == '__main__':
+    unittest.main()
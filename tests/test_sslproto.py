@@ -19,10 +19,11 @@ def setUp(self):
         self.loop = asyncio.new_event_loop()
         self.set_event_loop(self.loop)
 
-    def ssl_protocol(self, waiter=None):
+    def ssl_protocol(self, waiter=None, *, buffered=False):
         sslcontext = test_utils.dummy_ssl_context()
         app_proto = asyncio.Protocol()
-        proto = sslproto.SSLProtocol(self.loop, app_proto, sslcontext, waiter)
+        proto = sslproto.SSLProtocol(self.loop, app_proto, sslcontext, waiter,
+                                     buffered=buffered)
         self.addCleanup(proto._app_transport.close)
         return proto
 
@@ -66,6 +67,94 @@ def test_eof_received_waiter(self):
         test_utils.run_briefly(self.loop)
         self.assertIsInstance(waiter.exception(), ConnectionResetError)
 
+    def test_buffered_write_backlog(self):
+        ssl_proto = self.ssl_protocol(buffered=True)
+        self.connection_made(ssl_proto)
+        test_utils.run_briefly(self.loop)
+        transport = ssl_proto._transport
+        sslpipe = ssl_proto._sslpipe
+        sslpipe.feed_appdata.side_effect = lambda data, offset: ([], len(data))
+        sslpipe.flush_ssldata.return_value = [b'records']
+        transport.write.reset_mock()
+
+        # the records of all chunks of the backlog are sent at once
+        ssl_proto._write_backlog.extend([(b'data1', 0), (b'data2', 0)])
+        ssl_proto._process_write_backlog()
+        self.assertEqual(sslpipe.feed_appdata.call_count, 2)
+        transport.write.assert_called_once_with(b'records')
+        self.assertEqual(len(ssl_proto._write_backlog), 0)
+
+
+@unittest.skipIf(ssl is None, 'No ssl module')
+@unittest.skipUnless(sslproto._is_sslproto_available(), 'need ssl.MemoryBIO')
+class SSLPipeTests(unittest.TestCase):
+
+    def transfer(self, pipe, records):
+        ssldata = []
+        appdata = []
+        for data in records:
+            out, app = pipe.feed_ssldata(data)
+            ssldata.extend(out)
+            appdata.extend(app)
+        ssldata.extend(pipe.flush_ssldata())
+        return ssldata, appdata
+
+    def connect(self, buffered):
+        server = sslproto._SSLPipe(test_utils.server_ssl_context(), True,
+                                   buffered=buffered)
+        client = sslproto._SSLPipe(test_utils.dummy_ssl_context(), False,
+                                   buffered=buffered)
+        to_server = client.do_handshake() + client.flush_ssldata()
+        to_client = server.do_handshake() + server.flush_ssldata()
+        while to_server or to_client:
+            to_client, appdata = self.transfer(server, to_server)
+            self.assertEqual(appdata, [])
+            to_server, appdata = self.transfer(client, to_client)
+            self.assertEqual(appdata, [])
+        self.assertTrue(client.wrapped)
+        self.assertTrue(server.wrapped)
+        return client, server
+
+    def write(self, pipe, chunks):
+        records = []
+        for data in chunks:
+            ssldata, offset = pipe.feed_appdata(data)
+            self.assertEqual(offset, len(data))
+            records.extend(ssldata)
+        return records
+
+    def test_buffered(self):
+        client, server = self.connect(True)
+        self.assertTrue(client.buffered)
+
+        # records are kept until flush_ssldata() is called
+        records = self.write(client, [b'a' * 1000, b'b' * 1000, b'c'])
+        self.assertEqual(records, [])
+        records = client.flush_ssldata()
+        self.assertEqual(len(records), 1)
+        self.assertEqual(client.flush_ssldata(), [])
+
+        # the plaintext of the records is returned in a single buffer
+        ssldata, appdata = self.transfer(server, records)
+        self.assertEqual(ssldata, [])
+        self.assertEqual(appdata, [b'a' * 1000 + b'b' * 1000 + b'c'])
+
+        # more data than the read buffer
+        size = server.max_size + 10
+        records = self.write(client, [b'x' * size]) + client.flush_ssldata()
+        ssldata, appdata = self.transfer(server, records)
+        self.assertEqual(b''.join(appdata), b'x' * size)
+        self.assertTrue(all(appdata))
+
+    def test_unbuffered(self):
+        client, server = self.connect(False)
+        self.assertFalse(client.buffered)
+        records = self.write(client, [b'a' * 1000, b'b' * 1000])
+        self.assertEqual(len(records), 2)
+        self.assertEqual(client.flush_ssldata(), [])
+        ssldata, appdata = self.transfer(server, records)
+        self.assertEqual(appdata, [b'a' * 1000, b'b' * 1000])
+
 
 if __name__ == '__main__':
     unittest.main()
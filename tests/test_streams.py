@@ -340,6 +340,96 @@ def test_readline_exception(self):
             ValueError, self.loop.run_until_complete, stream.readline())
         self.assertEqual(b'', stream._buffer)
 
+    def test_readuntil(self):
+        stream = asyncio.StreamReader(loop=self.loop)
+        read_task = asyncio.Task(stream.readuntil(b'\r\n'), loop=self.loop)
+
+        def cb():
+            # the separator is split between two chunks
+            stream.feed_data(b'chunk1\r')
+            stream.feed_data(b'\nchunk2\r\n')
+        self.loop.call_soon(cb)
+
+        data = self.loop.run_until_complete(read_task)
+        self.assertEqual(b'chunk1\r\n', data)
+        data = self.loop.run_until_complete(stream.readuntil(b'\r\n'))
+        self.assertEqual(b'chunk2\r\n', data)
+        self.assertEqual(b'', stream._buffer)
+
+        self.assertRaises(ValueError, self.loop.run_until_complete,
+                          stream.readuntil(b''))
+
+    def test_readuntil_eof(self):
+        stream = asyncio.StreamReader(loop=self.loop)
+        stream.feed_data(b'some dataAA')
+        stream.feed_eof()
+
+        with self.assertRaises(asyncio.IncompleteReadError) as cm:
+            self.loop.run_until_complete(stream.readuntil(b'AAA'))
+        self.assertEqual(cm.exception.partial, b'some dataAA')
+        self.assertIsNone(cm.exception.expected)
+        self.assertEqual(b'', stream._buffer)
+
+    def test_readuntil_limit_found_sep(self):
+        stream = asyncio.StreamReader(loop=self.loop, limit=3)
+        stream.feed_data(b'some dataAA')
+
+        with self.assertRaisesRegex(asyncio.LimitOverrunError, 'not found'):
+            self.loop.run_until_complete(stream.readuntil(b'AAA'))
+        self.assertEqual(b'some dataAA', stream._buffer)
+
+        stream.feed_data(b'A')
+        with self.assertRaisesRegex(asyncio.LimitOverrunError,
+                                    'is found') as cm:
+            self.loop.run_until_complete(stream.readuntil(b'AAA'))
+        self.assertEqual(cm.exception.consumed, 9)
+        self.assertEqual(b'some dataAAA', stream._buffer)
+
+    def test_readinto(self):
+        stream = asyncio.StreamReader(loop=self.loop)
+        buf = bytearray(5)
+        read_task = asyncio.Task(stream.readinto(buf), loop=self.loop)
+
+        def cb():
+            stream.feed_data(b'abc')
+            stream.feed_data(b'defgh')
+        self.loop.call_soon(cb)
+
+        nbytes = self.loop.run_until_complete(read_task)
+        self.assertEqual(nbytes, 5)
+        self.assertEqual(buf, b'abcde')
+        self.assertEqual(b'fgh', stream._buffer)
+
+        view = memoryview(buf)
+        nbytes = self.loop.run_until_complete(stream.readinto(view[1:4]))
+        self.assertEqual(nbytes, 3)
+        self.assertEqual(buf, b'afghe')
+
+        stream.feed_eof()
+        nbytes = self.loop.run_until_complete(stream.readinto(buf))
+        self.assertEqual(nbytes, 0)
+
+    def test_chunked_buffer(self):
+        buf = asyncio.streams._ChunkedBuffer()
+        for chunk in (b'line1\nli', bytearray(b'ne2\n'), b'line3\n'):
+            buf.append(chunk)
+        self.assertEqual(len(buf), 18)
+        self.assertEqual(buf.find(b'\n'), 5)
+        self.assertEqual(buf.find(b'\n', 6), 11)
+        self.assertEqual(buf.find(b'line2'), 6)
+        self.assertEqual(buf.find(b'line', 13), -1)
+
+        # consume a part of the first chunk
+        self.assertEqual(buf.take(2), b'li')
+        self.assertEqual(buf.find(b'ne'), 0)
+        self.assertEqual(buf.find(b'ne', 1), 6)
+        self.assertEqual(buf.find(b'\n', 10), 15)
+        self.assertEqual(buf.take(6), b'ne1\nli')
+        self.assertEqual(buf, b'ne2\nline3\n')
+        self.assertEqual(buf.take(100), b'ne2\nline3\n')
+        self.assertEqual(len(buf), 0)
+        self.assertEqual(buf.find(b'\n'), -1)
+
     def test_readexactly_zero_or_less(self):
         # Read exact number of bytes (zero or less).
         stream = asyncio.StreamReader(loop=self.loop)
@@ -1,3 +1,4 @@
+import os
 import signal
 import sys
 import unittest
@@ -459,6 +460,40 @@ class SubprocessFastWatcherTests(SubprocessWatcherMixin,
 
         Watcher = unix_events.FastChildWatcher
 
+    def has_pidfd_support():
+        if unix_events._pidfd_open is None:
+            return False
+        try:
+            os.close(unix_events._pidfd_open(os.getpid()))
+        except OSError:
+            return False
+        return True
+
+    @unittest.skipUnless(has_pidfd_support(), "operating system does not "
+                                              "support pidfds")
+    class SubprocessPidfdWatcherTests(SubprocessWatcherMixin,
+                                      test_utils.TestCase):
+
+        Watcher = unix_events.PidfdChildWatcher
+
+        def test_set_event_loop_while_running(self):
+            # set_event_loop() attaches the watcher to another loop: the
+            # exit of a running process must still be reported
+            policy = asyncio.get_event_loop_policy()
+            create = asyncio.create_subprocess_exec(
+                sys.executable, '-c', 'import time; time.sleep(0.1)',
+                loop=self.loop)
+            proc = self.loop.run_until_complete(create)
+
+            other_loop = policy.new_event_loop()
+            self.addCleanup(other_loop.close)
+            policy.set_event_loop(other_loop)
+            policy.set_event_loop(self.loop)
+
+            returncode = self.loop.run_until_complete(
+                asyncio.wait_for(proc.wait(), 10.0, loop=self.loop))
+            self.assertEqual(returncode, 0)
+
 else:
     # Windows
     class SubprocessProactorTests(SubprocessMixin, test_utils.TestCase):
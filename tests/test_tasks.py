@@ -1429,6 +1429,110 @@ def coro2(loop):
                                                   loop=self.loop))
         self.assertIsNone(asyncio.Task.current_task(loop=self.loop))
 
+    def test_eager_start(self):
+        @asyncio.coroutine
+        def cached():
+            return 'hit'
+
+        @asyncio.coroutine
+        def outer():
+            task = asyncio.Task(cached(), loop=self.loop, eager_start=True)
+            # the task completed without an iteration of the event loop
+            self.assertTrue(task.done())
+            self.assertIs(asyncio.Task.current_task(loop=self.loop),
+                          outer_task)
+            return task.result()
+
+        outer_task = asyncio.Task(outer(), loop=self.loop)
+        self.assertEqual(self.loop.run_until_complete(outer_task), 'hit')
+        self.assertIsNone(asyncio.Task.current_task(loop=self.loop))
+
+    def test_eager_start_suspends(self):
+        fut = asyncio.Future(loop=self.loop)
+        steps = []
+
+        @asyncio.coroutine
+        def coro():
+            steps.append(asyncio.Task.current_task(loop=self.loop))
+            yield from fut
+            steps.append('resumed')
+            return 'done'
+
+        def start():
+            # started from a callback: there is no current task
+            task = asyncio.Task(coro(), loop=self.loop, eager_start=True)
+            self.assertEqual(steps, [task])
+            self.assertIs(task._fut_waiter, fut)
+            self.assertIsNone(asyncio.Task.current_task(loop=self.loop))
+            started.append(task)
+
+        started = []
+        self.loop.call_soon(start)
+        test_utils.run_briefly(self.loop)
+        fut.set_result(None)
+        self.assertEqual(self.loop.run_until_complete(started[0]), 'done')
+        self.assertEqual(steps[1], 'resumed')
+
+    def test_eager_start_loop_not_running(self):
+        @asyncio.coroutine
+        def coro():
+            return 'ok'
+
+        task = asyncio.Task(coro(), loop=self.loop, eager_start=True)
+        # the first step is scheduled as usual
+        self.assertFalse(task.done())
+        self.assertEqual(self.loop.run_until_complete(task), 'ok')
+
+    def test_eager_task_factory(self):
+        @asyncio.coroutine
+        def coro():
+            return 'ok'
+
+        @asyncio.coroutine
+        def main():
+            self.assertTrue(self.loop.create_task(coro()).done())
+            # eager=True is passed to the factory
+            self.assertTrue(self.loop.create_task(coro(), eager=True).done())
+
+        self.loop.set_task_factory(asyncio.eager_task_factory)
+        self.loop.run_until_complete(main())
+        self.loop.set_task_factory(None)
+
+    def test_create_task_eager(self):
+        @asyncio.coroutine
+        def coro():
+            return 'ok'
+
+        @asyncio.coroutine
+        def main():
+            task = self.loop.create_task(coro(), eager=True)
+            self.assertTrue(task.done())
+            task = self.loop.create_task(coro())
+            self.assertFalse(task.done())
+            yield from task
+
+        self.loop.run_until_complete(main())
+
+    def test_wakeup_callback_reused(self):
+        futs = [asyncio.Future(loop=self.loop) for i in range(2)]
+
+        @asyncio.coroutine
+        def coro():
+            for fut in futs:
+                yield from fut
+
+        task = asyncio.Task(coro(), loop=self.loop)
+        test_utils.run_briefly(self.loop)
+        wakeup = task._wakeup_cb
+        self.assertEqual(futs[0]._callbacks, [wakeup])
+        futs[0].set_result(None)
+        test_utils.run_briefly(self.loop)
+        self.assertIs(futs[1]._callbacks[0], wakeup)
+        futs[1].set_result(None)
+        self.loop.run_until_complete(task)
+        # the reference cycle is broken when the task is done
+        self.assertIsNone(task._wakeup_cb)
+
     # Some thorough tests for cancellation propagation through
     # coroutines, tasks and wait().
 
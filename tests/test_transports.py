@@ -86,6 +86,84 @@ def get_write_buffer_size(self):
         self.assertTrue(transport._protocol_paused)
         self.assertEqual(transport.get_write_buffer_limits(), (128, 256))
 
+    def test_flowcontrol_mixin_stats(self):
+
+        class MyTransport(transports._FlowControlMixin,
+                          transports.Transport):
+
+            def get_write_buffer_size(self):
+                return self.size
+
+        loop = mock.Mock()
+        loop.time.side_effect = [10.0, 12.5, 20.0, 21.0]
+        transport = MyTransport(loop=loop)
+        transport._protocol = mock.Mock()
+        transport.size = 0
+        transport.set_write_buffer_limits(high=100, low=10)
+
+        transport.size = 200
+        transport._maybe_pause_protocol()
+        transport.size = 0
+        transport._maybe_resume_protocol()
+        transport.size = 200
+        transport._maybe_pause_protocol()
+
+        stats = transport.get_extra_info('stats')
+        self.assertEqual(stats['writing_pauses'], 2)
+        self.assertEqual(stats['writing_resumes'], 1)
+        self.assertTrue(stats['writing_paused'])
+        # 2.5 seconds of the first pause and 1 second of the current pause
+        self.assertEqual(stats['writing_paused_time'], 3.5)
+        self.assertEqual(stats['bytes_sent'], 0)
+        self.assertEqual(stats['reads'], 0)
+
+        # transports without counters
+        self.assertIsNone(asyncio.Transport().get_extra_info('stats'))
+
+    def test_read_size_mixin(self):
+
+        class MyTransport(transports._ReadSizeMixin,
+                          transports.Transport):
+            pass
+
+        transport = MyTransport()
+        transport._set_read_size_limits()
+        self.assertEqual(transport._read_size, transport.min_size)
+        self.assertEqual(transport._max_read_size, transport.max_size)
+
+        with self.assertRaisesRegex(ValueError,
+                                    r'^max_size \(1\) must be >= min_size'):
+            transport._set_read_size_limits(min_size=2, max_size=1)
+        with self.assertRaisesRegex(ValueError,
+                                    '^min_size must be > 0, got 0$'):
+            transport._set_read_size_limits(min_size=0)
+
+        transport._set_read_size_limits(min_size=1024, max_size=4096)
+        self.assertEqual(transport._read_size, 1024)
+
+        # a full read doubles the size, up to max_size
+        transport._update_read_size(1024)
+        self.assertEqual(transport._read_size, 2048)
+        transport._update_read_size(2048)
+        transport._update_read_size(4096)
+        self.assertEqual(transport._read_size, 4096)
+
+        # a read filling half of the buffer keeps the size
+        transport._update_read_size(2048)
+        self.assertEqual(transport._read_size, 4096)
+
+        # small reads halve the size, down to min_size
+        transport._update_read_size(10)
+        self.assertEqual(transport._read_size, 2048)
+        transport._update_read_size(10)
+        transport._update_read_size(10)
+        self.assertEqual(transport._read_size, 1024)
+
+        # only a maximum: min_size is capped by it
+        transport._set_read_size_limits(max_size=100)
+        self.assertEqual((transport._read_size, transport._max_read_size),
+                         (100, 100))
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -358,47 +358,81 @@ def test_ctor(self):
         self.loop.assert_reader(5, tr._read_ready)
         self.assertIsNone(waiter.result())
 
-    @mock.patch('os.read')
-    def test__read_ready(self, m_read):
+    def assert_readv_called(self, m_readv, tr):
+        fd, buffers = m_readv.call_args[0]
+        self.assertEqual(fd, 5)
+        self.assertEqual(len(buffers), 1)
+        self.assertEqual(len(buffers[0]), tr.max_size)
+
+    @mock.patch('os.readv')
+    def test__read_ready(self, m_readv):
         tr = self.read_pipe_transport()
-        m_read.return_value = b'data'
+
+        def readv(fd, buffers):
+            buffers[0][:4] = b'data'
+            return 4
+
+        m_readv.side_effect = readv
         tr._read_ready()
 
-        m_read.assert_called_with(5, tr.max_size)
+        self.assert_readv_called(m_readv, tr)
         self.protocol.data_received.assert_called_with(b'data')
+        self.assertIs(type(self.protocol.data_received.call_args[0][0]),
+                      bytes)
+
+        # the buffer is reused
+        buf = m_readv.call_args[0][1][0]
+        tr._read_ready()
+        self.assertIs(m_readv.call_args[0][1][0], buf)
 
-    @mock.patch('os.read')
-    def test__read_ready_eof(self, m_read):
+    @mock.patch('os.readv')
+    def test_stats(self, m_readv):
         tr = self.read_pipe_transport()
-        m_read.return_value = b''
+        m_readv.return_value = 3
         tr._read_ready()
+        tr._read_ready()
+        tr.pause_reading()
+        tr.resume_reading()
 
-        m_read.assert_called_with(5, tr.max_size)
+        stats = tr.get_extra_info('stats')
+        self.assertEqual(stats['bytes_received'], 6)
+        self.assertEqual(stats['reads'], 2)
+        self.assertEqual(stats['reading_pauses'], 1)
+        self.assertEqual(stats['reading_resumes'], 1)
+        self.assertEqual(stats['bytes_sent'], 0)
+
+    @mock.patch('os.readv')
+    def test__read_ready_eof(self, m_readv):
+        tr = self.read_pipe_transport()
+        m_readv.return_value = 0
+        tr._read_ready()
+
+        self.assert_readv_called(m_readv, tr)
         self.assertFalse(self.loop.readers)
         test_utils.run_briefly(self.loop)
         self.protocol.eof_received.assert_called_with()
         self.protocol.connection_lost.assert_called_with(None)
 
-    @mock.patch('os.read')
-    def test__read_ready_blocked(self, m_read):
+    @mock.patch('os.readv')
+    def test__read_ready_blocked(self, m_readv):
         tr = self.read_pipe_transport()
-        m_read.side_effect = BlockingIOError
+        m_readv.side_effect = BlockingIOError
         tr._read_ready()
 
-        m_read.assert_called_with(5, tr.max_size)
+        self.assert_readv_called(m_readv, tr)
         test_utils.run_briefly(self.loop)
         self.assertFalse(self.protocol.data_received.called)
 
     @mock.patch('asyncio.log.logger.error')
-    @mock.patch('os.read')
-    def test__read_ready_error(self, m_read, m_logexc):
+    @mock.patch('os.readv')
+    def test__read_ready_error(self, m_readv, m_logexc):
         tr = self.read_pipe_transport()
         err = OSError()
-        m_read.side_effect = err
+        m_readv.side_effect = err
         tr._close = mock.Mock()
         tr._read_ready()
 
-        m_read.assert_called_with(5, tr.max_size)
+        self.assert_readv_called(m_readv, tr)
         tr._close.assert_called_with(err)
         m_logexc.assert_called_with(
             test_utils.MockPattern(
@@ -406,37 +440,37 @@ def test__read_ready_error(self, m_read, m_logexc):
                 '\nprotocol:.*\ntransport:.*'),
             exc_info=(OSError, MOCK_ANY, MOCK_ANY))
 
-    @mock.patch('os.read')
-    def test_pause_reading(self, m_read):
+    @mock.patch('os.readv')
+    def test_pause_reading(self, m_readv):
         tr = self.read_pipe_transport()
         m = mock.Mock()
         self.loop.add_reader(5, m)
         tr.pause_reading()
         self.assertFalse(self.loop.readers)
 
-    @mock.patch('os.read')
-    def test_resume_reading(self, m_read):
+    @mock.patch('os.readv')
+    def test_resume_reading(self, m_readv):
         tr = self.read_pipe_transport()
         tr.resume_reading()
         self.loop.assert_reader(5, tr._read_ready)
 
-    @mock.patch('os.read')
-    def test_close(self, m_read):
+    @mock.patch('os.readv')
+    def test_close(self, m_readv):
         tr = self.read_pipe_transport()
         tr._close = mock.Mock()
         tr.close()
         tr._close.assert_called_with(None)
 
-    @mock.patch('os.read')
-    def test_close_already_closing(self, m_read):
+    @mock.patch('os.readv')
+    def test_close_already_closing(self, m_readv):
         tr = self.read_pipe_transport()
         tr._closing = True
         tr._close = mock.Mock()
         tr.close()
         self.assertFalse(tr._close.called)
 
-    @mock.patch('os.read')
-    def test__close(self, m_read):
+    @mock.patch('os.readv')
+    def test__close(self, m_readv):
         tr = self.read_pipe_transport()
         err = object()
         tr._close(err)
@@ -518,7 +552,18 @@ def test_write(self, m_write):
         tr.write(b'data')
         m_write.assert_called_with(5, b'data')
         self.assertFalse(self.loop.writers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
+
+    @mock.patch('os.write')
+    def test_write_stats(self, m_write):
+        tr = self.write_pipe_transport()
+        m_write.return_value = 2
+        tr.write(b'data')
+        tr._write_ready()
+
+        stats = tr.get_extra_info('stats')
+        self.assertEqual(stats['bytes_sent'], 4)
+        self.assertEqual(stats['writes'], 2)
 
     @mock.patch('os.write')
     def test_write_no_data(self, m_write):
@@ -526,7 +571,7 @@ def test_write_no_data(self, m_write):
         tr.write(b'')
         self.assertFalse(m_write.called)
         self.assertFalse(self.loop.writers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
 
     @mock.patch('os.write')
     def test_write_partial(self, m_write):
@@ -535,17 +580,17 @@ def test_write_partial(self, m_write):
         tr.write(b'data')
         m_write.assert_called_with(5, b'data')
         self.loop.assert_writer(5, tr._write_ready)
-        self.assertEqual([b'ta'], tr._buffer)
+        self.assertEqual([b'ta'], list(tr._buffer))
 
     @mock.patch('os.write')
     def test_write_buffer(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
-        tr._buffer = [b'previous']
+        tr._buffer_append(b'previous')
         tr.write(b'data')
         self.assertFalse(m_write.called)
         self.loop.assert_writer(5, tr._write_ready)
-        self.assertEqual([b'previous', b'data'], tr._buffer)
+        self.assertEqual([b'previous', b'data'], list(tr._buffer))
 
     @mock.patch('os.write')
     def test_write_again(self, m_write):
@@ -554,7 +599,7 @@ def test_write_again(self, m_write):
         tr.write(b'data')
         m_write.assert_called_with(5, b'data')
         self.loop.assert_writer(5, tr._write_ready)
-        self.assertEqual([b'data'], tr._buffer)
+        self.assertEqual([b'data'], list(tr._buffer))
 
     @mock.patch('asyncio.unix_events.logger')
     @mock.patch('os.write')
@@ -566,7 +611,7 @@ def test_write_err(self, m_write, m_log):
         tr.write(b'data')
         m_write.assert_called_with(5, b'data')
         self.assertFalse(self.loop.writers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
         tr._fatal_error.assert_called_with(
                             err,
                             'Fatal write error on pipe transport')
@@ -606,58 +651,90 @@ def test__read_ready(self):
     def test__write_ready(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         m_write.return_value = 4
         tr._write_ready()
         m_write.assert_called_with(5, b'data')
         self.assertFalse(self.loop.writers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
+
+    @mock.patch('os.writev')
+    def test__write_ready_writev(self, m_writev):
+        tr = self.write_pipe_transport()
+        self.loop.add_writer(5, tr._write_ready)
+        data = b'ta'
+        tr._buffer_append(b'da')
+        tr._buffer_append(data)
+        tr._buffer_append(bytearray(b'!!'))
+        m_writev.return_value = 3
+        tr._write_ready()
+        m_writev.assert_called_with(5, [b'da', b'ta', b'!!'])
+        self.loop.assert_writer(5, tr._write_ready)
+        self.assertEqual([b'a', b'!!'], list(tr._buffer))
+        # the bytes object is sliced, not copied
+        self.assertIs(tr._buffer[0].obj, data)
+        self.assertEqual(tr.get_write_buffer_size(), 3)
+
+        m_writev.return_value = 3
+        tr._write_ready()
+        self.assertFalse(self.loop.writers)
+        self.assertEqual(tr.get_write_buffer_size(), 0)
+
+    @mock.patch('os.write')
+    def test_write_partial_bytearray(self, m_write):
+        tr = self.write_pipe_transport()
+        data = bytearray(b'data')
+        m_write.return_value = 2
+        tr.write(data)
+        data[:] = b'xxxx'
+        # the data not written was copied
+        self.assertEqual([b'ta'], list(tr._buffer))
 
     @mock.patch('os.write')
     def test__write_ready_partial(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         m_write.return_value = 3
         tr._write_ready()
         m_write.assert_called_with(5, b'data')
         self.loop.assert_writer(5, tr._write_ready)
-        self.assertEqual([b'a'], tr._buffer)
+        self.assertEqual([b'a'], list(tr._buffer))
 
     @mock.patch('os.write')
     def test__write_ready_again(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         m_write.side_effect = BlockingIOError()
         tr._write_ready()
         m_write.assert_called_with(5, b'data')
         self.loop.assert_writer(5, tr._write_ready)
-        self.assertEqual([b'data'], tr._buffer)
+        self.assertEqual([b'data'], list(tr._buffer))
 
     @mock.patch('os.write')
     def test__write_ready_empty(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         m_write.return_value = 0
         tr._write_ready()
         m_write.assert_called_with(5, b'data')
         self.loop.assert_writer(5, tr._write_ready)
-        self.assertEqual([b'data'], tr._buffer)
+        self.assertEqual([b'data'], list(tr._buffer))
 
     @mock.patch('asyncio.log.logger.error')
     @mock.patch('os.write')
     def test__write_ready_err(self, m_write, m_logexc):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         m_write.side_effect = err = OSError()
         tr._write_ready()
         m_write.assert_called_with(5, b'data')
         self.assertFalse(self.loop.writers)
         self.assertFalse(self.loop.readers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
         self.assertTrue(tr._closing)
         m_logexc.assert_called_with(
             test_utils.MockPattern(
@@ -673,13 +750,13 @@ def test__write_ready_closing(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
         tr._closing = True
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         m_write.return_value = 4
         tr._write_ready()
         m_write.assert_called_with(5, b'data')
         self.assertFalse(self.loop.writers)
         self.assertFalse(self.loop.readers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
         self.protocol.connection_lost.assert_called_with(None)
         self.pipe.close.assert_called_with()
 
@@ -688,12 +765,12 @@ def test_abort(self, m_write):
         tr = self.write_pipe_transport()
         self.loop.add_writer(5, tr._write_ready)
         self.loop.add_reader(5, tr._read_ready)
-        tr._buffer = [b'da', b'ta']
+        tr._buffer_append(b'data')
         tr.abort()
         self.assertFalse(m_write.called)
         self.assertFalse(self.loop.readers)
         self.assertFalse(self.loop.writers)
-        self.assertEqual([], tr._buffer)
+        self.assertEqual([], list(tr._buffer))
         self.assertTrue(tr._closing)
         test_utils.run_briefly(self.loop)
         self.protocol.connection_lost.assert_called_with(None)
@@ -750,7 +827,7 @@ def test_write_eof(self):
 
     def test_write_eof_pending(self):
         tr = self.write_pipe_transport()
-        tr._buffer = [b'data']
+        tr._buffer_append(b'data')
         tr.write_eof()
         self.assertTrue(tr._closing)
         self.assertFalse(self.protocol.connection_lost.called)
@@ -1479,6 +1556,118 @@ def create_watcher(self):
         return asyncio.FastChildWatcher()
 
 
+class PidfdChildWatcherTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = self.new_test_loop()
+        patcher = mock.patch('asyncio.unix_events._pidfd_open',
+                             side_effect=self.pidfd_open)
+        self.pidfd_open = patcher.start()
+        self.addCleanup(patcher.stop)
+        self.watcher = asyncio.PidfdChildWatcher()
+        # the constructor checks that pidfd_open() works
+        self.pidfd_open.assert_called_once_with(os.getpid())
+        self.pidfd_open.reset_mock()
+        self.watcher.attach_loop(self.loop)
+        self.addCleanup(self.watcher.close)
+
+    def pidfd_open(self, pid):
+        # the read end of a pipe plays the pidfd
+        rfd, wfd = os.pipe()
+        self.addCleanup(os.close, wfd)
+        return rfd
+
+    def assert_closed(self, fd):
+        with self.assertRaises(OSError):
+            os.fstat(fd)
+
+    def test_unsupported_kernel(self):
+        self.pidfd_open.side_effect = OSError(errno.ENOSYS,
+                                              'Function not implemented')
+        with self.assertRaises(RuntimeError):
+            asyncio.PidfdChildWatcher()
+
+    def test_pidfd_open_syscall(self):
+        for machine, number in (('x86_64', 434), ('i686', 434),
+                                ('aarch64', 434), ('armv7l', 434),
+                                ('ppc64le', 434), ('alpha', 544),
+                                ('ia64', 1458), ('unknown', None)):
+            self.assertEqual(unix_events._pidfd_open_syscall(machine),
+                             number, machine)
+
+    @mock.patch('os.waitpid')
+    def test_child_exited(self, m_waitpid):
+        callback = mock.Mock()
+        self.watcher.add_child_handler(42, callback, 'arg')
+        self.pidfd_open.assert_called_once_with(42)
+        pidfd, = self.loop.readers
+        self.assertFalse(m_waitpid.called)
+
+        m_waitpid.return_value = (42, 3 << 8)
+        self.loop.readers[pidfd]._run()
+        m_waitpid.assert_called_once_with(42, os.WNOHANG)
+        callback.assert_called_once_with(42, 3, 'arg')
+        self.assertFalse(self.loop.readers)
+        self.assert_closed(pidfd)
+
+    @mock.patch('os.waitpid')
+    def test_child_already_reaped(self, m_waitpid):
+        callback = mock.Mock()
+        self.watcher.add_child_handler(42, callback)
+        pidfd, = self.loop.readers
+
+        m_waitpid.side_effect = ChildProcessError
+        with mock.patch.object(log.logger, 'warning') as m_warning:
+            self.loop.readers[pidfd]._run()
+        self.assertTrue(m_warning.called)
+        callback.assert_called_once_with(42, 255)
+
+    def test_replace_handler(self):
+        callback1 = mock.Mock()
+        callback2 = mock.Mock()
+        self.watcher.add_child_handler(42, callback1)
+        self.watcher.add_child_handler(42, callback2)
+        self.assertEqual(self.pidfd_open.call_count, 1)
+        self.assertEqual(len(self.loop.readers), 1)
+        self.assertEqual(self.watcher._callbacks[42][1:], (callback2, ()))
+
+    def test_remove_child_handler(self):
+        self.watcher.add_child_handler(42, mock.Mock())
+        pidfd, = self.loop.readers
+        self.assertTrue(self.watcher.remove_child_handler(42))
+        self.assertFalse(self.loop.readers)
+        self.assert_closed(pidfd)
+        self.assertFalse(self.watcher.remove_child_handler(42))
+
+    def test_attach_new_loop(self):
+        callback = mock.Mock()
+        self.watcher.add_child_handler(42, callback)
+        pidfd, = self.loop.readers
+
+        loop = self.new_test_loop()
+        self.watcher.attach_loop(loop)
+        # the handlers are kept and move to the new loop
+        self.assertFalse(self.loop.readers)
+        self.assertEqual(list(loop.readers), [pidfd])
+        self.assertIn(42, self.watcher._callbacks)
+
+        with mock.patch('os.waitpid', return_value=(42, 0)):
+            loop.readers[pidfd]._run()
+        callback.assert_called_once_with(42, 0)
+        self.assertFalse(loop.readers)
+        self.assert_closed(pidfd)
+
+    def test_detach_loop_pending_handlers(self):
+        self.watcher.add_child_handler(42, mock.Mock())
+        self.watcher.add_child_handler(43, mock.Mock())
+        pidfds = list(self.loop.readers)
+        with self.assertWarns(RuntimeWarning):
+            self.watcher.attach_loop(None)
+        self.assertFalse(self.loop.readers)
+        for pidfd in pidfds:
+            self.assert_closed(pidfd)
+
+
 class PolicyTests(unittest.TestCase):
 
     def create_policy(self):
@@ -1,5 +1,7 @@
 import os
+import socket
 import sys
+import threading
 import unittest
 from unittest import mock
 
@@ -12,6 +14,7 @@
 from asyncio import _overlapped
 from asyncio import test_utils
 from asyncio import windows_events
+from asyncio import windows_utils
 
 
 class UpperProto(asyncio.Protocol):
@@ -43,6 +46,64 @@ def test_close(self):
         self.assertEqual(f.result(), b'')
         b.close()
 
+    def test_recv_into(self):
+        a, b = self.loop._socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+        buf = bytearray(10)
+        fut = self.loop._proactor.recv_into(b, buf)
+        a.send(b'data')
+        nbytes = self.loop.run_until_complete(fut)
+        self.assertEqual(nbytes, 4)
+        self.assertEqual(buf[:nbytes], b'data')
+
+        # the overlapped object requires a writable buffer
+        self.assertRaises(TypeError, self.loop._proactor.recv_into, b, b'xxx')
+
+    def test_send_buffers(self):
+        a, b = self.loop._socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+        fut = self.loop._proactor.send_buffers(
+            a, [b'head', bytearray(b'-'), memoryview(b'body')])
+        nbytes = self.loop.run_until_complete(fut)
+        self.assertEqual(nbytes, 9)
+
+        data = b''
+        while len(data) < nbytes:
+            chunk = self.loop.run_until_complete(
+                self.loop._proactor.recv(b, 100))
+            self.assertTrue(chunk)
+            data += chunk
+        self.assertEqual(data, b'head-body')
+
+        ov = _overlapped.Overlapped(_overlapped.NULL)
+        self.assertRaises(TypeError, ov.WSASendBuffers, a.fileno(), 123, 0)
+        ov = _overlapped.Overlapped(_overlapped.NULL)
+        self.assertRaises(TypeError,
+                          ov.WSASendBuffers, a.fileno(), [b'data', 'str'], 0)
+
+    def test_recvfrom_sendto(self):
+        receiver = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.addCleanup(receiver.close)
+        receiver.bind(('127.0.0.1', 0))
+        sender = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.addCleanup(sender.close)
+        sender.bind(('127.0.0.1', 0))
+
+        recv_fut = self.loop._proactor.recvfrom(receiver, 100)
+        nbytes = self.loop.run_until_complete(
+            self.loop._proactor.sendto(sender, b'data',
+                                       addr=receiver.getsockname()))
+        self.assertEqual(nbytes, 4)
+        data, addr = self.loop.run_until_complete(recv_fut)
+        self.assertEqual(data, b'data')
+        self.assertEqual(addr, sender.getsockname())
+
+        ov = _overlapped.Overlapped(_overlapped.NULL)
+        self.assertRaises(TypeError, ov.WSASendTo, sender.fileno(), b'data',
+                          0, 'invalid address')
+
     def test_double_bind(self):
         ADDRESS = r'\\.\pipe\test_double_bind-%s' % os.getpid()
         server1 = windows_events.PipeServer(ADDRESS)
@@ -92,6 +153,73 @@ def _test_pipe(self):
 
         return 'done'
 
+    def test_pipe_accept_concurrency(self):
+        ADDRESS = r'\\.\pipe\_test_pipe_burst-%s' % os.getpid()
+        [server] = self.loop.run_until_complete(
+            self.loop.start_serving_pipe(UpperProto, ADDRESS,
+                                         accept_concurrency=3))
+        self.addCleanup(server.close)
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(len(server._accept_pipe_futures), 3)
+
+        # a burst of clients connects without ERROR_PIPE_BUSY
+        with mock.patch.object(self.loop._proactor, '_wait_named_pipe',
+                               side_effect=AssertionError):
+            clients = self.loop.run_until_complete(asyncio.gather(
+                *[self.loop.create_pipe_connection(asyncio.Protocol, ADDRESS)
+                  for i in range(3)],
+                loop=self.loop))
+        for trans, proto in clients:
+            trans.close()
+        test_utils.run_briefly(self.loop)
+        self.assertEqual(len(server._accept_pipe_futures), 3)
+
+        server.close()
+        self.assertEqual(server._accept_pipe_futures, set())
+
+    def test_pipe_accept_concurrency_invalid(self):
+        ADDRESS = r'\\.\pipe\_test_pipe_invalid-%s' % os.getpid()
+        with self.assertRaises(ValueError):
+            self.loop.run_until_complete(
+                self.loop.start_serving_pipe(UpperProto, ADDRESS,
+                                             accept_concurrency=0))
+
+    def test_connect_pipe_wait(self):
+        exc = OSError()
+        exc.winerror = _overlapped.ERROR_PIPE_BUSY
+        with mock.patch.object(_overlapped, 'ConnectPipe',
+                               side_effect=[exc, 123]) as connect, \
+             mock.patch.object(_winapi, 'WaitNamedPipe') as wait, \
+             mock.patch.object(windows_utils, 'PipeHandle') as pipe_handle:
+            pipe = self.loop.run_until_complete(
+                self.loop._proactor.connect_pipe('pipe_address'))
+        # the connection is retried once an instance waits for a client
+        wait.assert_called_once_with('pipe_address',
+                                     windows_events.CONNECT_PIPE_WAIT_TIMEOUT)
+        self.assertEqual(connect.call_count, 2)
+        pipe_handle.assert_called_once_with(123)
+        self.assertIs(pipe, pipe_handle.return_value)
+        # the wait ran in the executor of the proactor
+        self.assertIsNot(self.loop._proactor._pipe_wait_executor, None)
+        self.assertIsNot(self.loop._proactor._pipe_wait_executor,
+                         self.loop._default_executor)
+        self.assertEqual(self.loop._proactor._pipe_waits, 0)
+
+    def test_connect_pipe_wait_busy(self):
+        exc = OSError()
+        exc.winerror = _overlapped.ERROR_PIPE_BUSY
+        # all the waiting threads are busy: sleep instead
+        self.loop._proactor._pipe_waits = windows_events.CONNECT_PIPE_MAX_WAITS
+        with mock.patch.object(_overlapped, 'ConnectPipe',
+                               side_effect=[exc, 123]) as connect, \
+             mock.patch.object(_winapi, 'WaitNamedPipe') as wait, \
+             mock.patch.object(windows_utils, 'PipeHandle'):
+            self.loop.run_until_complete(
+                self.loop._proactor.connect_pipe('pipe_address'))
+        self.assertFalse(wait.called)
+        self.assertEqual(connect.call_count, 2)
+        self.assertIsNone(self.loop._proactor._pipe_wait_executor)
+
     def test_connect_pipe_cancel(self):
         exc = OSError()
         exc.winerror = _overlapped.ERROR_PIPE_BUSY
@@ -104,6 +232,168 @@ def test_connect_pipe_cancel(self):
             with self.assertRaises(asyncio.CancelledError):
                 self.loop.run_until_complete(task)
 
+    def test_get_queued_completion_status_ex(self):
+        iocp = _overlapped.CreateIoCompletionPort(
+            _overlapped.INVALID_HANDLE_VALUE, _overlapped.NULL, 0, 1)
+        self.addCleanup(_winapi.CloseHandle, iocp)
+        ovs = [_overlapped.Overlapped(_overlapped.NULL) for i in range(3)]
+
+        # timeout: empty list
+        self.assertEqual(
+            _overlapped.GetQueuedCompletionStatusEx(iocp, 10, 0), [])
+
+        for i, ov in enumerate(ovs):
+            _overlapped.PostQueuedCompletionStatus(iocp, i, 0, ov.address)
+
+        # max_entries limits the number of dequeued events
+        statuses = _overlapped.GetQueuedCompletionStatusEx(iocp, 2, 0)
+        statuses += _overlapped.GetQueuedCompletionStatusEx(iocp, 2, 0)
+        self.assertEqual(
+            sorted((transferred, address)
+                   for err, transferred, key, address in statuses),
+            [(i, ov.address) for i, ov in enumerate(ovs)])
+
+        self.assertRaises(ValueError,
+                          _overlapped.GetQueuedCompletionStatusEx, iocp, 0, 0)
+
+    def test_poll_drains_port(self):
+        proactor = self.loop._proactor
+        for have_ex, ncall in ((True, 1), (False, 3)):
+            with mock.patch.object(_overlapped,
+                                   'HAVE_GET_QUEUED_COMPLETION_STATUS_EX',
+                                   have_ex), \
+                 mock.patch.object(_overlapped, 'GetQueuedCompletionStatusEx',
+                                   side_effect=[[(0, 0, 0, 1)],
+                                                [(0, 0, 0, 2)],
+                                                []]) as get_statuses:
+                proactor._poll_statuses(0)
+            # a short batch means that the port is empty, except with the
+            # fallback which dequeues one event per call
+            self.assertEqual(get_statuses.call_count, ncall)
+
+    def test_get_queued_completion_status_ex_null_overlapped(self):
+        iocp = _overlapped.CreateIoCompletionPort(
+            _overlapped.INVALID_HANDLE_VALUE, _overlapped.NULL, 0, 1)
+        self.addCleanup(_winapi.CloseHandle, iocp)
+
+        # packets posted without an overlapped structure
+        for i in range(2):
+            _overlapped.PostQueuedCompletionStatus(iocp, i, 7,
+                                                   _overlapped.NULL)
+        statuses = _overlapped.GetQueuedCompletionStatusEx(iocp, 5, 0)
+        self.assertEqual(sorted(statuses),
+                         [(0, 0, 7, _overlapped.NULL),
+                          (0, 1, 7, _overlapped.NULL)])
+
+    def test_skip_completion_port_on_success(self):
+        proactor = self.loop._proactor
+        a, b = self.loop._socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+
+        proactor._register_with_iocp(a)
+        if a not in proactor._skip_completion_port:
+            self.skipTest('FILE_SKIP_COMPLETION_PORT_ON_SUCCESS unsupported')
+
+        # a small send on a local socket completes immediately: it must not
+        # wait for a completion event
+        ncache = len(proactor._cache)
+        fut = proactor.send(a, b'data')
+        self.assertTrue(fut.done())
+        self.assertEqual(fut.result(), 4)
+        self.assertEqual(len(proactor._cache), ncache)
+
+        data = self.loop.run_until_complete(proactor.recv(b, 100))
+        self.assertEqual(data, b'data')
+
+    def test_overlapped_reset(self):
+        a, b = self.loop._socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+        a.send(b'data')
+
+        ov = _overlapped.Overlapped(_overlapped.NULL)
+        ov.WSARecv(b.fileno(), 100, 0)
+        self.assertEqual(ov.getresult(True), b'data')
+
+        # the same object can be used for a new operation
+        ov.reset()
+        self.assertRaises(ValueError, ov.getresult)
+        a.send(b'more')
+        ov.WSARecv(b.fileno(), 100, 0)
+        self.assertEqual(ov.getresult(True), b'more')
+        ov.reset()
+
+        # a pending operation cannot be reset
+        ov.WSARecv(b.fileno(), 100, 0)
+        self.assertTrue(ov.pending)
+        self.assertRaises(ValueError, ov.reset)
+        a.send(b'x')
+        self.assertEqual(ov.getresult(True), b'x')
+
+    def test_reuse_overlapped(self):
+        proactor = self.loop._proactor
+        a, b = self.loop._socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+
+        fut = proactor.recv(b, 100)
+        ov = fut._ov
+        a.send(b'data')
+        self.assertEqual(self.loop.run_until_complete(fut), b'data')
+        self.assertIn(ov, proactor._free_overlapped)
+
+        # the next operation reuses the Overlapped object
+        fut = proactor.recv(b, 100)
+        self.assertIs(fut._ov, ov)
+        self.assertNotIn(ov, proactor._free_overlapped)
+        a.send(b'more')
+        self.assertEqual(self.loop.run_until_complete(fut), b'more')
+
+    def test_accept_socket_reuse(self):
+        proactor = self.loop._proactor
+        proactor.accept_pool_size = 1
+        listener = socket.socket()
+        self.addCleanup(listener.close)
+        listener.bind(('127.0.0.1', 0))
+        listener.listen(1)
+        address = listener.getsockname()
+
+        def accept():
+            client = socket.socket()
+            self.addCleanup(client.close)
+            fut = proactor.accept(listener)
+            client.connect(address)
+            conn, addr = self.loop.run_until_complete(fut)
+            self.assertEqual(addr, client.getsockname())
+            return conn
+
+        conn = accept()
+        self.assertTrue(proactor.recycle_accept_socket(conn))
+        test_utils.run_until(self.loop,
+                             lambda: proactor._accept_sockets[conn.family])
+        self.assertEqual(proactor._accept_sockets[conn.family], [conn])
+
+        # the pool is full
+        conn2 = socket.socket()
+        self.addCleanup(conn2.close)
+        self.assertFalse(proactor.recycle_accept_socket(conn2))
+
+        # the disconnected socket is used by the next accept
+        self.assertIs(accept(), conn)
+        self.assertEqual(proactor._accept_sockets[conn.family], [])
+        conn.close()
+
+    def test_wakeup(self):
+        proactor = self.loop._proactor
+        proactor.wakeup()
+        proactor.wakeup()
+        start = self.loop.time()
+        self.assertEqual(proactor.select(10.0), [])
+        self.assertLess(self.loop.time() - start, 5.0)
+        # the wake-up events are not registered operations
+        self.assertNotIn(proactor._wakeup_ov.address, proactor._cache)
+
     def test_wait_for_handle(self):
         event = _overlapped.CreateEvent(None, True, False, None)
         self.addCleanup(_winapi.CloseHandle, event)
@@ -157,5 +447,78 @@ def test_wait_for_handle_cancel(self):
         fut.cancel()
 
 
+class IocpCompletionPortTests(test_utils.TestCase):
+
+    def setUp(self):
+        self.loop = asyncio.ProactorEventLoop()
+        self.set_event_loop(self.loop)
+        self.port = windows_events.IocpCompletionPort()
+
+    def tearDown(self):
+        self.port.close()
+        super().tearDown()
+
+    def new_proactor(self):
+        proactor = windows_events.IocpProactor(completion_port=self.port)
+        proactor.set_loop(self.loop)
+        return proactor
+
+    def test_handoff(self):
+        proactor_a = self.new_proactor()
+        proactor_b = self.new_proactor()
+        self.assertNotEqual(proactor_a._key, proactor_b._key)
+        self.assertEqual(repr(self.port),
+                         '<IocpCompletionPort proactors=2>')
+        # the port is used by the proactors
+        self.assertRaises(RuntimeError, self.port.close)
+
+        a, b = windows_utils.socketpair()
+        self.addCleanup(a.close)
+        self.addCleanup(b.close)
+        fut = proactor_b.recv(b, 100)
+        a.send(b'data')
+
+        # the completion event of proactor_b is dequeued by proactor_a and
+        # handed off to proactor_b
+        proactor_a._poll(1.0)
+        self.assertEqual(len(proactor_b._handoff), 1)
+        self.assertFalse(fut.done())
+
+        proactor_b._poll(0)
+        self.assertEqual(len(proactor_b._handoff), 0)
+        self.assertEqual(fut.result(), b'data')
+
+        proactor_a.close()
+        proactor_b.close()
+        self.assertEqual(repr(self.port),
+                         '<IocpCompletionPort proactors=0>')
+
+    def test_threads(self):
+        results = []
+
+        def worker():
+            loop = asyncio.ProactorEventLoop(
+                windows_events.IocpProactor(completion_port=self.port))
+            try:
+                a, b = loop._socketpair()
+                for i in range(20):
+                    data = ('%s' % i).encode('ascii')
+                    loop.run_until_complete(loop.sock_sendall(a, data))
+                    results.append(
+                        loop.run_until_complete(loop.sock_recv(b, 100)))
+                a.close()
+                b.close()
+            finally:
+                loop.close()
+
+        threads = [threading.Thread(target=worker) for i in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        expected = [('%s' % i).encode('ascii') for i in range(20)] * 4
+        self.assertEqual(sorted(results), sorted(expected))
+
+
 if __name__ == '__main__':
     unittest.main()
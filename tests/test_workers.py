@@ -0,0 +1,178 @@
+"""Tests for workers.py"""
+
+import errno
+import os
+import socket
+import threading
+import unittest
+from unittest import mock
+
+import asyncio
+from asyncio import test_utils
+
+
+class WhoAmIProtocol(asyncio.Protocol):
+    # Reply with the name of the worker thread and the worker process
+
+    def connection_made(self, transport):
+        name = '%s:%s' % (os.getpid(), threading.current_thread().name)
+        transport.write(name.encode('ascii'))
+        transport.close()
+
+
+def whoami(address):
+    with socket.create_connection(address, timeout=10.0) as sock:
+        data = b''
+        while True:
+            chunk = sock.recv(100)
+            if not chunk:
+                break
+            data += chunk
+    return data.decode('ascii')
+
+
+class ServerWorkersTests(test_utils.TestCase):
+
+    def start_workers(self, *args, **kwds):
+        workers = asyncio.ServerWorkers(WhoAmIProtocol, *args, **kwds)
+        workers.start()
+        self.addCleanup(workers.stop)
+        return workers
+
+    def test_invalid_arguments(self):
+        with self.assertRaises(ValueError):
+            asyncio.ServerWorkers(WhoAmIProtocol, '127.0.0.1', 0, workers=0)
+        sock = socket.socket()
+        self.addCleanup(sock.close)
+        if hasattr(socket, 'SO_REUSEPORT'):
+            with self.assertRaises(ValueError):
+                asyncio.ServerWorkers(WhoAmIProtocol, sock=sock,
+                                      reuse_port=True)
+            # each worker would bind a different port
+            with self.assertRaises(ValueError):
+                asyncio.ServerWorkers(WhoAmIProtocol, '127.0.0.1', 0,
+                                      reuse_port=True)
+
+    def test_repr(self):
+        workers = asyncio.ServerWorkers(WhoAmIProtocol, '127.0.0.1', 0,
+                                        workers=3)
+        self.assertEqual(repr(workers), '<ServerWorkers workers=3>')
+        workers.start()
+        try:
+            self.assertEqual(repr(workers),
+                             '<ServerWorkers workers=3 running>')
+        finally:
+            workers.stop()
+        self.assertEqual(repr(workers), '<ServerWorkers workers=3>')
+
+    def test_threads_shared_socket(self):
+        workers = self.start_workers('127.0.0.1', 0, workers=3)
+        self.assertEqual(len(workers.sockets), 1)
+        address = workers.sockets[0].getsockname()
+
+        names = {whoami(address) for i in range(10)}
+        pid = os.getpid()
+        for name in names:
+            self.assertTrue(name.startswith('%s:ServerWorker-' % pid), name)
+
+        workers.stop()
+        self.assertIsNone(workers.sockets)
+        self.assertTrue(workers.wait(0))
+        with self.assertRaises(ConnectionRefusedError):
+            whoami(address)
+
+    def test_threads_user_socket(self):
+        sock = socket.socket()
+        self.addCleanup(sock.close)
+        sock.bind(('127.0.0.1', 0))
+        address = sock.getsockname()
+
+        workers = self.start_workers(sock=sock, workers=2)
+        self.assertEqual(workers.sockets, [sock])
+        self.assertIn(':ServerWorker-', whoami(address))
+
+        workers.stop()
+        # the socket of the caller is not closed
+        self.assertNotEqual(sock.fileno(), -1)
+
+    def test_start_error(self):
+        sock = socket.socket()
+        self.addCleanup(sock.close)
+        sock.bind(('127.0.0.1', 0))
+        host, port = sock.getsockname()
+
+        workers = asyncio.ServerWorkers(WhoAmIProtocol, host, port,
+                                        workers=2)
+        with self.assertRaises(OSError) as cm:
+            workers.start()
+        self.assertEqual(cm.exception.errno, errno.EADDRINUSE)
+        self.assertEqual(repr(workers), '<ServerWorkers workers=2>')
+
+    def test_loop_factory_error(self):
+        def loop_factory():
+            # the listening socket is bound with a loop of the main thread
+            if threading.current_thread().name.startswith('ServerWorker-'):
+                raise ZeroDivisionError
+            return asyncio.new_event_loop()
+
+        workers = asyncio.ServerWorkers(WhoAmIProtocol, '127.0.0.1', 0,
+                                        workers=2, loop_factory=loop_factory)
+        with self.assertRaises(ZeroDivisionError):
+            workers.start()
+        self.assertEqual(repr(workers), '<ServerWorkers workers=2>')
+
+    @unittest.skipUnless(hasattr(socket, 'SO_REUSEPORT'),
+                         'need socket.SO_REUSEPORT')
+    def test_threads_reuse_port(self):
+        sock = socket.socket()
+        self.addCleanup(sock.close)
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEPORT, True)
+        sock.bind(('127.0.0.1', 0))
+        address = sock.getsockname()
+
+        workers = self.start_workers(address[0], address[1], workers=2,
+                                     reuse_port=True)
+        # the sockets are not shared
+        self.assertIsNone(workers.sockets)
+        # the kernel doesn't route connections to sock which doesn't listen
+        sock.close()
+        self.assertIn(':ServerWorker-', whoami(address))
+
+    @unittest.skipUnless(hasattr(os, 'fork'), 'need os.fork()')
+    def test_fork(self):
+        workers = self.start_workers('127.0.0.1', 0, workers=2,
+                                     use_fork=True)
+        address = workers.sockets[0].getsockname()
+
+        pids = {int(whoami(address).split(':')[0]) for i in range(10)}
+        self.assertNotIn(os.getpid(), pids)
+        pids = {worker.pid for worker in workers._workers}.union(pids)
+        self.assertEqual(len(pids), 2)
+
+        workers.stop()
+        for pid in pids:
+            # the child processes were waited
+            with self.assertRaises(ChildProcessError):
+                os.waitpid(pid, os.WNOHANG)
+
+    @unittest.skipUnless(hasattr(os, 'fork'), 'need os.fork()')
+    def test_fork_start_error(self):
+        parent_pid = os.getpid()
+
+        def loop_factory():
+            if os.getpid() != parent_pid:
+                raise ZeroDivisionError
+            return asyncio.new_event_loop()
+
+        workers = asyncio.ServerWorkers(WhoAmIProtocol, '127.0.0.1', 0,
+                                        workers=2, use_fork=True,
+                                        loop_factory=loop_factory)
+        # start() waits until the child processes report their status
+        with mock.patch('asyncio.workers.logger'):
+            with self.assertRaises(RuntimeError):
+                workers.start()
+        self.assertEqual(repr(workers), '<ServerWorkers fork workers=2>')
+
+
+if __name__ == '__main__':
+    unittest.main()